@@ -0,0 +1,69 @@
+#pragma once
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <cstddef>
+#include <cstdint>
+#include "ThreadPool.hpp"
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT 0x8C4D
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+/**
+ * @class BlockCompression BlockCompression.hpp "include/BlockCompression.hpp"
+ * @brief Fast encoders for the BCn block compressed texture formats
+ * 
+ * Images are split into 4x4 blocks which are encoded independently, rows of blocks are spread across the worker
+ * pool. The BC1 to BC5 encoders favour speed over quality: color endpoints come from the principal axis of the
+ * block and a single least squares refinement, single channel endpoints from the block's range. BC7 and BC6H are
+ * meant for offline cooking and search harder: every p-bit combination, exhaustive index selection and several
+ * refinement passes, using BC7 mode 6 and BC6H mode 11 (single subset, highest endpoint precision).
+ */
+class BlockCompression
+{
+public:
+
+	enum class Format
+	{
+		BC1,
+		BC3,
+		BC4,
+		BC5,
+		BC6H,
+		BC7
+	};
+
+	BlockCompression() = delete;
+
+	static void encode(Format format, const unsigned char *pixels, int width, int height, int channels, unsigned char *output, ThreadPool &pool=ThreadPool::shared());
+	static void encodeHdr(const float *pixels, int width, int height, int channels, unsigned char *output, ThreadPool &pool=ThreadPool::shared());
+	static void encodeBC1Block(const unsigned char *rgba, unsigned char *output);
+	static void encodeBC4Block(const unsigned char *values, unsigned char *output);
+	static void encodeBC6HBlock(const float *rgb, unsigned char *output);
+	static void encodeBC7Block(const unsigned char *rgba, unsigned char *output);
+	static void decodeBC1Block(const unsigned char *block, unsigned char *rgba);
+	static void decodeBC4Block(const unsigned char *block, unsigned char *values);
+	static void decodeBC6HBlock(const unsigned char *block, float *rgb);
+	static void decodeBC7Block(const unsigned char *block, unsigned char *rgba);
+	static std::uint16_t floatToHalf(float value);
+	static float halfToFloat(std::uint16_t half);
+	static std::size_t getBlockSize(Format format);
+	static std::size_t getCompressedSize(Format format, int width, int height);
+	static GLenum getInternalFormat(Format format, bool srgb);
+	static bool isSupported(Format format, bool srgb);
+};
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <cstddef>
+#include <vector>
+#include "Material.hpp"
+#include "Texture.hpp"
+#include "ThreadPool.hpp"
+
+/**
+ * @class ChannelPacker ChannelPacker.hpp "include/ChannelPacker.hpp"
+ * @brief Merges the occlusion and metallicRoughness images of materials into single ORM textures
+ * 
+ * glTF allows occlusion to live in the red channel of the metallicRoughness image, but many models reference two
+ * separate images. pack() decodes such pairs on the worker pool and merges them into one GL_RGB8 texture with
+ * occlusion in red, roughness in green and metallic in blue, so the shader samples once and one texture unit is
+ * freed. Occlusion without a partner is stored as GL_R8 and metallicRoughness as GL_RG8, swizzled so shaders
+ * read the channels they would read from the original images.
+ */
+class ChannelPacker
+{
+public:
+
+	struct Image
+	{
+		const unsigned char *encoded {};
+		std::size_t size {};
+		bool flipVertically { true };
+	};
+
+	struct Source
+	{
+		int occlusion { -1 };
+		int metallicRoughness { -1 };
+	};
+
+	ChannelPacker() = delete;
+
+	static std::vector<Source> plan(std::vector<Material> &materials);
+	static std::vector<Texture> pack(std::vector<Material> &materials, const std::vector<Image> &images, const TextureLoadOptions &options=TextureLoadOptions {}, GLenum target=GL_TEXTURE0, ThreadPool &pool=ThreadPool::shared());
+};
\ No newline at end of file
@@ -0,0 +1,6 @@
+#pragma once
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <string>
+
+bool hasGLExtension(const std::string &name);
\ No newline at end of file
@@ -0,0 +1,6 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+std::uint64_t hashBytes(const void *data, std::size_t size, std::uint64_t seed=0);
+std::uint64_t hashCombine(std::uint64_t seed, std::uint64_t value);
\ No newline at end of file
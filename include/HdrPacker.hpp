@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ThreadPool.hpp"
+
+/**
+ * @class HdrPacker HdrPacker.hpp "include/HdrPacker.hpp"
+ * @brief Packs linear float RGB into the 32-bit shared exponent and packed float texture formats
+ * 
+ * GL_RGB9_E5 stores three 9-bit mantissas with one shared 5-bit exponent, GL_R11F_G11F_B10F three unsigned
+ * floats with 5-bit exponents and 6, 6 and 5 bit mantissas. Both take 4 bytes per texel instead of 12 or 16 for
+ * float textures. Neither has a sign, negative values and NaN become zero and values past the largest finite one
+ * are clamped. Pixels are packed four at a time with SSE2 where available, rows in parallel on the pool.
+ */
+class HdrPacker
+{
+public:
+
+	HdrPacker() = delete;
+
+	static void packRgb9E5(const float *rgb, std::size_t count, std::uint32_t *output, ThreadPool &pool=ThreadPool::shared());
+	static void packR11G11B10F(const float *rgb, std::size_t count, std::uint32_t *output, ThreadPool &pool=ThreadPool::shared());
+	static void unpackRgb9E5(std::uint32_t packed, float *rgb);
+	static void unpackR11G11B10F(std::uint32_t packed, float *rgb);
+	static std::vector<float> halve(const std::vector<float> &rgb, int width, int height, ThreadPool &pool=ThreadPool::shared());
+	static std::vector<float> resample(const std::vector<float> &rgb, int width, int height, int dstWidth, int dstHeight, ThreadPool &pool=ThreadPool::shared());
+};
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "MappedFile.hpp"
+#include "TextureLoadOptions.hpp"
+
+/**
+ * @class ImageCache ImageCache.hpp "include/ImageCache.hpp"
+ * @brief An on-disk cache of decoded (and possibly mipmapped and block compressed) image payloads
+ * 
+ * Entries are keyed by the hash of the encoded bytes and the load options, so a changed image or different
+ * options simply miss. Every entry is one file holding a small header, a level table and the 16 byte aligned
+ * levels exactly as they are handed to OpenGL, so a hit is a memory mapping uploaded in place. Texture consults
+ * the shared cache once a directory has been set, the default cache is disabled.
+ */
+class ImageCache
+{
+public:
+
+	struct Format
+	{
+		GLint internalFormat {};
+		GLenum format {};
+		GLenum type {};
+		bool compressed {};
+	};
+
+	struct Level
+	{
+		const unsigned char *data {};
+		std::size_t size {};
+		int width {};
+		int height {};
+	};
+
+	struct Entry
+	{
+		Entry(MappedFile &&mapped);
+
+		MappedFile file;
+		Format format {};
+		int channels {};
+		std::vector<Level> levels {};
+	};
+
+	ImageCache() = default;
+	ImageCache(const ImageCache &rhs) = delete;
+	ImageCache(ImageCache &&rhs) = default;
+	ImageCache(const std::string &directory);
+	~ImageCache() = default;
+
+	ImageCache &operator=(const ImageCache &rhs) = delete;
+	ImageCache &operator=(ImageCache &&rhs) = default;
+
+	bool isEnabled();
+	std::unique_ptr<Entry> find(std::uint64_t key);
+	void store(std::uint64_t key, const Format &format, int channels, const std::vector<Level> &levels);
+
+	static std::uint64_t keyOf(const unsigned char *encoded, std::size_t size, const TextureLoadOptions &options, bool compressible);
+	static ImageCache &shared();
+
+private:
+
+	std::string pathOf(std::uint64_t key);
+
+	std::string _directory {};
+};
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+/**
+ * @class JpegDecoder JpegDecoder.hpp "include/JpegDecoder.hpp"
+ * @brief Decodes baseline and progressive JPEGs with libjpeg(-turbo), optionally scaled down in the DCT domain
+ * 
+ * This is the fast path for JPEGs, libjpeg-turbo's SIMD IDCT, upsampling and color conversion decode base color
+ * textures several times faster than stb_image. It can also run a reduced inverse DCT that produces the image at
+ * 1/2, 1/4 or 1/8 of its size directly, so an image that is going to be downscaled anyway never has to be
+ * decoded at full resolution. libjpeg is an optional dependency of core, without it isAvailable() is false and
+ * decode() always fails, and callers fall back to stb_image.
+ */
+class JpegDecoder
+{
+public:
+
+	JpegDecoder() = delete;
+
+	static bool isAvailable();
+	static bool isJpeg(const unsigned char *encoded, std::size_t size);
+	static bool decode(const unsigned char *encoded, std::size_t size, int channels, bool flipVertically, unsigned char *output, std::size_t capacity, int &width, int &height);
+	static bool decode(const unsigned char *encoded, std::size_t size, int channels, int minWidth, int minHeight, bool flipVertically, std::vector<unsigned char> &pixels, int &width, int &height);
+};
\ No newline at end of file
@@ -0,0 +1,90 @@
+#pragma once
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+/**
+ * @class Ktx2 Ktx2.hpp "include/Ktx2.hpp"
+ * @brief A view of a KTX2 texture container, and a writer for the subset the cooker produces
+ * 
+ * The view parses the header and level index of a container held in memory without copying it, so level data
+ * points straight into the caller's buffer (typically a MappedFile). Only single layer, single face 2D textures
+ * are supported. Levels may be zstd supercompressed when the loader is built with zstd.
+ */
+class Ktx2
+{
+public:
+
+	// The Vulkan formats that can be written and uploaded
+	static constexpr std::uint32_t formatRGBA8 { 37 };
+	static constexpr std::uint32_t formatRGBA8Srgb { 43 };
+	static constexpr std::uint32_t formatBC6HUfloat { 143 };
+	static constexpr std::uint32_t formatBC7 { 145 };
+	static constexpr std::uint32_t formatBC7Srgb { 146 };
+
+	static constexpr std::uint32_t supercompressionNone { 0 };
+	static constexpr std::uint32_t supercompressionZstd { 2 };
+
+	struct Level
+	{
+		const unsigned char *data {};
+		std::size_t size {};
+		std::size_t uncompressedSize {};
+		int width {};
+		int height {};
+	};
+
+	struct GLFormat
+	{
+		GLenum internalFormat {};
+		GLenum format {};
+		GLenum type {};
+		bool compressed {};
+	};
+
+	Ktx2() = delete;
+	Ktx2(const Ktx2 &rhs) = default;
+	Ktx2(Ktx2 &&rhs) = default;
+	Ktx2(const unsigned char *data, std::size_t size);
+	~Ktx2() = default;
+
+	Ktx2 &operator=(const Ktx2 &rhs) = default;
+	Ktx2 &operator=(Ktx2 &&rhs) = default;
+
+	std::uint32_t getVkFormat();
+	int getWidth();
+	int getHeight();
+	std::size_t getLevelCount();
+	const Level &getLevel(std::size_t level);
+	GLFormat getGLFormat();
+	bool isSupported();
+	std::uint32_t getSupercompression();
+	void decompressLevel(std::size_t level, unsigned char *output);
+
+	static bool isKtx2(const unsigned char *data, std::size_t size);
+	static std::vector<unsigned char> encode(std::uint32_t vkFormat, int width, int height, const std::vector<std::vector<unsigned char>> &levels);
+
+	class InvalidFileException : public std::runtime_error
+	{
+	public:
+		using std::runtime_error::runtime_error;
+	};
+
+	class UnsupportedFormatException : public std::runtime_error
+	{
+	public:
+		using std::runtime_error::runtime_error;
+	};
+
+private:
+
+	std::uint32_t _vkFormat {};
+	std::uint32_t _supercompression {};
+	int _width {};
+	int _height {};
+	std::vector<Level> _levels {};
+};
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <stdexcept>
+
+/**
+ * @class MappedFile MappedFile.hpp "include/MappedFile.hpp"
+ * @brief A read-only memory mapping of a whole file
+ * 
+ * Lets loaders parse and upload file contents in place, the pages are read by the OS as they are touched instead
+ * of being copied into a heap buffer up front.
+ */
+class MappedFile
+{
+public:
+
+	MappedFile() = delete;
+	MappedFile(const MappedFile &rhs) = delete;
+	MappedFile(MappedFile &&rhs);
+	MappedFile(const std::string &path);
+	~MappedFile();
+
+	MappedFile &operator=(const MappedFile &rhs) = delete;
+	MappedFile &operator=(MappedFile &&rhs);
+
+	const unsigned char *getData();
+	std::size_t getSize();
+
+	class MappingException : public std::runtime_error
+	{
+	public:
+		using std::runtime_error::runtime_error;
+	};
+
+private:
+
+	void unmap();
+
+	const unsigned char *_data {};
+	std::size_t _size {};
+#ifdef _WIN32
+	void *_file {};
+	void *_mapping {};
+#endif
+};
\ No newline at end of file
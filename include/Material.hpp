@@ -0,0 +1,35 @@
+#pragma once
+
+/**
+ * @brief The textures and alpha mode of a glTF material, as indices into the model's images
+ * 
+ * After TextureArray::pack() a reference may additionally point at a layer of a texture array, materials whose
+ * references share arrays can then be drawn without rebinding textures. After ChannelPacker::pack() occlusion and
+ * metallicRoughness may instead point at a packed texture, which both share if they could be merged.
+ */
+struct Material
+{
+	enum class AlphaMode
+	{
+		Opaque,
+		Mask,
+		Blend
+	};
+
+	struct TextureRef
+	{
+		int image { -1 };
+		int sampler { -1 };
+		int texCoord { 0 };
+		int array { -1 };
+		int layer { -1 };
+		int packed { -1 };
+	};
+
+	TextureRef baseColor {};
+	TextureRef metallicRoughness {};
+	TextureRef normal {};
+	TextureRef occlusion {};
+	TextureRef emissive {};
+	AlphaMode alphaMode { AlphaMode::Opaque };
+};
\ No newline at end of file
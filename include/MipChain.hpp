@@ -0,0 +1,73 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <stdexcept>
+#include "ThreadPool.hpp"
+
+/**
+ * @class MipChain MipChain.hpp "include/MipChain.hpp"
+ * @brief A full chain of 8-bit mip levels stored back to back in one buffer
+ * 
+ * Level 0 is filled by the caller (e.g. decoded straight into getData()), generate() then filters the remaining
+ * levels on the CPU. Filtering happens on linear, premultiplied values, so sRGB images and images with straight
+ * alpha are reduced correctly. The levels are a plain contiguous payload, which makes the chain easy to upload
+ * from a single staging segment and to cache next to the decoded image.
+ */
+class MipChain
+{
+public:
+
+	enum class Filter
+	{
+		Box,
+		Kaiser
+	};
+
+	struct Options
+	{
+		Filter filter { Filter::Kaiser };
+		// Color images in sRGB set this, so they are filtered in linear light. Data such as roughness is not encoded
+		bool srgb { false };
+		bool premultipliedAlpha { false };
+	};
+
+	struct Level
+	{
+		int width {};
+		int height {};
+		std::size_t offset {};
+		std::size_t size {};
+	};
+
+	MipChain() = delete;
+	MipChain(const MipChain &rhs) = default;
+	MipChain(MipChain &&rhs) = default;
+	MipChain(int width, int height, int channels);
+	~MipChain() = default;
+
+	MipChain &operator=(const MipChain &rhs) = default;
+	MipChain &operator=(MipChain &&rhs) = default;
+
+	void generate(const Options &options, ThreadPool &pool=ThreadPool::shared());
+	unsigned char *getData();
+	unsigned char *getLevelData(std::size_t level);
+	std::size_t getSize();
+	std::size_t getLevelCount();
+	const Level &getLevel(std::size_t level);
+	int getChannels();
+
+	static std::size_t levelCountFor(int width, int height);
+	static void resample(const unsigned char *src, int width, int height, int channels, unsigned char *dst, int dstWidth, int dstHeight, const Options &options, ThreadPool &pool=ThreadPool::shared());
+
+	class InvalidImageException : public std::runtime_error
+	{
+	public:
+		using std::runtime_error::runtime_error;
+	};
+
+private:
+
+	int _channels {};
+	std::vector<Level> _levels {};
+	std::vector<unsigned char> _data {};
+};
\ No newline at end of file
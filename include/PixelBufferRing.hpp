@@ -0,0 +1,71 @@
+#pragma once
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <deque>
+#include <stdexcept>
+
+/**
+ * @class PixelBufferRing PixelBufferRing.hpp "include/PixelBufferRing.hpp"
+ * @brief A ring of pixel unpack buffer memory used to stage texture uploads
+ * 
+ * The ring is a single GL_PIXEL_UNPACK_BUFFER which is handed out in segments. The buffer is persistently mapped
+ * when ARB_buffer_storage is available, otherwise each segment is mapped and unmapped on demand. Segments are
+ * recycled once the fence inserted after their upload has been signalled.
+ */
+class PixelBufferRing
+{
+public:
+
+	/**
+	 * @brief A region of staging memory, valid between acquire() and release()
+	 */
+	struct Segment
+	{
+		GLuint buffer {};
+		GLintptr offset {};
+		GLsizeiptr size {};
+		void *data {};
+		bool dedicated {};
+	};
+
+	static constexpr GLsizeiptr defaultCapacity { 64 * 1024 * 1024 };
+
+	PixelBufferRing() = delete;
+	PixelBufferRing(const PixelBufferRing &rhs) = delete;
+	PixelBufferRing(PixelBufferRing &&rhs) = delete;
+	PixelBufferRing(GLsizeiptr capacity);
+	~PixelBufferRing();
+
+	PixelBufferRing &operator=(const PixelBufferRing &rhs) = delete;
+	PixelBufferRing &operator=(PixelBufferRing &&rhs) = delete;
+
+	Segment acquire(GLsizeiptr size);
+	const void *unpack(Segment &segment);
+	void release(Segment &segment);
+	bool isPersistent();
+	GLsizeiptr getCapacity();
+
+	class StagingException : public std::runtime_error
+	{
+	public:
+		using std::runtime_error::runtime_error;
+	};
+
+private:
+
+	struct InFlight
+	{
+		GLintptr offset {};
+		GLsizeiptr size {};
+		GLsync fence {};
+	};
+
+	void waitForRange(GLintptr offset, GLsizeiptr size);
+
+	GLuint _buffer {};
+	GLsizeiptr _capacity {};
+	GLintptr _head {};
+	bool _persistent {};
+	char *_mapping {};
+	std::deque<InFlight> _inFlight {};
+};
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @class ProgramCache ProgramCache.hpp "include/ProgramCache.hpp"
+ * @brief An on-disk cache of linked shader program binaries (ARB_get_program_binary)
+ * 
+ * Entries are keyed by the hash of the final shader sources, including injected defines, and the vendor,
+ * renderer and version strings of the driver, so edited shaders and driver updates simply miss. A binary the
+ * driver rejects anyway counts as a miss and the program is compiled and linked from source. Shader consults
+ * the shared cache once a directory has been set, the default cache is disabled.
+ */
+class ProgramCache
+{
+public:
+
+	ProgramCache() = default;
+	ProgramCache(const ProgramCache &rhs) = delete;
+	ProgramCache(ProgramCache &&rhs) = default;
+	ProgramCache(const std::string &directory);
+	~ProgramCache() = default;
+
+	ProgramCache &operator=(const ProgramCache &rhs) = delete;
+	ProgramCache &operator=(ProgramCache &&rhs) = default;
+
+	bool isEnabled();
+	bool load(std::uint64_t key, GLuint program);
+	void store(std::uint64_t key, GLuint program);
+
+	static bool isSupported();
+	static std::uint64_t keyOf(const std::vector<std::string> &sources);
+	static ProgramCache &shared();
+
+private:
+
+	std::string pathOf(std::uint64_t key);
+
+	std::string _directory {};
+};
\ No newline at end of file
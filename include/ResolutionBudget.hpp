@@ -0,0 +1,41 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include "TextureLoadOptions.hpp"
+
+/**
+ * @class ResolutionBudget ResolutionBudget.hpp "include/ResolutionBudget.hpp"
+ * @brief Caps the resolution textures are loaded at, globally and per material role
+ * 
+ * A limit of 0 means unlimited. The effective limit of a role is the smaller of the global and the role's own
+ * limit, apply() writes it into TextureLoadOptions::maxDimension, e.g. to load previews with at most 1K textures
+ * and their normal maps at 512.
+ */
+class ResolutionBudget
+{
+public:
+
+	enum class Role
+	{
+		BaseColor,
+		Normal,
+		Orm,
+		Emissive,
+		Other
+	};
+
+	ResolutionBudget() = default;
+	ResolutionBudget(int maxDimension);
+
+	void setLimit(int maxDimension);
+	void setLimit(Role role, int maxDimension);
+	int getLimit(Role role);
+	TextureLoadOptions apply(const TextureLoadOptions &options, Role role);
+
+private:
+
+	static constexpr std::size_t roleCount { 5 };
+
+	int _limit {};
+	std::array<int, roleCount> _roleLimits {};
+};
\ No newline at end of file
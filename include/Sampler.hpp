@@ -0,0 +1,52 @@
+#pragma once
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+/**
+ * @brief Wrap and filter state of a sampler, the defaults match what glTF assumes for unset values
+ */
+struct SamplerState
+{
+	GLint wrapS { GL_REPEAT };
+	GLint wrapT { GL_REPEAT };
+	GLint minFilter { GL_LINEAR_MIPMAP_LINEAR };
+	GLint magFilter { GL_LINEAR };
+	float anisotropy { 1.0f };
+
+	bool operator==(const SamplerState &rhs) const;
+	bool operator!=(const SamplerState &rhs) const;
+
+	static SamplerState fromGltf(int magFilter, int minFilter, int wrapS, int wrapT, float anisotropy=1.0f);
+};
+
+/**
+ * @class Sampler Sampler.hpp "include/Sampler.hpp"
+ * @brief A class encapsulating an OpenGL sampler object
+ * 
+ * A sampler bound to a texture unit overrides the sampling parameters of whatever texture is bound there, so one
+ * texture can be sampled differently by different materials. Usually obtained from a SamplerCache.
+ */
+class Sampler
+{
+public:
+
+	Sampler() = delete;
+	Sampler(const Sampler &rhs) = delete;
+	Sampler(Sampler &&rhs);
+	Sampler(const SamplerState &state);
+	~Sampler();
+
+	Sampler &operator=(const Sampler &rhs) = delete;
+	Sampler &operator=(Sampler &&rhs);
+
+	void bind(GLenum target);
+	GLuint getId();
+	const SamplerState &getState();
+
+	static float getMaxAnisotropy();
+
+private:
+
+	GLuint _id {};
+	SamplerState _state {};
+};
\ No newline at end of file
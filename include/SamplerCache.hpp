@@ -0,0 +1,41 @@
+#pragma once
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <cstddef>
+#include <deque>
+#include <vector>
+#include "Sampler.hpp"
+
+/**
+ * @class SamplerCache SamplerCache.hpp "include/SamplerCache.hpp"
+ * @brief Creates one sampler object per unique sampler state and binds them to texture units
+ * 
+ * Remembers which sampler is bound to every unit, so binding the sampler a unit already has costs nothing. This
+ * assumes samplers are only bound through the cache.
+ */
+class SamplerCache
+{
+public:
+
+	SamplerCache() = default;
+	SamplerCache(const SamplerCache &rhs) = delete;
+	SamplerCache(SamplerCache &&rhs) = default;
+	~SamplerCache() = default;
+
+	SamplerCache &operator=(const SamplerCache &rhs) = delete;
+	SamplerCache &operator=(SamplerCache &&rhs) = default;
+
+	Sampler &get(const SamplerState &state);
+	void bind(GLenum target, const SamplerState &state);
+	void unbind(GLenum target);
+	std::size_t getCount();
+
+	static SamplerCache &shared();
+
+private:
+
+	void bindId(GLenum target, GLuint id);
+
+	std::deque<Sampler> _samplers {};
+	std::vector<GLuint> _bound {};
+};
\ No newline at end of file
@@ -1,31 +1,92 @@
 #pragma once
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <utility>
 #include <stdexcept>
+#include <vector>
 #include <glm/glm.hpp>
+#include "ShaderReflection.hpp"
 
 /**
  * @class Shader Shader.hpp "include/Shader.hpp"
  * @brief A class encapsulating an openGL shader program
+ * 
+ * The locations of all active uniforms are resolved once after linking. Uniforms can be set by name, which is a
+ * hash table lookup instead of a glGetUniformLocation call, or through a Uniform handle resolved up front, which
+ * is what per draw code should use. Values are remembered per uniform and setting a uniform to the value it
+ * already has uploads nothing. Copies of a Shader share the program and its uniform table. Linked programs are
+ * cached on disk through the shared ProgramCache when it is enabled. reload() rebuilds the program from its
+ * files and swaps it in for all copies if it links, see ShaderWatcher. Uniform blocks declared with
+ * UniformBlocks::declarations() are bound to their binding points, per draw data should live in those instead of
+ * plain uniforms.
  */
 class Shader
 {
 public:
 
+	/**
+	 * A uniform resolved with getUniform(). Cheap to copy, a handle for a name that is not an active uniform
+	 * of the program is invalid and setting it does nothing, like location -1 in OpenGL. Handles belong to the
+	 * Shader that resolved them and its copies.
+	 */
+	class Uniform
+	{
+	public:
+
+		bool isValid() { return _index >= 0; }
+
+	private:
+
+		friend class Shader;
+
+		int _index { -1 };
+		std::uint64_t _nameHash {};
+		unsigned _generation {};
+	};
+
 	Shader() = delete;
 	Shader(const Shader &rhs) = default;
 	Shader(Shader &&rhs) = default;
 	Shader(const std::string &vertPath, const std::string &fragPath);
+	Shader(const std::string &vertPath, const std::string &fragPath, const std::string &prelude);
 	~Shader() = default;
 
 	Shader &operator=(const Shader &rhs) = default;
 	Shader &operator=(Shader &&rhs) = default;
 
 	void useProgram();
+	bool reload();
+	std::string getVertPath();
+	std::string getFragPath();
+	ShaderReflection &getReflection();
+
+	// FNV-1a, usable in constant expressions to hash uniform names at compile time
+	static constexpr std::uint64_t hashName(const char *name)
+	{
+		std::uint64_t hash { 0xCBF29CE484222325ULL };
+		for (; *name; name++)
+			hash = (hash ^ static_cast<unsigned char>(*name)) * 0x100000001B3ULL;
+		return hash;
+	}
+
+	Uniform getUniform(const std::string &name);
+	Uniform getUniform(std::uint64_t nameHash);
 
-	void setUniform(std::string name, GLint val);
-	void setUniform(std::string name, glm::mat4 &val);
+	void setUniform(Uniform uniform, GLint val);
+	void setUniform(Uniform uniform, GLfloat val);
+	void setUniform(Uniform uniform, const glm::vec2 &val);
+	void setUniform(Uniform uniform, const glm::vec3 &val);
+	void setUniform(Uniform uniform, const glm::vec4 &val);
+	void setUniform(Uniform uniform, const glm::mat4 &val);
+
+	void setUniform(const std::string &name, GLint val);
+	void setUniform(const std::string &name, const glm::vec4 &val);
+	void setUniform(const std::string &name, const glm::mat4 &val);
 
 	class VertexShaderCompilationException : public std::runtime_error
 	{
@@ -47,5 +108,61 @@ public:
 
 private:
 
-	GLuint _id;
+	struct UniformSlot
+	{
+		GLint location;
+		bool uploaded;
+		std::array<unsigned char, sizeof(glm::mat4)> value;
+	};
+
+	struct UniformTable
+	{
+		// Name hash and slot index, sorted by hash. Arrays have several names for element 0
+		std::vector<std::pair<std::uint64_t, int>> names;
+		std::vector<UniformSlot> slots;
+	};
+
+	friend class ShaderCompiler;
+	friend class ShaderWatcher;
+
+	// Shared by all copies of a Shader, so a reloaded program reaches every one of them
+	struct Program
+	{
+		GLuint id {};
+		// Incremented by every reload, handles of older generations are looked up again
+		unsigned generation {};
+		std::string vertPath {};
+		std::string fragPath {};
+		std::string prelude {};
+		ShaderReflection reflection {};
+		UniformTable uniforms {};
+	};
+
+	// A program whose compiling and linking have been issued but not checked yet
+	struct Build
+	{
+		GLuint program {};
+		GLuint vertShader {};
+		GLuint fragShader {};
+		std::string vertPath {};
+		std::string fragPath {};
+		std::string prelude {};
+		std::uint64_t key {};
+		// The program cache is in use, key is valid
+		bool cached {};
+		// Linked from a cached binary, there are no shaders
+		bool loaded {};
+	};
+
+	Shader(Build &&build);
+
+	static Build begin(const std::string &vertPath, const std::string &fragPath, const std::string &prelude);
+	static void cancel(Build &build);
+
+	void adopt(Shader &rebuilt);
+	void resolveUniforms();
+	int indexOf(std::uint64_t nameHash);
+	GLint update(Uniform uniform, const void *value, std::size_t size);
+
+	std::shared_ptr<Program> _program {};
 };
\ No newline at end of file
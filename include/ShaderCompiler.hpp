@@ -0,0 +1,45 @@
+#pragma once
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include "Shader.hpp"
+
+/**
+ * @class ShaderCompiler ShaderCompiler.hpp "include/ShaderCompiler.hpp"
+ * @brief Compiles batches of shader programs without stalling on each one
+ * 
+ * submit() only issues compiling and linking, statuses are queried when a program is finished. With
+ * KHR_parallel_shader_compile (or the ARB version) the driver compiles on its own threads and isReady() polls
+ * GL_COMPLETION_STATUS_KHR, so a render loop can keep drawing with a fallback program until a variant is done.
+ * Without the extension isReady() is always true and finish() may block, but submitting a whole batch before
+ * finishing any of it still lets drivers with threaded compilers overlap the work.
+ */
+class ShaderCompiler
+{
+public:
+
+	using Job = std::size_t;
+
+	ShaderCompiler() = default;
+	ShaderCompiler(const ShaderCompiler &rhs) = delete;
+	ShaderCompiler(ShaderCompiler &&rhs) = default;
+	~ShaderCompiler();
+
+	ShaderCompiler &operator=(const ShaderCompiler &rhs) = delete;
+	ShaderCompiler &operator=(ShaderCompiler &&rhs) = default;
+
+	Job submit(const std::string &vertPath, const std::string &fragPath, const std::string &prelude=std::string {});
+	bool isReady(Job job);
+	Shader finish(Job job);
+	void cancel(Job job);
+	std::size_t getPendingCount();
+
+	static bool isParallel();
+
+private:
+
+	std::unordered_map<Job, Shader::Build> _jobs {};
+	Job _next {};
+};
\ No newline at end of file
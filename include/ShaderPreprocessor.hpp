@@ -0,0 +1,83 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @class ShaderPreprocessor ShaderPreprocessor.hpp "include/ShaderPreprocessor.hpp"
+ * @brief Expands #include directives in GLSL sources and injects text after the #version line
+ * 
+ * #include "file" is resolved relative to the including file, then in the include directories. A file with
+ * #pragma once or a classic #ifndef/#define guard is expanded only once per source. #line directives keep line
+ * numbers in compile errors right, the source string number of a file is its position in getDependencies().
+ * 
+ * Files are read once and expansions are cached per path. Both are reused as long as the modification time and
+ * size of every file involved are unchanged, so compiling hundreds of variants of a shader reads and expands
+ * its shared headers once. Expansion happens before the prelude is injected, so it is shared by all variants.
+ * Not thread safe, Shader uses the shared instance on the thread owning the context.
+ */
+class ShaderPreprocessor
+{
+public:
+
+	ShaderPreprocessor() = default;
+	ShaderPreprocessor(const ShaderPreprocessor &rhs) = delete;
+	ShaderPreprocessor(ShaderPreprocessor &&rhs) = default;
+	~ShaderPreprocessor() = default;
+
+	ShaderPreprocessor &operator=(const ShaderPreprocessor &rhs) = delete;
+	ShaderPreprocessor &operator=(ShaderPreprocessor &&rhs) = default;
+
+	void addIncludeDirectory(const std::string &directory);
+	std::string process(const std::string &path, const std::string &prelude=std::string {});
+	std::vector<std::string> getDependencies(const std::string &path);
+	void clear();
+
+	static std::string inject(const std::string &source, const std::string &prelude);
+	static ShaderPreprocessor &shared();
+
+	class PreprocessingException : public std::runtime_error
+	{
+	public:
+		using std::runtime_error::runtime_error;
+	};
+
+private:
+
+	struct File
+	{
+		std::int64_t modified {};
+		std::int64_t size {};
+		std::string text {};
+		// Macro of an #ifndef/#define guard, or the path for #pragma once, empty if the file has no guard
+		std::string guard {};
+	};
+
+	// A file an expansion was built from, as it was when it was read
+	struct Dependency
+	{
+		std::string path {};
+		std::int64_t modified {};
+		std::int64_t size {};
+	};
+
+	struct Expansion
+	{
+		std::string text {};
+		// Every file read, the expanded file first
+		std::vector<Dependency> files {};
+	};
+
+	File &load(const std::string &path);
+	static bool isCurrent(const Expansion &expansion);
+	static std::size_t sourceNumberOf(const Expansion &expansion, const std::string &path);
+	void expand(const std::string &path, Expansion &expansion, std::vector<std::string> &stack, std::unordered_set<std::string> &guards);
+	std::string resolve(const std::string &includingPath, const std::string &name);
+
+	std::vector<std::string> _includeDirectories {};
+	std::unordered_map<std::string, File> _files {};
+	std::unordered_map<std::string, Expansion> _expansions {};
+};
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <string>
+#include <stdexcept>
+#include <vector>
+#include "VertexLayout.hpp"
+
+/**
+ * @class ShaderReflection ShaderReflection.hpp "include/ShaderReflection.hpp"
+ * @brief The active attributes, uniforms and uniform blocks of a linked program
+ * 
+ * Queried once after linking, every Shader has one. The attribute table checks mesh vertex layouts and sets up
+ * vertex arrays at the locations of the program's inputs, so no attribute setup has to be written by hand. Inputs
+ * should still have explicit locations, vertex arrays are not set up again when a shader is reloaded.
+ */
+class ShaderReflection
+{
+public:
+
+	struct Attribute
+	{
+		std::string name {};
+		GLint location { -1 };
+		GLenum type {};
+		GLint size {};
+	};
+
+	struct Uniform
+	{
+		std::string name {};
+		// -1 for members of uniform blocks
+		GLint location { -1 };
+		GLenum type {};
+		GLint size {};
+		// Index into the uniform blocks, -1 for plain uniforms
+		GLint block { -1 };
+		// Byte offset inside the block
+		GLint offset { -1 };
+	};
+
+	struct UniformBlock
+	{
+		std::string name {};
+		GLuint index {};
+		GLint dataSize {};
+		GLint binding {};
+	};
+
+	ShaderReflection() = default;
+	ShaderReflection(const ShaderReflection &rhs) = default;
+	ShaderReflection(ShaderReflection &&rhs) = default;
+	ShaderReflection(GLuint program);
+	ShaderReflection(const std::vector<Attribute> &attributes, const std::vector<Uniform> &uniforms, const std::vector<UniformBlock> &blocks);
+	~ShaderReflection() = default;
+
+	ShaderReflection &operator=(const ShaderReflection &rhs) = default;
+	ShaderReflection &operator=(ShaderReflection &&rhs) = default;
+
+	std::vector<Attribute> &getAttributes();
+	std::vector<Uniform> &getUniforms();
+	std::vector<UniformBlock> &getUniformBlocks();
+	Attribute *findAttribute(const std::string &name);
+	UniformBlock *findUniformBlock(const std::string &name);
+
+	std::vector<std::string> validate(const VertexLayout &layout);
+	void bindVertexLayout(const VertexLayout &layout);
+
+	static int componentsOf(GLenum type);
+	static int locationsOf(GLenum type);
+	static bool isInteger(GLenum type);
+
+	class VertexLayoutException : public std::runtime_error
+	{
+	public:
+		using std::runtime_error::runtime_error;
+	};
+
+private:
+
+	std::vector<Attribute> _attributes {};
+	std::vector<Uniform> _uniforms {};
+	std::vector<UniformBlock> _blocks {};
+};
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "Material.hpp"
+#include "Shader.hpp"
+#include "ShaderCompiler.hpp"
+
+/**
+ * @class ShaderVariants ShaderVariants.hpp "include/ShaderVariants.hpp"
+ * @brief Compiles variants of one vertex and fragment shader pair specialized for material and primitive features
+ * 
+ * Every feature a material or primitive has becomes a #define injected after the #version line, so the shaders
+ * resolve features with #ifdef instead of runtime branches. Variants are compiled the first time they are asked
+ * for and cached by their feature bitmask, and since the injected defines are part of the final source, the
+ * ProgramCache keeps them across runs as well. UniformBlocks::declarations() is injected into every variant.
+ * 
+ * Variants can also be compiled in the background with a ShaderCompiler: request() submits them, e.g. for all
+ * materials of a scene at load time, and get() with a fallback returns the fallback until the variant is ready.
+ */
+class ShaderVariants
+{
+public:
+
+	enum Feature : std::uint32_t
+	{
+		NormalMap = 1u << 0,
+		OcclusionMap = 1u << 1,
+		EmissiveMap = 1u << 2,
+		VertexColors = 1u << 3,
+		AlphaMask = 1u << 4,
+		AlphaBlend = 1u << 5,
+		Skinned = 1u << 6,
+		MorphTargets = 1u << 7,
+		TexCoord0 = 1u << 8,
+		TexCoord1 = 1u << 9,
+		// KHR_materials_* extensions
+		Unlit = 1u << 10,
+		Clearcoat = 1u << 11,
+		Sheen = 1u << 12,
+		Transmission = 1u << 13,
+		Volume = 1u << 14,
+		Specular = 1u << 15,
+		Ior = 1u << 16,
+		EmissiveStrength = 1u << 17
+	};
+
+	using Features = std::uint32_t;
+
+	ShaderVariants() = delete;
+	ShaderVariants(const ShaderVariants &rhs) = delete;
+	ShaderVariants(ShaderVariants &&rhs) = default;
+	ShaderVariants(const std::string &vertPath, const std::string &fragPath);
+	~ShaderVariants() = default;
+
+	ShaderVariants &operator=(const ShaderVariants &rhs) = delete;
+	ShaderVariants &operator=(ShaderVariants &&rhs) = default;
+
+	Shader &get(Features features);
+	Shader &get(Features features, ShaderCompiler &compiler, Shader &fallback);
+	void request(Features features, ShaderCompiler &compiler);
+	std::size_t getCount();
+
+	static Features featuresOf(const Material &material);
+	static std::string definesFor(Features features);
+
+private:
+
+	std::string _vertPath {};
+	std::string _fragPath {};
+	std::unordered_map<Features, Shader> _variants {};
+	std::unordered_map<Features, ShaderCompiler::Job> _pending {};
+	std::unordered_set<Features> _failed {};
+};
\ No newline at end of file
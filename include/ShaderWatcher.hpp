@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Shader.hpp"
+#include "ShaderCompiler.hpp"
+
+/**
+ * @class ShaderWatcher ShaderWatcher.hpp "include/ShaderWatcher.hpp"
+ * @brief Reloads shaders when their files, or files they include, change in a directory
+ * 
+ * The directory is watched with inotify, so saving a shader in an editor is noticed without polling file times.
+ * poll() recompiles affected shaders through a ShaderCompiler, which overlaps the work with rendering where the
+ * driver supports parallel compilation, and swaps a program in once the new version links. A version that
+ * doesn't compile is logged and the old program stays in use. Only available on Linux, elsewhere poll() does
+ * nothing.
+ */
+class ShaderWatcher
+{
+public:
+
+	ShaderWatcher() = delete;
+	ShaderWatcher(const ShaderWatcher &rhs) = delete;
+	ShaderWatcher(ShaderWatcher &&rhs) = delete;
+	ShaderWatcher(const std::string &directory);
+	~ShaderWatcher();
+
+	ShaderWatcher &operator=(const ShaderWatcher &rhs) = delete;
+	ShaderWatcher &operator=(ShaderWatcher &&rhs) = delete;
+
+	bool isAvailable();
+	void watch(Shader &shader);
+	void poll();
+
+private:
+
+	std::vector<std::string> readChanges();
+
+	std::string _directory {};
+	int _fd { -1 };
+	std::vector<Shader> _shaders {};
+	ShaderCompiler _compiler {};
+	// Index into _shaders and the job rebuilding it
+	std::unordered_map<std::size_t, ShaderCompiler::Job> _pending {};
+};
\ No newline at end of file
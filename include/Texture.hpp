@@ -1,8 +1,19 @@
 #pragma once
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <vector>
 #include <stdexcept>
+#include "PixelBufferRing.hpp"
+#include "TextureLoadOptions.hpp"
+#include "BlockCompression.hpp"
+#include "MipChain.hpp"
+#include "Ktx2.hpp"
+#include "MappedFile.hpp"
+#include "Sampler.hpp"
+#include "ImageCache.hpp"
 
 /**
  * @class Texture Texture.hpp "include/Texture.hpp"
@@ -13,15 +24,32 @@ class Texture
 public:
 
 	Texture() = delete;
-	Texture(const Texture &rhs) = default;
-	Texture(Texture &&rhs) = default;
+	Texture(const Texture &rhs) = delete;
+	Texture(Texture &&rhs);
 	Texture(const std::string &path, GLenum target, GLint internalFormat=GL_RGBA, GLenum format=GL_RGBA, GLenum type=GL_UNSIGNED_BYTE, bool flipVertically=true);
-	~Texture() = default;
+	Texture(const unsigned char *encoded, std::size_t size, GLenum target, GLint internalFormat=GL_RGBA, GLenum format=GL_RGBA, GLenum type=GL_UNSIGNED_BYTE, bool flipVertically=true);
+	Texture(const std::string &path, GLenum target, const TextureLoadOptions &options);
+	Texture(const unsigned char *encoded, std::size_t size, GLenum target, const TextureLoadOptions &options);
+	Texture(MipChain &chain, GLenum target, const TextureLoadOptions &options);
+	Texture(Ktx2 &container, GLenum target, std::size_t baseLevel);
+	~Texture();
 
-	Texture &operator=(const Texture &rhs) = default;
-	Texture &operator=(Texture &&rhs) = default;
+	Texture &operator=(const Texture &rhs) = delete;
+	Texture &operator=(Texture &&rhs);
 
 	void bind();
+	void bind(GLenum target);
+	void bind(GLenum target, const SamplerState &sampler);
+	GLuint getId();
+	int getWidth();
+	int getHeight();
+	void setResidentBaseLevel(Ktx2 &container, std::size_t baseLevel);
+	std::size_t getResidentBaseLevel();
+	void setSwizzle(GLint red, GLint green, GLint blue, GLint alpha);
+
+	static PixelBufferRing &stagingRing();
+	static std::vector<unsigned char> readFile(const std::string &path);
+	static MappedFile mapFile(const std::string &path);
 
 	class TextureLoadingException : public std::runtime_error
 	{
@@ -31,9 +59,22 @@ public:
 
 private:
 
+	void create();
+	void destroy();
+	void upload(const unsigned char *encoded, std::size_t size, const std::string &name, const TextureLoadOptions &options);
+	MipChain decodeMipChain(const unsigned char *encoded, std::size_t size, const std::string &name, const TextureLoadOptions &options);
+	void uploadMipChain(const unsigned char *encoded, std::size_t size, const std::string &name, const TextureLoadOptions &options, std::uint64_t cacheKey);
+	void uploadChain(MipChain &chain, const std::string &name, const TextureLoadOptions &options, std::uint64_t cacheKey);
+	void uploadCompressed(MipChain &chain, std::size_t levelCount, BlockCompression::Format format, bool srgb, std::uint64_t cacheKey);
+	void uploadHdr(const unsigned char *encoded, std::size_t size, const std::string &name, const TextureLoadOptions &options, std::uint64_t cacheKey);
+	bool uploadCached(ImageCache::Entry &entry, const std::string &name, const TextureLoadOptions &options);
+	void uploadKtx2(Ktx2 &container, const std::string &name, std::size_t firstLevel=0);
+	void uploadKtx2Levels(Ktx2 &container, const Ktx2::GLFormat &format, std::size_t first, std::size_t end);
+
 	GLuint _id {};
 	GLenum _target {};
 	int _width {};
 	int _height {};
 	int _nrChannels{};
+	std::size_t _baseLevel {};
 };
\ No newline at end of file
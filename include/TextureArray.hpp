@@ -0,0 +1,74 @@
+#pragma once
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <cstddef>
+#include <vector>
+#include <stdexcept>
+#include "Material.hpp"
+#include "MipChain.hpp"
+#include "Sampler.hpp"
+#include "TextureLoadOptions.hpp"
+#include "ThreadPool.hpp"
+
+/**
+ * @class TextureArray TextureArray.hpp "include/TextureArray.hpp"
+ * @brief A GL_TEXTURE_2D_ARRAY holding many small textures of the same size and format as layers
+ * 
+ * pack() groups the small images of a model by size and load options and decodes each group into arrays, so
+ * draws whose materials reference the same arrays need no texture rebinds. Shaders sample a layer with
+ * texture(sampler2DArray, vec3(uv, layer)). Layers keep their own wrapping and mip chain, unlike an atlas.
+ */
+class TextureArray
+{
+public:
+
+	struct Image
+	{
+		const unsigned char *encoded {};
+		std::size_t size {};
+		TextureLoadOptions options {};
+	};
+
+	struct Placement
+	{
+		int array { -1 };
+		int layer { -1 };
+	};
+
+	static constexpr int defaultMaxDimension { 256 };
+
+	TextureArray() = delete;
+	TextureArray(const TextureArray &rhs) = delete;
+	TextureArray(TextureArray &&rhs);
+	TextureArray(int width, int height, std::size_t layerCount, std::size_t levelCount, GLint internalFormat);
+	~TextureArray();
+
+	TextureArray &operator=(const TextureArray &rhs) = delete;
+	TextureArray &operator=(TextureArray &&rhs);
+
+	void setLayer(std::size_t layer, MipChain &chain, std::size_t levelCount, GLenum format, GLenum type);
+	void generateMipmaps();
+	void bind(GLenum target);
+	void bind(GLenum target, const SamplerState &sampler);
+	GLuint getId();
+	int getWidth();
+	int getHeight();
+	std::size_t getLayerCount();
+
+	static std::vector<Placement> pack(const std::vector<Image> &images, std::vector<TextureArray> &arrays, int maxDimension=defaultMaxDimension, ThreadPool &pool=ThreadPool::shared());
+	static void remap(std::vector<Material> &materials, const std::vector<Placement> &placements);
+
+	class TextureArrayException : public std::runtime_error
+	{
+	public:
+		using std::runtime_error::runtime_error;
+	};
+
+private:
+
+	GLuint _id {};
+	int _width {};
+	int _height {};
+	std::size_t _layerCount {};
+	std::size_t _levelCount {};
+};
\ No newline at end of file
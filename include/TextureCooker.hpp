@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include "MipChain.hpp"
+#include "ThreadPool.hpp"
+
+/**
+ * @class TextureCooker TextureCooker.hpp "include/TextureCooker.hpp"
+ * @brief Offline conversion of source images into block compressed KTX2 files
+ * 
+ * LDR images are filtered into a full mip chain and encoded to BC7, HDR images (Radiance .hdr) to BC6H. The
+ * encoders spend far more time per block than the runtime ones, which is affordable since cooking happens once
+ * per asset. Blocks of a level are encoded in parallel, and cookAll() additionally runs whole images in parallel.
+ */
+class TextureCooker
+{
+public:
+
+	struct Options
+	{
+		bool srgb { true };
+		bool flipVertically { true };
+		MipChain::Filter filter { MipChain::Filter::Kaiser };
+	};
+
+	struct Job
+	{
+		std::string source {};
+		std::string destination {};
+		Options options {};
+	};
+
+	TextureCooker() = delete;
+
+	static std::vector<unsigned char> cook(const unsigned char *encoded, std::size_t size, const Options &options, ThreadPool &pool=ThreadPool::shared());
+	static void cookFile(const std::string &source, const std::string &destination, const Options &options, ThreadPool &pool=ThreadPool::shared());
+	static void cookAll(const std::vector<Job> &jobs, ThreadPool &pool=ThreadPool::shared());
+
+	class CookingException : public std::runtime_error
+	{
+	public:
+		using std::runtime_error::runtime_error;
+	};
+};
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <cstdint>
+#include "MipChain.hpp"
+
+/**
+ * @brief Options controlling how Texture decodes and uploads an image
+ */
+struct TextureLoadOptions
+{
+	enum class Mipmaps
+	{
+		Gpu,
+		Cpu,
+		None
+	};
+
+	// Block compression is done on the CPU, so it implies CPU mipmaps. BC1/BC3 suit color, BC4 single channel
+	// data such as occlusion or roughness, BC5 normal maps. Falls back to uncompressed if unsupported
+	enum class Compression
+	{
+		None,
+		BC1,
+		BC3,
+		BC4,
+		BC5
+	};
+
+	// Format of HDR sources (Radiance .hdr), None decodes them to 8 bits like any other image. All take 4 bytes
+	// per texel or less instead of 12 for floats. RGB9E5 suits environment maps, its shared exponent spends all
+	// mantissa bits on the brightest channel. R11FG11FB10F suits emissive maps, whose channels often differ by
+	// orders of magnitude. BC6H takes 1 byte per texel but is slow to encode, falls back to RGB9E5 if unsupported
+	enum class HdrFormat
+	{
+		None,
+		RGB9E5,
+		R11FG11FB10F,
+		BC6H
+	};
+
+	GLint internalFormat { GL_RGBA };
+	GLenum format { GL_RGBA };
+	GLenum type { GL_UNSIGNED_BYTE };
+	bool flipVertically { true };
+	Mipmaps mipmaps { Mipmaps::Gpu };
+	MipChain::Options mipOptions {};
+	Compression compression { Compression::None };
+	// Normal maps keep only X and Y, as BC5 if supported and GL_RG8 otherwise, with CPU filtered linear mips.
+	// Shaders reconstruct Z, see res/shaders/normal_map.glsl. Overrides formats, mipmaps and compression
+	bool normalMap { false };
+	HdrFormat hdrFormat { HdrFormat::None };
+	// Largest width or height to load at, larger images are downscaled before their mips are built. 0 is unlimited
+	int maxDimension { 0 };
+};
+
+std::uint64_t hashOptions(const TextureLoadOptions &options, std::uint64_t seed=0);
+bool isSrgbFormat(GLint internalFormat);
+MipChain::Options mipOptionsFor(const TextureLoadOptions &options);
\ No newline at end of file
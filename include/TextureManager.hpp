@@ -0,0 +1,48 @@
+#pragma once
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "Texture.hpp"
+#include "TextureLoadOptions.hpp"
+
+/**
+ * @class TextureManager TextureManager.hpp "include/TextureManager.hpp"
+ * @brief Deduplicates textures by source URI and by content hash of the encoded bytes
+ * 
+ * Textures are handed out as shared handles, so an image referenced by many materials or models is decoded and
+ * uploaded once and freed when the last handle goes away. Shared textures are not tied to a texture unit, bind
+ * them with Texture::bind(GLenum).
+ */
+class TextureManager
+{
+public:
+
+	using Handle = std::shared_ptr<Texture>;
+	using Loader = std::function<Handle(const unsigned char *encoded, std::size_t size, const TextureLoadOptions &options)>;
+
+	TextureManager();
+	TextureManager(Loader loader);
+	TextureManager(const TextureManager &rhs) = delete;
+	TextureManager(TextureManager &&rhs) = default;
+	~TextureManager() = default;
+
+	TextureManager &operator=(const TextureManager &rhs) = delete;
+	TextureManager &operator=(TextureManager &&rhs) = default;
+
+	Handle load(const std::string &uri, const TextureLoadOptions &options=TextureLoadOptions {});
+	Handle load(const unsigned char *encoded, std::size_t size, const TextureLoadOptions &options=TextureLoadOptions {});
+	std::size_t getLiveCount();
+	void purge();
+
+private:
+
+	Handle findOrCreate(std::uint64_t contentKey, const unsigned char *encoded, std::size_t size, const TextureLoadOptions &options);
+
+	Loader _loader {};
+	std::unordered_map<std::string, std::weak_ptr<Texture>> _byUri {};
+	std::unordered_map<std::uint64_t, std::weak_ptr<Texture>> _byContent {};
+};
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Camera.hpp"
+#include "Ktx2.hpp"
+#include "MappedFile.hpp"
+#include "Texture.hpp"
+
+/**
+ * @class TextureStreamer TextureStreamer.hpp "include/TextureStreamer.hpp"
+ * @brief Keeps the resident mip levels of KTX2 textures within a GPU memory budget
+ * 
+ * Textures start out with only their mip tail resident. Every frame the renderer reports where each texture is
+ * used (bounds and UV density of the mesh), update() turns that into the level needed for the projected texel
+ * density and streams levels in, coarse to fine, evicting the least recently used textures' finest levels when
+ * the budget would be exceeded. Residency is expressed through GL_TEXTURE_BASE_LEVEL, see
+ * Texture::setResidentBaseLevel().
+ */
+class TextureStreamer
+{
+public:
+
+	using Id = std::size_t;
+
+	static constexpr int tailDimension { 64 };
+	static constexpr std::size_t defaultUploadBudget { 16 * 1024 * 1024 };
+
+	TextureStreamer() = delete;
+	TextureStreamer(const TextureStreamer &rhs) = delete;
+	TextureStreamer(TextureStreamer &&rhs) = default;
+	TextureStreamer(std::size_t budget);
+	~TextureStreamer() = default;
+
+	TextureStreamer &operator=(const TextureStreamer &rhs) = delete;
+	TextureStreamer &operator=(TextureStreamer &&rhs) = default;
+
+	Id add(const std::string &path, GLenum target=GL_TEXTURE0);
+	void request(Id id, const glm::vec3 &center, float radius, float uvDensity);
+	void update(Camera &camera, int viewportHeight, std::size_t uploadBudget=defaultUploadBudget);
+	Texture &getTexture(Id id);
+	std::size_t getResidentBytes();
+	std::size_t getBudget();
+	void setBudget(std::size_t budget);
+
+	static float computeUvDensity(const std::vector<glm::vec3> &positions, const std::vector<glm::vec2> &uvs, const std::vector<unsigned int> &indices);
+	static std::size_t computeDesiredLevel(float distance, float fov, int viewportHeight, float uvDensity, int width, std::size_t levelCount);
+
+private:
+
+	struct Use
+	{
+		glm::vec3 center {};
+		float radius {};
+		float uvDensity {};
+	};
+
+	struct Entry
+	{
+		Entry(MappedFile &&mapped, GLenum target);
+
+		MappedFile file;
+		Ktx2 container;
+		Texture texture;
+		std::size_t tailLevel {};
+		std::size_t desiredLevel {};
+		std::uint64_t lastUsed {};
+		std::vector<Use> uses {};
+	};
+
+	std::size_t levelBytes(Entry &entry, std::size_t level);
+	bool makeRoom(std::size_t bytes, Entry *keep);
+	void setBaseLevel(Entry &entry, std::size_t level);
+
+	std::vector<std::unique_ptr<Entry>> _entries {};
+	std::size_t _budget {};
+	std::size_t _residentBytes {};
+	std::uint64_t _frame { 1 };
+};
\ No newline at end of file
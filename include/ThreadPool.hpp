@@ -0,0 +1,69 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @class ThreadPool ThreadPool.hpp "include/ThreadPool.hpp"
+ * @brief A fixed set of worker threads for CPU side asset processing
+ * 
+ * parallelFor() lets the calling thread take part in the work, so it is safe to nest, e.g. to encode blocks in
+ * parallel from inside a task that processes one of several images.
+ */
+class ThreadPool
+{
+public:
+
+	ThreadPool() = delete;
+	ThreadPool(const ThreadPool &rhs) = delete;
+	ThreadPool(ThreadPool &&rhs) = delete;
+	ThreadPool(unsigned threadCount);
+	~ThreadPool();
+
+	ThreadPool &operator=(const ThreadPool &rhs) = delete;
+	ThreadPool &operator=(ThreadPool &&rhs) = delete;
+
+	template <typename F>
+	std::future<typename std::result_of<F()>::type> submit(F task);
+	void parallelFor(std::size_t begin, std::size_t end, const std::function<void(std::size_t, std::size_t)> &body, std::size_t grain=1);
+	unsigned getThreadCount();
+
+	static ThreadPool &shared();
+
+private:
+
+	void enqueue(std::function<void()> job);
+	void work();
+
+	std::vector<std::thread> _workers {};
+	std::queue<std::function<void()>> _jobs {};
+	std::mutex _mutex {};
+	std::condition_variable _condition {};
+	bool _stopping {};
+};
+
+/**
+ * @brief Runs a task on a worker thread
+ * 
+ * @param task Callable taking no arguments
+ * 
+ * @returns Future for the task's result. Exceptions thrown by the task are rethrown by future::get()
+ */
+template <typename F>
+std::future<typename std::result_of<F()>::type> ThreadPool::submit(F task)
+{
+	using Result = typename std::result_of<F()>::type;
+
+	auto packaged { std::make_shared<std::packaged_task<Result()>>(std::move(task)) };
+	std::future<Result> result { packaged->get_future() };
+	enqueue([packaged]() { (*packaged)(); });
+
+	return result;
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <stdexcept>
+#include "MappedFile.hpp"
+#include "MipChain.hpp"
+
+/**
+ * @class TileFile TileFile.hpp "include/TileFile.hpp"
+ * @brief A mip chain split into fixed-size RGBA8 tiles on disk, the backing store of a VirtualTexture
+ * 
+ * Every tile is stored as a page of tileSize + 2 * border texels per side, the border holding the neighbouring
+ * texels (clamped at the image edge) so pages can be filtered bilinearly once placed next to unrelated pages in
+ * the atlas. Pages of a level are stored row by row, level 0 first, so any tile is found by its index alone. The
+ * file is memory mapped, only tiles which are actually uploaded get paged in.
+ */
+class TileFile
+{
+public:
+
+	static constexpr int defaultTileSize { 128 };
+	static constexpr int defaultBorder { 4 };
+
+	TileFile() = delete;
+	TileFile(const TileFile &rhs) = delete;
+	TileFile(TileFile &&rhs) = default;
+	TileFile(const std::string &path);
+	~TileFile() = default;
+
+	TileFile &operator=(const TileFile &rhs) = delete;
+	TileFile &operator=(TileFile &&rhs) = default;
+
+	int getWidth();
+	int getHeight();
+	int getTileSize();
+	int getBorder();
+	int getPageSize();
+	std::size_t getPageBytes();
+	bool isSrgb();
+	std::size_t getLevelCount();
+	int getTilesX(std::size_t level);
+	int getTilesY(std::size_t level);
+	const unsigned char *getPage(std::size_t level, int x, int y);
+
+	static void write(const std::string &path, MipChain &chain, bool srgb, int tileSize=defaultTileSize, int border=defaultBorder);
+
+	class InvalidFileException : public std::runtime_error
+	{
+	public:
+		using std::runtime_error::runtime_error;
+	};
+
+private:
+
+	std::size_t pageIndex(std::size_t level, int x, int y);
+
+	MappedFile _file;
+	int _width {};
+	int _height {};
+	int _tileSize {};
+	int _border {};
+	bool _srgb {};
+	std::size_t _levelCount {};
+};
\ No newline at end of file
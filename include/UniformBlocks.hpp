@@ -0,0 +1,158 @@
+#pragma once
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <cstddef>
+#include <string>
+#include <glm/glm.hpp>
+
+/**
+ * @brief std140 base alignment, size and GLSL name of a member type of a uniform block
+ * 
+ * Only types whose std140 layout C++ reproduces with alignas are specialized. Arrays and mat3, whose elements and
+ * columns std140 pads to 16 bytes, are deliberately missing, use vec4 and mat4 instead.
+ */
+template <typename T>
+struct Std140;
+
+#define STD140_TYPE(type, glslName, baseAlignment) \
+	template <> \
+	struct Std140<type> \
+	{ \
+		static constexpr std::size_t alignment { baseAlignment }; \
+		static constexpr std::size_t size { sizeof(type) }; \
+		static const char *glsl() { return glslName; } \
+	};
+
+STD140_TYPE(float, "float", 4)
+STD140_TYPE(GLint, "int", 4)
+STD140_TYPE(glm::vec2, "vec2", 8)
+STD140_TYPE(glm::vec3, "vec3", 16)
+STD140_TYPE(glm::vec4, "vec4", 16)
+STD140_TYPE(glm::ivec4, "ivec4", 16)
+STD140_TYPE(glm::mat4, "mat4", 16)
+
+#undef STD140_TYPE
+
+/*
+ * The members of every block, in declaration order. Each list is expanded into the C++ struct, the GLSL
+ * declaration and the compile time layout checks, so the two sides cannot drift apart.
+ */
+#define FRAME_BLOCK_MEMBERS(X) \
+	X(glm::mat4, view) \
+	X(glm::mat4, projection) \
+	X(glm::vec3, cameraPosition) \
+	X(float, time)
+
+#define MATERIAL_BLOCK_MEMBERS(X) \
+	X(glm::vec4, baseColorFactor) \
+	X(glm::vec3, emissiveFactor) \
+	X(float, metallicFactor) \
+	X(float, roughnessFactor) \
+	X(float, normalScale) \
+	X(float, occlusionStrength) \
+	X(float, alphaCutoff)
+
+#define OBJECT_BLOCK_MEMBERS(X) \
+	X(glm::mat4, model) \
+	X(glm::mat4, normalMatrix)
+
+#define UNIFORM_BLOCK_MEMBER(type, member) alignas(Std140<type>::alignment) type member {};
+
+/**
+ * @brief Per frame uniforms, uploaded and bound once per frame
+ */
+struct FrameBlock
+{
+	FRAME_BLOCK_MEMBERS(UNIFORM_BLOCK_MEMBER)
+
+	static constexpr GLuint binding { 0 };
+	static constexpr const char *name { "FrameBlock" };
+	static constexpr const char *instance { "frame" };
+	static std::string declaration();
+};
+
+/**
+ * @brief glTF material factors, uploaded once per material and bound when the material changes
+ */
+struct MaterialBlock
+{
+	MATERIAL_BLOCK_MEMBERS(UNIFORM_BLOCK_MEMBER)
+
+	static constexpr GLuint binding { 1 };
+	static constexpr const char *name { "MaterialBlock" };
+	static constexpr const char *instance { "material" };
+	static std::string declaration();
+};
+
+/**
+ * @brief Per object transforms, uploaded for all objects at once and bound per draw, see UniformBuffer
+ */
+struct ObjectBlock
+{
+	OBJECT_BLOCK_MEMBERS(UNIFORM_BLOCK_MEMBER)
+
+	static constexpr GLuint binding { 2 };
+	static constexpr const char *name { "ObjectBlock" };
+	static constexpr const char *instance { "object" };
+	static std::string declaration();
+};
+
+#undef UNIFORM_BLOCK_MEMBER
+
+struct Std140Member
+{
+	std::size_t alignment;
+	std::size_t size;
+};
+
+// Offset std140 assigns to the member at index, every member starts at the next multiple of its base alignment
+constexpr std::size_t std140Offset(const Std140Member *members, std::size_t index)
+{
+	std::size_t offset {};
+	for (std::size_t i = 0; i <= index; i++)
+	{
+		offset = (offset + members[i].alignment - 1) / members[i].alignment * members[i].alignment;
+		if (i < index)
+			offset += members[i].size;
+	}
+	return offset;
+}
+
+#define UNIFORM_BLOCK_INDEX(type, member) member,
+#define UNIFORM_BLOCK_LAYOUT(type, member) Std140Member { Std140<type>::alignment, Std140<type>::size },
+#define UNIFORM_BLOCK_CHECK(type, member) static_assert(offsetof(Block, member) == std140Offset(layout, Member::member), "C++ offset of " #member " does not match std140");
+#define CHECK_UNIFORM_BLOCK(BlockType, MEMBERS) \
+	namespace BlockType##Layout \
+	{ \
+		using Block = BlockType; \
+		enum Member : std::size_t { MEMBERS(UNIFORM_BLOCK_INDEX) }; \
+		constexpr Std140Member layout[] { MEMBERS(UNIFORM_BLOCK_LAYOUT) }; \
+		MEMBERS(UNIFORM_BLOCK_CHECK) \
+		static_assert(sizeof(Block) % 16 == 0, "Size of " #BlockType " is not a multiple of 16"); \
+	}
+
+CHECK_UNIFORM_BLOCK(FrameBlock, FRAME_BLOCK_MEMBERS)
+CHECK_UNIFORM_BLOCK(MaterialBlock, MATERIAL_BLOCK_MEMBERS)
+CHECK_UNIFORM_BLOCK(ObjectBlock, OBJECT_BLOCK_MEMBERS)
+
+#undef CHECK_UNIFORM_BLOCK
+#undef UNIFORM_BLOCK_CHECK
+#undef UNIFORM_BLOCK_LAYOUT
+#undef UNIFORM_BLOCK_INDEX
+
+/**
+ * @class UniformBlocks UniformBlocks.hpp "include/UniformBlocks.hpp"
+ * @brief Connects the uniform block structs with shader programs
+ * 
+ * declarations() is injected into shader sources, see the Shader constructor taking a prelude, and bind() points
+ * the blocks a linked program uses at their fixed binding points, which GLSL 330 cannot do with layout(binding).
+ */
+class UniformBlocks
+{
+public:
+
+	UniformBlocks() = delete;
+
+	static std::string declarations();
+	static void bind(GLuint program);
+};
\ No newline at end of file
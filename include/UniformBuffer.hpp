@@ -0,0 +1,68 @@
+#pragma once
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <vector>
+
+/**
+ * @class UniformBuffer UniformBuffer.hpp "include/UniformBuffer.hpp"
+ * @brief A uniform buffer object holding one or more instances of a uniform block
+ * 
+ * Instances are spaced by GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, so e.g. the ObjectBlocks of all objects can be
+ * uploaded once per frame and each draw only binds its range. The last uploaded contents are remembered and
+ * updating an instance to the contents it already has uploads nothing.
+ */
+class UniformBuffer
+{
+public:
+
+	UniformBuffer() = delete;
+	UniformBuffer(const UniformBuffer &rhs) = delete;
+	UniformBuffer(UniformBuffer &&rhs);
+	UniformBuffer(GLuint binding, GLsizeiptr size, GLsizei count=1);
+	~UniformBuffer();
+
+	UniformBuffer &operator=(const UniformBuffer &rhs) = delete;
+	UniformBuffer &operator=(UniformBuffer &&rhs);
+
+	template <typename Block>
+	static UniformBuffer create(GLsizei count=1);
+	template <typename Block>
+	void update(const Block &block, GLsizei index=0);
+	void update(const void *data, GLsizeiptr size, GLsizei index=0);
+	void bind(GLsizei index=0);
+	GLsizei getCount();
+
+private:
+
+	GLuint _buffer {};
+	GLuint _binding {};
+	GLsizeiptr _size {};
+	GLsizeiptr _stride {};
+	GLsizei _count {};
+	std::vector<unsigned char> _contents {};
+};
+
+/**
+ * @brief Creates a buffer for a block struct from UniformBlocks.hpp, bound to the block's binding point
+ * 
+ * @param count Number of instances
+ * 
+ * @returns The buffer
+ */
+template <typename Block>
+UniformBuffer UniformBuffer::create(GLsizei count)
+{
+	return UniformBuffer { Block::binding, static_cast<GLsizeiptr>(sizeof(Block)), count };
+}
+
+/**
+ * @brief Uploads an instance of a block struct
+ * 
+ * @param block The new contents
+ * @param index The instance to update
+ */
+template <typename Block>
+void UniformBuffer::update(const Block &block, GLsizei index)
+{
+	update(&block, static_cast<GLsizeiptr>(sizeof(Block)), index);
+}
\ No newline at end of file
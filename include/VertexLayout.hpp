@@ -0,0 +1,30 @@
+#pragma once
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The vertex attributes a mesh provides, matched to shader inputs by name
+ * 
+ * Validated against a program once with ShaderReflection::validate() and turned into vertex array state with
+ * ShaderReflection::bindVertexLayout(), so mismatches are found when a mesh is loaded instead of per draw.
+ */
+struct VertexLayout
+{
+	struct Attribute
+	{
+		std::string name {};
+		// Components per vertex, for matrix inputs per column
+		GLint components { 4 };
+		GLenum type { GL_FLOAT };
+		bool normalized {};
+		GLsizei stride {};
+		std::size_t offset {};
+		// Buffer holding the attribute, 0 for the buffer bound to GL_ARRAY_BUFFER
+		GLuint buffer {};
+	};
+
+	std::vector<Attribute> attributes {};
+};
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include "Shader.hpp"
+#include "TileFile.hpp"
+
+/**
+ * @class VirtualTexture VirtualTexture.hpp "include/VirtualTexture.hpp"
+ * @brief A software virtual texture: a tile file paged into an atlas through an indirection texture
+ * 
+ * Only tiles reported visible by a VirtualTextureFeedback pass are kept in a fixed size atlas of pages. The page
+ * table is kept on the CPU and mirrored into an indirection texture with one texel per tile and one level per
+ * mip, each texel pointing at the page of the finest resident tile covering it. Missing tiles thus fall back to a
+ * coarser ancestor, the coarsest level is always resident. Works on plain GL 3.3, see
+ * res/shaders/virtual_texture.frag for the lookup.
+ */
+class VirtualTexture
+{
+public:
+
+	struct TileId
+	{
+		std::uint32_t level {};
+		std::uint32_t x {};
+		std::uint32_t y {};
+	};
+
+	static constexpr int defaultAtlasPages { 16 };
+	static constexpr int maxAtlasPages { 256 };
+	static constexpr std::size_t defaultUploadsPerFrame { 16 };
+
+	VirtualTexture() = delete;
+	VirtualTexture(const VirtualTexture &rhs) = delete;
+	VirtualTexture(VirtualTexture &&rhs) = delete;
+	VirtualTexture(const std::string &path, int atlasPages=defaultAtlasPages);
+	~VirtualTexture();
+
+	VirtualTexture &operator=(const VirtualTexture &rhs) = delete;
+	VirtualTexture &operator=(VirtualTexture &&rhs) = delete;
+
+	void update(const std::vector<TileId> &visible, std::size_t maxUploads=defaultUploadsPerFrame);
+	void bind(Shader &shader, GLenum indirectionUnit, GLenum atlasUnit, float lodBias=0.0f);
+	TileFile &getTileFile();
+	std::size_t getResidentTileCount();
+	int getAtlasPages();
+
+	class VirtualTextureException : public std::runtime_error
+	{
+	public:
+		using std::runtime_error::runtime_error;
+	};
+
+private:
+
+	struct Slot
+	{
+		TileId tile {};
+		std::uint64_t lastUsed {};
+		bool pinned {};
+	};
+
+	int &pageEntry(const TileId &tile);
+	int allocateSlot();
+	void upload(const TileId &tile, int slot);
+	void updateIndirection();
+
+	TileFile _tiles;
+	int _atlasPages {};
+	GLuint _atlas {};
+	GLuint _indirection {};
+	std::vector<std::vector<int>> _pageTable {};
+	std::vector<Slot> _slots {};
+	std::vector<int> _freeSlots {};
+	std::size_t _residentTiles {};
+	std::uint64_t _frame {};
+};
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <cstdint>
+#include <vector>
+#include <stdexcept>
+#include "VirtualTexture.hpp"
+
+/**
+ * @class VirtualTextureFeedback VirtualTextureFeedback.hpp "include/VirtualTextureFeedback.hpp"
+ * @brief A low resolution render target recording which virtual texture tiles are visible
+ * 
+ * The scene is drawn into it with res/shaders/virtual_feedback.frag, which writes the tile, level and virtual
+ * texture id every fragment needs. The target is read back into one of two pixel pack buffers and decoded a frame
+ * later, so the readback never stalls the pipeline, at the cost of tiles arriving one frame late.
+ */
+class VirtualTextureFeedback
+{
+public:
+
+	struct Request
+	{
+		std::uint32_t textureId {};
+		VirtualTexture::TileId tile {};
+	};
+
+	static constexpr int defaultScale { 8 };
+
+	VirtualTextureFeedback() = delete;
+	VirtualTextureFeedback(const VirtualTextureFeedback &rhs) = delete;
+	VirtualTextureFeedback(VirtualTextureFeedback &&rhs) = delete;
+	VirtualTextureFeedback(int width, int height, int scale=defaultScale);
+	~VirtualTextureFeedback();
+
+	VirtualTextureFeedback &operator=(const VirtualTextureFeedback &rhs) = delete;
+	VirtualTextureFeedback &operator=(VirtualTextureFeedback &&rhs) = delete;
+
+	void resize(int width, int height);
+	void begin();
+	void end();
+	std::vector<VirtualTexture::TileId> getTiles(std::uint32_t textureId);
+	const std::vector<Request> &getRequests();
+	float getLodBias();
+
+	class FramebufferException : public std::runtime_error
+	{
+	public:
+		using std::runtime_error::runtime_error;
+	};
+
+private:
+
+	void create();
+	void destroy();
+	void collect(int index);
+
+	int _width {};
+	int _height {};
+	int _scale {};
+	GLuint _framebuffer {};
+	GLuint _color {};
+	GLuint _depth {};
+	GLuint _buffers[2] {};
+	GLsync _fences[2] {};
+	GLint _viewport[4] {};
+	int _current {};
+	std::vector<Request> _requests {};
+};
\ No newline at end of file
@@ -0,0 +1,1128 @@
+#include "BlockCompression.hpp"
+#include "GLExtensions.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	constexpr int blockPixels { 16 };
+	constexpr int powerIterations { 4 };
+
+	/**
+	 * Gathers a 4x4 block as RGBA, replicating edge pixels for blocks hanging off the image and expanding grey
+	 * and grey-alpha images.
+	 */
+	void fetchBlock(const unsigned char *pixels, int width, int height, int channels, int bx, int by, unsigned char *rgba)
+	{
+		for (int y = 0; y < 4; y++)
+		{
+			const int sy { std::min(by * 4 + y, height - 1) };
+			for (int x = 0; x < 4; x++)
+			{
+				const int sx { std::min(bx * 4 + x, width - 1) };
+				const unsigned char *src { pixels + (static_cast<std::size_t>(sy) * width + sx) * channels };
+				unsigned char *dst { rgba + (y * 4 + x) * 4 };
+				if (channels >= 3)
+				{
+					dst[0] = src[0];
+					dst[1] = src[1];
+					dst[2] = src[2];
+					dst[3] = channels == 4 ? src[3] : 255;
+				}
+				else
+				{
+					dst[0] = dst[1] = dst[2] = src[0];
+					dst[3] = channels == 2 ? src[1] : 255;
+				}
+			}
+		}
+	}
+
+	void fetchChannel(const unsigned char *pixels, int width, int height, int channels, int bx, int by, int channel, unsigned char *values)
+	{
+		for (int y = 0; y < 4; y++)
+		{
+			const int sy { std::min(by * 4 + y, height - 1) };
+			for (int x = 0; x < 4; x++)
+			{
+				const int sx { std::min(bx * 4 + x, width - 1) };
+				values[y * 4 + x] = channel < channels ? pixels[(static_cast<std::size_t>(sy) * width + sx) * channels + channel] : 0;
+			}
+		}
+	}
+
+	void extractChannel(const unsigned char *rgba, int channel, unsigned char *values)
+	{
+		for (int i = 0; i < blockPixels; i++)
+			values[i] = rgba[i * 4 + channel];
+	}
+
+	void blockBounds(const unsigned char *rgba, unsigned char *minColor, unsigned char *maxColor)
+	{
+#ifdef __SSE2__
+		__m128i lo { _mm_loadu_si128(reinterpret_cast<const __m128i *>(rgba)) };
+		__m128i hi { lo };
+		for (int i = 1; i < 4; i++)
+		{
+			__m128i v { _mm_loadu_si128(reinterpret_cast<const __m128i *>(rgba + i * 16)) };
+			lo = _mm_min_epu8(lo, v);
+			hi = _mm_max_epu8(hi, v);
+		}
+		lo = _mm_min_epu8(lo, _mm_srli_si128(lo, 8));
+		hi = _mm_max_epu8(hi, _mm_srli_si128(hi, 8));
+		lo = _mm_min_epu8(lo, _mm_srli_si128(lo, 4));
+		hi = _mm_max_epu8(hi, _mm_srli_si128(hi, 4));
+		int packedLo { _mm_cvtsi128_si32(lo) };
+		int packedHi { _mm_cvtsi128_si32(hi) };
+		std::memcpy(minColor, &packedLo, 4);
+		std::memcpy(maxColor, &packedHi, 4);
+#else
+		for (int c = 0; c < 4; c++)
+		{
+			minColor[c] = 255;
+			maxColor[c] = 0;
+		}
+		for (int i = 0; i < blockPixels; i++)
+			for (int c = 0; c < 4; c++)
+			{
+				minColor[c] = std::min(minColor[c], rgba[i * 4 + c]);
+				maxColor[c] = std::max(maxColor[c], rgba[i * 4 + c]);
+			}
+#endif
+	}
+
+	std::uint16_t packRgb565(const float *color)
+	{
+		const int r { std::min(std::max(static_cast<int>(color[0] * 31.0f / 255.0f + 0.5f), 0), 31) };
+		const int g { std::min(std::max(static_cast<int>(color[1] * 63.0f / 255.0f + 0.5f), 0), 63) };
+		const int b { std::min(std::max(static_cast<int>(color[2] * 31.0f / 255.0f + 0.5f), 0), 31) };
+		return static_cast<std::uint16_t>((r << 11) | (g << 5) | b);
+	}
+
+	void unpackRgb565(std::uint16_t packed, int *color)
+	{
+		const int r { (packed >> 11) & 31 };
+		const int g { (packed >> 5) & 63 };
+		const int b { packed & 31 };
+		color[0] = (r << 3) | (r >> 2);
+		color[1] = (g << 2) | (g >> 4);
+		color[2] = (b << 3) | (b >> 2);
+	}
+
+	void bc1Palette(std::uint16_t c0, std::uint16_t c1, int palette[4][3])
+	{
+		unpackRgb565(c0, palette[0]);
+		unpackRgb565(c1, palette[1]);
+		for (int c = 0; c < 3; c++)
+		{
+			if (c0 > c1)
+			{
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+			else
+			{
+				palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+				palette[3][c] = 0;
+			}
+		}
+	}
+
+	/**
+	 * Picks the nearest palette entry for every pixel and returns the total squared error.
+	 */
+	int bc1Indices(const unsigned char *rgba, std::uint16_t c0, std::uint16_t c1, std::uint32_t &indices)
+	{
+		int palette[4][3] {};
+		bc1Palette(c0, c1, palette);
+		const int entries { c0 > c1 ? 4 : 3 };
+
+		int total { 0 };
+		indices = 0;
+		for (int i = 0; i < blockPixels; i++)
+		{
+			int best { 0 };
+			int bestError { 1 << 30 };
+			for (int e = 0; e < entries; e++)
+			{
+				const int dr { rgba[i * 4] - palette[e][0] };
+				const int dg { rgba[i * 4 + 1] - palette[e][1] };
+				const int db { rgba[i * 4 + 2] - palette[e][2] };
+				const int error { dr * dr + dg * dg + db * db };
+				if (error < bestError)
+				{
+					best = e;
+					bestError = error;
+				}
+			}
+			total += bestError;
+			indices |= static_cast<std::uint32_t>(best) << (i * 2);
+		}
+		return total;
+	}
+
+	/**
+	 * Solves for the endpoints which minimise the error for a fixed set of four-color indices.
+	 */
+	bool refineEndpoints(const unsigned char *rgba, std::uint32_t indices, float *end0, float *end1)
+	{
+		static const float weights[4] { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+		float aa { 0.0f }, bb { 0.0f }, ab { 0.0f };
+		float ax[3] {}, bx[3] {};
+		for (int i = 0; i < blockPixels; i++)
+		{
+			const float a { weights[(indices >> (i * 2)) & 3] };
+			const float b { 1.0f - a };
+			aa += a * a;
+			bb += b * b;
+			ab += a * b;
+			for (int c = 0; c < 3; c++)
+			{
+				ax[c] += a * rgba[i * 4 + c];
+				bx[c] += b * rgba[i * 4 + c];
+			}
+		}
+		const float det { aa * bb - ab * ab };
+		if (std::fabs(det) < 1e-6f)
+			return false;
+		for (int c = 0; c < 3; c++)
+		{
+			end0[c] = (ax[c] * bb - bx[c] * ab) / det;
+			end1[c] = (bx[c] * aa - ax[c] * ab) / det;
+		}
+		return true;
+	}
+
+	void writeBC1(std::uint16_t c0, std::uint16_t c1, std::uint32_t indices, unsigned char *output)
+	{
+		output[0] = c0 & 0xFF;
+		output[1] = c0 >> 8;
+		output[2] = c1 & 0xFF;
+		output[3] = c1 >> 8;
+		for (int i = 0; i < 4; i++)
+			output[4 + i] = (indices >> (i * 8)) & 0xFF;
+	}
+
+	void encodeBC3Block(const unsigned char *rgba, unsigned char *output)
+	{
+		unsigned char alpha[blockPixels] {};
+		extractChannel(rgba, 3, alpha);
+		BlockCompression::encodeBC4Block(alpha, output);
+		BlockCompression::encodeBC1Block(rgba, output + 8);
+	}
+
+	constexpr int bptcRefinePasses { 3 };
+	constexpr int bc6hMaxHalf { 0x7BFF };
+	constexpr int weights4[16] { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	/**
+	 * Writes the fields of a 128 bit BPTC block, least significant bit first. The block is assembled locally
+	 * since the output may be write-combined mapped memory.
+	 */
+	class BlockWriter
+	{
+	public:
+
+		void write(std::uint32_t value, int count)
+		{
+			for (int i = 0; i < count; i++, _position++)
+				if ((value >> i) & 1)
+					_bits[_position >> 3] |= static_cast<unsigned char>(1 << (_position & 7));
+		}
+
+		void copyTo(unsigned char *output)
+		{
+			std::memcpy(output, _bits, sizeof(_bits));
+		}
+
+	private:
+
+		unsigned char _bits[16] {};
+		int _position { 0 };
+	};
+
+	class BlockReader
+	{
+	public:
+
+		explicit BlockReader(const unsigned char *block) : _block { block } {}
+
+		std::uint32_t read(int count)
+		{
+			std::uint32_t value { 0 };
+			for (int i = 0; i < count; i++, _position++)
+				value |= static_cast<std::uint32_t>((_block[_position >> 3] >> (_position & 7)) & 1) << i;
+			return value;
+		}
+
+	private:
+
+		const unsigned char *_block;
+		int _position { 0 };
+	};
+
+	int interpolate4(int e0, int e1, int index)
+	{
+		return ((64 - weights4[index]) * e0 + weights4[index] * e1 + 32) >> 6;
+	}
+
+	/**
+	 * Finds the principal axis of a block of float pixels (stride 4) and the endpoints spanning the pixels'
+	 * projections onto it. Returns false for a flat block, in which case both endpoints are the mean.
+	 */
+	bool principalEndpoints(const float *pixels, int channels, float *end0, float *end1)
+	{
+		float mean[4] {};
+		for (int i = 0; i < blockPixels; i++)
+			for (int c = 0; c < channels; c++)
+				mean[c] += pixels[i * 4 + c] / blockPixels;
+
+		float cov[4][4] {};
+		for (int i = 0; i < blockPixels; i++)
+			for (int a = 0; a < channels; a++)
+				for (int b = 0; b < channels; b++)
+					cov[a][b] += (pixels[i * 4 + a] - mean[a]) * (pixels[i * 4 + b] - mean[b]);
+
+		int start { 0 };
+		for (int c = 1; c < channels; c++)
+			if (cov[c][c] > cov[start][start])
+				start = c;
+		float axis[4] {};
+		for (int c = 0; c < channels; c++)
+		{
+			axis[c] = cov[start][c];
+			end0[c] = end1[c] = mean[c];
+		}
+		if (cov[start][start] < 1e-6f)
+			return false;
+
+		for (int iteration = 0; iteration < powerIterations * 2; iteration++)
+		{
+			float next[4] {};
+			float length { 0.0f };
+			for (int a = 0; a < channels; a++)
+			{
+				for (int b = 0; b < channels; b++)
+					next[a] += axis[b] * cov[a][b];
+				length = std::max(length, std::fabs(next[a]));
+			}
+			if (length < 1e-6f)
+				break;
+			for (int c = 0; c < channels; c++)
+				axis[c] = next[c] / length;
+		}
+
+		float norm { 0.0f };
+		for (int c = 0; c < channels; c++)
+			norm += axis[c] * axis[c];
+		float lo { 1e30f }, hi { -1e30f };
+		for (int i = 0; i < blockPixels; i++)
+		{
+			float t { 0.0f };
+			for (int c = 0; c < channels; c++)
+				t += (pixels[i * 4 + c] - mean[c]) * axis[c];
+			lo = std::min(lo, t / norm);
+			hi = std::max(hi, t / norm);
+		}
+		for (int c = 0; c < channels; c++)
+		{
+			end0[c] = mean[c] + axis[c] * lo;
+			end1[c] = mean[c] + axis[c] * hi;
+		}
+		return true;
+	}
+
+	/**
+	 * Least squares endpoints for fixed 4-bit BPTC indices, pixels with stride 4.
+	 */
+	bool solveEndpoints(const float *pixels, int channels, const int *indices, float *end0, float *end1)
+	{
+		float aa { 0.0f }, bb { 0.0f }, ab { 0.0f };
+		float ax[4] {}, bx[4] {};
+		for (int i = 0; i < blockPixels; i++)
+		{
+			const float b { weights4[indices[i]] / 64.0f };
+			const float a { 1.0f - b };
+			aa += a * a;
+			bb += b * b;
+			ab += a * b;
+			for (int c = 0; c < channels; c++)
+			{
+				ax[c] += a * pixels[i * 4 + c];
+				bx[c] += b * pixels[i * 4 + c];
+			}
+		}
+		const float det { aa * bb - ab * ab };
+		if (std::fabs(det) < 1e-6f)
+			return false;
+		for (int c = 0; c < channels; c++)
+		{
+			end0[c] = (ax[c] * bb - bx[c] * ab) / det;
+			end1[c] = (bx[c] * aa - ax[c] * ab) / det;
+		}
+		return true;
+	}
+
+	/**
+	 * Picks the best of the 16 interpolated colors for every pixel given decoded endpoints, returns the total
+	 * squared error. The palette is built by the caller since BC6H interpolates before its final scaling.
+	 */
+	std::int64_t pickIndices(const int *target, int channels, const int palette[16][4], int *indices)
+	{
+		std::int64_t total { 0 };
+		for (int i = 0; i < blockPixels; i++)
+		{
+			std::int64_t bestError { std::numeric_limits<std::int64_t>::max() };
+			for (int e = 0; e < 16; e++)
+			{
+				std::int64_t error { 0 };
+				for (int c = 0; c < channels; c++)
+				{
+					const std::int64_t d { target[i * 4 + c] - palette[e][c] };
+					error += d * d;
+				}
+				if (error < bestError)
+				{
+					bestError = error;
+					indices[i] = e;
+				}
+			}
+			total += bestError;
+		}
+		return total;
+	}
+
+	struct Bc7Candidate
+	{
+		int endpoints[2][4] {};
+		int pbits[2] {};
+		int indices[blockPixels] {};
+		std::int64_t error { std::numeric_limits<std::int64_t>::max() };
+	};
+
+	/**
+	 * Quantizes float endpoints to mode 6 (7 bits plus a shared p-bit per endpoint), trying every p-bit pair,
+	 * and keeps the result if it beats the best candidate so far. Opaque blocks keep both p-bits set, the only
+	 * way to decode alpha to exactly 255.
+	 */
+	void tryBc7Endpoints(const int *target, const float *end0, const float *end1, bool opaque, Bc7Candidate &best)
+	{
+		const float *ends[2] { end0, end1 };
+		for (int p0 = opaque ? 1 : 0; p0 < 2; p0++)
+			for (int p1 = opaque ? 1 : 0; p1 < 2; p1++)
+			{
+				Bc7Candidate candidate {};
+				candidate.pbits[0] = p0;
+				candidate.pbits[1] = p1;
+				int decoded[2][4] {};
+				for (int e = 0; e < 2; e++)
+					for (int c = 0; c < 4; c++)
+					{
+						const int p { candidate.pbits[e] };
+						const int q { std::min(std::max(static_cast<int>(std::floor((ends[e][c] - p) / 2.0f + 0.5f)), 0), 127) };
+						candidate.endpoints[e][c] = q;
+						decoded[e][c] = (q << 1) | p;
+					}
+
+				int palette[16][4] {};
+				for (int i = 0; i < 16; i++)
+					for (int c = 0; c < 4; c++)
+						palette[i][c] = interpolate4(decoded[0][c], decoded[1][c], i);
+				candidate.error = pickIndices(target, 4, palette, candidate.indices);
+				if (candidate.error < best.error)
+					best = candidate;
+			}
+	}
+
+	int bc6hUnquantize(int value)
+	{
+		if (value == 0)
+			return 0;
+		if (value == 1023)
+			return 0xFFFF;
+		return ((value << 16) + 0x8000) >> 10;
+	}
+
+	int bc6hFinish(int value)
+	{
+		return (value * 31) >> 6;
+	}
+
+	struct Bc6hCandidate
+	{
+		int endpoints[2][3] {};
+		int indices[blockPixels] {};
+		std::int64_t error { std::numeric_limits<std::int64_t>::max() };
+	};
+
+	/**
+	 * Quantizes endpoints given in unquantized space (before the final 31/64 scaling) to 10 bits and keeps the
+	 * result if it beats the best candidate so far.
+	 */
+	void tryBc6hEndpoints(const int *target, const float *end0, const float *end1, Bc6hCandidate &best)
+	{
+		Bc6hCandidate candidate {};
+		const float *ends[2] { end0, end1 };
+		int decoded[2][3] {};
+		for (int e = 0; e < 2; e++)
+			for (int c = 0; c < 3; c++)
+			{
+				candidate.endpoints[e][c] = std::min(std::max(static_cast<int>(std::floor((ends[e][c] - 32.0f) / 64.0f + 0.5f)), 0), 1023);
+				decoded[e][c] = bc6hUnquantize(candidate.endpoints[e][c]);
+			}
+
+		int palette[16][4] {};
+		for (int i = 0; i < 16; i++)
+			for (int c = 0; c < 3; c++)
+				palette[i][c] = bc6hFinish(interpolate4(decoded[0][c], decoded[1][c], i));
+		candidate.error = pickIndices(target, 3, palette, candidate.indices);
+		if (candidate.error < best.error)
+			best = candidate;
+	}
+
+	void fetchBlockFloat(const float *pixels, int width, int height, int channels, int bx, int by, float *rgb)
+	{
+		for (int y = 0; y < 4; y++)
+		{
+			const int sy { std::min(by * 4 + y, height - 1) };
+			for (int x = 0; x < 4; x++)
+			{
+				const int sx { std::min(bx * 4 + x, width - 1) };
+				const float *src { pixels + (static_cast<std::size_t>(sy) * width + sx) * channels };
+				float *dst { rgb + (y * 4 + x) * 3 };
+				for (int c = 0; c < 3; c++)
+					dst[c] = src[channels >= 3 ? c : 0];
+			}
+		}
+	}
+}
+
+/**
+ * @brief Encodes a whole image, rows of blocks in parallel
+ * 
+ * Partial blocks at the right and bottom edges replicate the border pixels. The output must hold
+ * getCompressedSize() bytes and may be mapped buffer memory, it is only ever written.
+ * 
+ * @param format The block format to encode to
+ * @param pixels Tightly packed 8-bit pixels
+ * @param width Width of the image in pixels
+ * @param height Height of the image in pixels
+ * @param channels Number of channels per pixel. BC4 encodes the first, BC5 the first two as they are, while the
+ * color formats treat one and two channel images as grey and grey-alpha. BC6H takes the values as linear
+ * @param output Destination for the blocks, in row major block order
+ * @param pool The pool to encode on. Defaults to the shared pool
+ */
+void BlockCompression::encode(Format format, const unsigned char *pixels, int width, int height, int channels, unsigned char *output, ThreadPool &pool)
+{
+	const int blocksX { (width + 3) / 4 };
+	const int blocksY { (height + 3) / 4 };
+	const std::size_t blockSize { getBlockSize(format) };
+
+	pool.parallelFor(0, blocksY, [&](std::size_t begin, std::size_t end)
+	{
+		unsigned char rgba[blockPixels * 4] {};
+		unsigned char values[blockPixels] {};
+		float rgb[blockPixels * 3] {};
+		for (std::size_t by = begin; by < end; by++)
+			for (int bx = 0; bx < blocksX; bx++)
+			{
+				unsigned char *block { output + (by * blocksX + bx) * blockSize };
+				switch (format)
+				{
+					case Format::BC1:
+						fetchBlock(pixels, width, height, channels, bx, static_cast<int>(by), rgba);
+						encodeBC1Block(rgba, block);
+						break;
+					case Format::BC3:
+						fetchBlock(pixels, width, height, channels, bx, static_cast<int>(by), rgba);
+						encodeBC3Block(rgba, block);
+						break;
+					case Format::BC4:
+						fetchChannel(pixels, width, height, channels, bx, static_cast<int>(by), 0, values);
+						encodeBC4Block(values, block);
+						break;
+					case Format::BC5:
+						fetchChannel(pixels, width, height, channels, bx, static_cast<int>(by), 0, values);
+						encodeBC4Block(values, block);
+						fetchChannel(pixels, width, height, channels, bx, static_cast<int>(by), 1, values);
+						encodeBC4Block(values, block + 8);
+						break;
+					case Format::BC6H:
+						fetchBlock(pixels, width, height, channels, bx, static_cast<int>(by), rgba);
+						for (int i = 0; i < blockPixels; i++)
+							for (int c = 0; c < 3; c++)
+								rgb[i * 3 + c] = rgba[i * 4 + c] / 255.0f;
+						encodeBC6HBlock(rgb, block);
+						break;
+					case Format::BC7:
+						fetchBlock(pixels, width, height, channels, bx, static_cast<int>(by), rgba);
+						encodeBC7Block(rgba, block);
+						break;
+				}
+			}
+	}, std::max(1, 64 / blocksX));
+}
+
+/**
+ * @brief Encodes a whole floating point image to BC6H, rows of blocks in parallel
+ * 
+ * @param pixels Tightly packed linear float pixels, negative values are clamped to zero
+ * @param width Width of the image in pixels
+ * @param height Height of the image in pixels
+ * @param channels Number of channels per pixel. One and two channel images are encoded as grey, alpha is dropped
+ * @param output Destination for getCompressedSize(Format::BC6H, width, height) bytes of blocks
+ * @param pool The pool to encode on. Defaults to the shared pool
+ */
+void BlockCompression::encodeHdr(const float *pixels, int width, int height, int channels, unsigned char *output, ThreadPool &pool)
+{
+	const int blocksX { (width + 3) / 4 };
+	const int blocksY { (height + 3) / 4 };
+
+	pool.parallelFor(0, blocksY, [&](std::size_t begin, std::size_t end)
+	{
+		float rgb[blockPixels * 3] {};
+		for (std::size_t by = begin; by < end; by++)
+			for (int bx = 0; bx < blocksX; bx++)
+			{
+				fetchBlockFloat(pixels, width, height, channels, bx, static_cast<int>(by), rgb);
+				encodeBC6HBlock(rgb, output + (by * blocksX + bx) * 16);
+			}
+	}, 1);
+}
+
+/**
+ * @brief Encodes one opaque BC1 block
+ * 
+ * Endpoints start at the extremes of the pixels projected onto the block's principal axis and are refined once
+ * by least squares; whichever set of endpoints gives the lower error is kept.
+ * 
+ * @param rgba 16 RGBA pixels in row major order
+ * @param output 8 bytes of output
+ */
+void BlockCompression::encodeBC1Block(const unsigned char *rgba, unsigned char *output)
+{
+	unsigned char minColor[4] {}, maxColor[4] {};
+	blockBounds(rgba, minColor, maxColor);
+	if (minColor[0] == maxColor[0] && minColor[1] == maxColor[1] && minColor[2] == maxColor[2])
+	{
+		const float color[3] { static_cast<float>(minColor[0]), static_cast<float>(minColor[1]), static_cast<float>(minColor[2]) };
+		const std::uint16_t packed { packRgb565(color) };
+		writeBC1(packed, packed, 0, output);
+		return;
+	}
+
+	float mean[3] {};
+	for (int i = 0; i < blockPixels; i++)
+		for (int c = 0; c < 3; c++)
+			mean[c] += rgba[i * 4 + c] / static_cast<float>(blockPixels);
+
+	float cov[6] {};
+	for (int i = 0; i < blockPixels; i++)
+	{
+		const float r { rgba[i * 4] - mean[0] };
+		const float g { rgba[i * 4 + 1] - mean[1] };
+		const float b { rgba[i * 4 + 2] - mean[2] };
+		cov[0] += r * r;
+		cov[1] += r * g;
+		cov[2] += r * b;
+		cov[3] += g * g;
+		cov[4] += g * b;
+		cov[5] += b * b;
+	}
+
+	// Start the power iteration from the covariance column with the largest variance, the bounding box diagonal
+	// would be orthogonal to the axis of anti-correlated channels
+	const int start { cov[0] >= cov[3] && cov[0] >= cov[5] ? 0 : cov[3] >= cov[5] ? 1 : 2 };
+	const int column[3][3] { { 0, 1, 2 }, { 1, 3, 4 }, { 2, 4, 5 } };
+	float axis[3] { cov[column[start][0]], cov[column[start][1]], cov[column[start][2]] };
+	for (int iteration = 0; iteration < powerIterations; iteration++)
+	{
+		const float x { axis[0] * cov[0] + axis[1] * cov[1] + axis[2] * cov[2] };
+		const float y { axis[0] * cov[1] + axis[1] * cov[3] + axis[2] * cov[4] };
+		const float z { axis[0] * cov[2] + axis[1] * cov[4] + axis[2] * cov[5] };
+		const float length { std::max(std::fabs(x), std::max(std::fabs(y), std::fabs(z))) };
+		if (length < 1e-6f)
+			break;
+		axis[0] = x / length;
+		axis[1] = y / length;
+		axis[2] = z / length;
+	}
+
+	int lo { 0 }, hi { 0 };
+	float loDot { 1e30f }, hiDot { -1e30f };
+	for (int i = 0; i < blockPixels; i++)
+	{
+		const float d { rgba[i * 4] * axis[0] + rgba[i * 4 + 1] * axis[1] + rgba[i * 4 + 2] * axis[2] };
+		if (d < loDot)
+		{
+			loDot = d;
+			lo = i;
+		}
+		if (d > hiDot)
+		{
+			hiDot = d;
+			hi = i;
+		}
+	}
+
+	float end0[3] {}, end1[3] {};
+	for (int c = 0; c < 3; c++)
+	{
+		end0[c] = rgba[hi * 4 + c];
+		end1[c] = rgba[lo * 4 + c];
+	}
+
+	std::uint16_t c0 { packRgb565(end0) };
+	std::uint16_t c1 { packRgb565(end1) };
+	if (c0 < c1)
+		std::swap(c0, c1);
+	std::uint32_t indices {};
+	int error { bc1Indices(rgba, c0, c1, indices) };
+
+	if (c0 != c1 && refineEndpoints(rgba, indices, end0, end1))
+	{
+		std::uint16_t r0 { packRgb565(end0) };
+		std::uint16_t r1 { packRgb565(end1) };
+		if (r0 < r1)
+			std::swap(r0, r1);
+		std::uint32_t refinedIndices {};
+		const int refinedError { bc1Indices(rgba, r0, r1, refinedIndices) };
+		if (r0 != r1 && refinedError < error)
+		{
+			c0 = r0;
+			c1 = r1;
+			indices = refinedIndices;
+			error = refinedError;
+		}
+	}
+
+	if (c0 == c1)
+		indices = 0;
+	writeBC1(c0, c1, indices, output);
+}
+
+/**
+ * @brief Encodes one BC4 block, also used for the alpha of BC3 and both channels of BC5
+ * 
+ * Uses the eight value mode with the block's extremes as endpoints.
+ * 
+ * @param values 16 single channel values in row major order
+ * @param output 8 bytes of output
+ */
+void BlockCompression::encodeBC4Block(const unsigned char *values, unsigned char *output)
+{
+	const unsigned char maxValue { *std::max_element(values, values + blockPixels) };
+	const unsigned char minValue { *std::min_element(values, values + blockPixels) };
+
+	int palette[8] { maxValue, minValue };
+	for (int i = 2; i < 8; i++)
+		palette[i] = ((8 - i) * maxValue + (i - 1) * minValue) / 7;
+
+	std::uint64_t indices { 0 };
+	if (maxValue != minValue)
+		for (int i = 0; i < blockPixels; i++)
+		{
+			int best { 0 };
+			int bestError { 256 };
+			for (int e = 0; e < 8; e++)
+			{
+				const int error { std::abs(values[i] - palette[e]) };
+				if (error < bestError)
+				{
+					best = e;
+					bestError = error;
+				}
+			}
+			indices |= static_cast<std::uint64_t>(best) << (i * 3);
+		}
+
+	output[0] = maxValue;
+	output[1] = minValue;
+	for (int i = 0; i < 6; i++)
+		output[2 + i] = (indices >> (i * 8)) & 0xFF;
+}
+
+/**
+ * @brief Encodes one BC6H block (unsigned float) in mode 11
+ * 
+ * Fitting happens on the half float bit patterns, which are roughly logarithmic, so relative error is spread
+ * evenly across the block's range. Endpoints start at the extremes of the principal axis and are refined by
+ * least squares for a few passes, keeping the best quantized set.
+ * 
+ * @param rgb 16 linear RGB pixels in row major order, negative values are clamped to zero
+ * @param output 16 bytes of output
+ */
+void BlockCompression::encodeBC6HBlock(const float *rgb, unsigned char *output)
+{
+	int target[blockPixels * 4] {};
+	float unquantized[blockPixels * 4] {};
+	for (int i = 0; i < blockPixels; i++)
+		for (int c = 0; c < 3; c++)
+		{
+			const float value { rgb[i * 3 + c] > 0.0f ? rgb[i * 3 + c] : 0.0f };
+			target[i * 4 + c] = std::min<int>(floatToHalf(value), bc6hMaxHalf);
+			unquantized[i * 4 + c] = target[i * 4 + c] * 64.0f / 31.0f;
+		}
+
+	float end0[4] {}, end1[4] {};
+	Bc6hCandidate best {};
+	principalEndpoints(unquantized, 3, end0, end1);
+	tryBc6hEndpoints(target, end0, end1, best);
+	for (int pass = 0; pass < bptcRefinePasses && best.error > 0; pass++)
+	{
+		if (!solveEndpoints(unquantized, 3, best.indices, end0, end1))
+			break;
+		tryBc6hEndpoints(target, end0, end1, best);
+	}
+
+	// The anchor index is stored with its top bit implied to be zero
+	if (best.indices[0] >= 8)
+	{
+		std::swap(best.endpoints[0], best.endpoints[1]);
+		for (int &index : best.indices)
+			index = 15 - index;
+	}
+
+	BlockWriter writer {};
+	writer.write(0x03, 5);
+	for (int e = 0; e < 2; e++)
+		for (int c = 0; c < 3; c++)
+			writer.write(best.endpoints[e][c], 10);
+	for (int i = 0; i < blockPixels; i++)
+		writer.write(best.indices[i], i == 0 ? 3 : 4);
+	writer.copyTo(output);
+}
+
+/**
+ * @brief Encodes one BC7 block in mode 6
+ * 
+ * Mode 6 stores a single subset with 7-bit RGBA endpoints, a p-bit per endpoint and 4-bit indices, which suits
+ * smooth color and alpha alike. Every p-bit combination is tried for the principal axis endpoints and for each
+ * least squares refinement, keeping the lowest error.
+ * 
+ * @param rgba 16 RGBA pixels in row major order
+ * @param output 16 bytes of output
+ */
+void BlockCompression::encodeBC7Block(const unsigned char *rgba, unsigned char *output)
+{
+	int target[blockPixels * 4] {};
+	float pixels[blockPixels * 4] {};
+	for (int i = 0; i < blockPixels * 4; i++)
+	{
+		target[i] = rgba[i];
+		pixels[i] = rgba[i];
+	}
+
+	bool opaque { true };
+	for (int i = 0; i < blockPixels; i++)
+		opaque = opaque && rgba[i * 4 + 3] == 255;
+
+	float end0[4] {}, end1[4] {};
+	Bc7Candidate best {};
+	principalEndpoints(pixels, 4, end0, end1);
+	tryBc7Endpoints(target, end0, end1, opaque, best);
+	for (int pass = 0; pass < bptcRefinePasses && best.error > 0; pass++)
+	{
+		if (!solveEndpoints(pixels, 4, best.indices, end0, end1))
+			break;
+		tryBc7Endpoints(target, end0, end1, opaque, best);
+	}
+
+	// The anchor index is stored with its top bit implied to be zero
+	if (best.indices[0] >= 8)
+	{
+		std::swap(best.endpoints[0], best.endpoints[1]);
+		std::swap(best.pbits[0], best.pbits[1]);
+		for (int &index : best.indices)
+			index = 15 - index;
+	}
+
+	BlockWriter writer {};
+	writer.write(1 << 6, 7);
+	for (int c = 0; c < 4; c++)
+		for (int e = 0; e < 2; e++)
+			writer.write(best.endpoints[e][c], 7);
+	writer.write(best.pbits[0], 1);
+	writer.write(best.pbits[1], 1);
+	for (int i = 0; i < blockPixels; i++)
+		writer.write(best.indices[i], i == 0 ? 3 : 4);
+	writer.copyTo(output);
+}
+
+/**
+ * @brief Decodes one BC1 block
+ * 
+ * @param block 8 bytes of BC1 data
+ * @param rgba Receives 16 RGBA pixels in row major order
+ */
+void BlockCompression::decodeBC1Block(const unsigned char *block, unsigned char *rgba)
+{
+	const std::uint16_t c0 { static_cast<std::uint16_t>(block[0] | (block[1] << 8)) };
+	const std::uint16_t c1 { static_cast<std::uint16_t>(block[2] | (block[3] << 8)) };
+	int palette[4][3] {};
+	bc1Palette(c0, c1, palette);
+
+	for (int i = 0; i < blockPixels; i++)
+	{
+		const int index { (block[4 + i / 4] >> ((i % 4) * 2)) & 3 };
+		for (int c = 0; c < 3; c++)
+			rgba[i * 4 + c] = static_cast<unsigned char>(palette[index][c]);
+		rgba[i * 4 + 3] = (c0 <= c1 && index == 3) ? 0 : 255;
+	}
+}
+
+/**
+ * @brief Decodes one BC4 block
+ * 
+ * @param block 8 bytes of BC4 data
+ * @param values Receives 16 single channel values in row major order
+ */
+void BlockCompression::decodeBC4Block(const unsigned char *block, unsigned char *values)
+{
+	int palette[8] { block[0], block[1] };
+	if (block[0] > block[1])
+	{
+		for (int i = 2; i < 8; i++)
+			palette[i] = ((8 - i) * block[0] + (i - 1) * block[1]) / 7;
+	}
+	else
+	{
+		for (int i = 2; i < 6; i++)
+			palette[i] = ((6 - i) * block[0] + (i - 1) * block[1]) / 5;
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+
+	std::uint64_t indices { 0 };
+	for (int i = 0; i < 6; i++)
+		indices |= static_cast<std::uint64_t>(block[2 + i]) << (i * 8);
+	for (int i = 0; i < blockPixels; i++)
+		values[i] = static_cast<unsigned char>(palette[(indices >> (i * 3)) & 7]);
+}
+
+/**
+ * @brief Decodes one BC6H block written in mode 11
+ * 
+ * Only mode 11, as written by encodeBC6HBlock, is understood, other modes decode to black.
+ * 
+ * @param block 16 bytes of BC6H data
+ * @param rgb Receives 16 RGB float pixels in row major order
+ */
+void BlockCompression::decodeBC6HBlock(const unsigned char *block, float *rgb)
+{
+	BlockReader reader { block };
+	if (reader.read(5) != 0x03)
+	{
+		std::fill(rgb, rgb + blockPixels * 3, 0.0f);
+		return;
+	}
+
+	int endpoints[2][3] {};
+	for (int e = 0; e < 2; e++)
+		for (int c = 0; c < 3; c++)
+			endpoints[e][c] = bc6hUnquantize(static_cast<int>(reader.read(10)));
+	for (int i = 0; i < blockPixels; i++)
+	{
+		const int index { static_cast<int>(reader.read(i == 0 ? 3 : 4)) };
+		for (int c = 0; c < 3; c++)
+			rgb[i * 3 + c] = halfToFloat(static_cast<std::uint16_t>(bc6hFinish(interpolate4(endpoints[0][c], endpoints[1][c], index))));
+	}
+}
+
+/**
+ * @brief Decodes one BC7 block written in mode 6
+ * 
+ * Only mode 6, as written by encodeBC7Block, is understood, other modes decode to transparent black.
+ * 
+ * @param block 16 bytes of BC7 data
+ * @param rgba Receives 16 RGBA pixels in row major order
+ */
+void BlockCompression::decodeBC7Block(const unsigned char *block, unsigned char *rgba)
+{
+	BlockReader reader { block };
+	if (reader.read(7) != (1 << 6))
+	{
+		std::fill(rgba, rgba + blockPixels * 4, 0);
+		return;
+	}
+
+	int endpoints[2][4] {};
+	for (int c = 0; c < 4; c++)
+		for (int e = 0; e < 2; e++)
+			endpoints[e][c] = static_cast<int>(reader.read(7)) << 1;
+	for (int e = 0; e < 2; e++)
+	{
+		const int p { static_cast<int>(reader.read(1)) };
+		for (int c = 0; c < 4; c++)
+			endpoints[e][c] |= p;
+	}
+	for (int i = 0; i < blockPixels; i++)
+	{
+		const int index { static_cast<int>(reader.read(i == 0 ? 3 : 4)) };
+		for (int c = 0; c < 4; c++)
+			rgba[i * 4 + c] = static_cast<unsigned char>(interpolate4(endpoints[0][c], endpoints[1][c], index));
+	}
+}
+
+/**
+ * @brief Converts a float to the bit pattern of the nearest half float
+ * 
+ * @param value The value to convert
+ * 
+ * @returns IEEE 754 binary16 bits, overflowing to infinity
+ */
+std::uint16_t BlockCompression::floatToHalf(float value)
+{
+	std::uint32_t bits {};
+	std::memcpy(&bits, &value, sizeof(bits));
+	const std::uint32_t sign { (bits >> 16) & 0x8000 };
+	const int exponent { static_cast<int>((bits >> 23) & 0xFF) - 127 + 15 };
+	std::uint32_t mantissa { bits & 0x7FFFFF };
+
+	if (((bits >> 23) & 0xFF) == 0xFF)
+		return static_cast<std::uint16_t>(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+	if (exponent >= 31)
+		return static_cast<std::uint16_t>(sign | 0x7C00);
+	if (exponent <= 0)
+	{
+		if (exponent < -10)
+			return static_cast<std::uint16_t>(sign);
+		mantissa |= 0x800000;
+		const int shift { 14 - exponent };
+		std::uint32_t half { mantissa >> shift };
+		if ((mantissa >> (shift - 1)) & 1)
+			half++;
+		return static_cast<std::uint16_t>(sign | half);
+	}
+	std::uint32_t half { sign | (static_cast<std::uint32_t>(exponent) << 10) | (mantissa >> 13) };
+	if (mantissa & 0x1000)
+		half++;
+	return static_cast<std::uint16_t>(half);
+}
+
+/**
+ * @brief Converts the bit pattern of a half float to a float
+ * 
+ * @param half IEEE 754 binary16 bits
+ * 
+ * @returns The value as a float
+ */
+float BlockCompression::halfToFloat(std::uint16_t half)
+{
+	const std::uint32_t sign { static_cast<std::uint32_t>(half & 0x8000) << 16 };
+	int exponent { (half >> 10) & 0x1F };
+	std::uint32_t mantissa { static_cast<std::uint32_t>(half & 0x3FF) };
+	std::uint32_t bits {};
+
+	if (exponent == 0x1F)
+		bits = sign | 0x7F800000 | (mantissa << 13);
+	else if (exponent == 0)
+	{
+		if (mantissa == 0)
+			bits = sign;
+		else
+		{
+			exponent = 1;
+			while (!(mantissa & 0x400))
+			{
+				mantissa <<= 1;
+				exponent--;
+			}
+			mantissa &= 0x3FF;
+			bits = sign | (static_cast<std::uint32_t>(exponent - 15 + 127) << 23) | (mantissa << 13);
+		}
+	}
+	else
+		bits = sign | (static_cast<std::uint32_t>(exponent - 15 + 127) << 23) | (mantissa << 13);
+
+	float value {};
+	std::memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+/**
+ * @brief Getter for the size of one encoded block
+ * 
+ * @param format The block format
+ * 
+ * @returns Bytes per 4x4 block
+ */
+std::size_t BlockCompression::getBlockSize(Format format)
+{
+	return (format == Format::BC1 || format == Format::BC4) ? 8 : 16;
+}
+
+/**
+ * @brief Computes the size of an encoded image
+ * 
+ * @param format The block format
+ * @param width Width of the image in pixels
+ * @param height Height of the image in pixels
+ * 
+ * @returns Size of the encoded image in bytes
+ */
+std::size_t BlockCompression::getCompressedSize(Format format, int width, int height)
+{
+	return static_cast<std::size_t>((width + 3) / 4) * ((height + 3) / 4) * getBlockSize(format);
+}
+
+/**
+ * @brief Gets the OpenGL internal format to upload a block format with
+ * 
+ * @param format The block format
+ * @param srgb Whether color formats should be decoded as sRGB
+ * 
+ * @returns Internal format for glCompressedTexImage2D
+ */
+GLenum BlockCompression::getInternalFormat(Format format, bool srgb)
+{
+	switch (format)
+	{
+		case Format::BC1:
+			return srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+		case Format::BC3:
+			return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		case Format::BC4:
+			return GL_COMPRESSED_RED_RGTC1;
+		case Format::BC5:
+			return GL_COMPRESSED_RG_RGTC2;
+		case Format::BC6H:
+			return GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT;
+		case Format::BC7:
+			return srgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+	}
+	return GL_NONE;
+}
+
+/**
+ * @brief Checks whether the current context can sample a block format
+ * 
+ * BC1 and BC3 need EXT_texture_compression_s3tc (and EXT_texture_sRGB for sRGB), BC4 and BC5 are core RGTC,
+ * BC6H and BC7 are BPTC from OpenGL 4.2.
+ * 
+ * @param format The block format
+ * @param srgb Whether the sRGB variant is needed
+ * 
+ * @returns true if the format can be uploaded, otherwise false
+ */
+bool BlockCompression::isSupported(Format format, bool srgb)
+{
+	switch (format)
+	{
+		case Format::BC1:
+		case Format::BC3:
+			return hasGLExtension("GL_EXT_texture_compression_s3tc") && (!srgb || hasGLExtension("GL_EXT_texture_sRGB"));
+		case Format::BC4:
+		case Format::BC5:
+			return GLAD_GL_VERSION_3_0 || hasGLExtension("GL_ARB_texture_compression_rgtc");
+		case Format::BC6H:
+		case Format::BC7:
+			return GLAD_GL_VERSION_4_2 || hasGLExtension("GL_ARB_texture_compression_bptc");
+	}
+	return false;
+}
\ No newline at end of file
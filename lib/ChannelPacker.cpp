@@ -0,0 +1,234 @@
+#include <stb_image.h>
+#include "ChannelPacker.hpp"
+#include "JpegDecoder.hpp"
+#include "MipChain.hpp"
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <spdlog/spdlog.h>
+
+namespace
+{
+	constexpr int decodedChannels { 3 };
+
+	int indexOf(std::vector<ChannelPacker::Source> &sources, int occlusion, int metallicRoughness)
+	{
+		auto it { std::find_if(sources.begin(), sources.end(), [=](const ChannelPacker::Source &source)
+		{
+			return source.occlusion == occlusion && source.metallicRoughness == metallicRoughness;
+		}) };
+		if (it != sources.end())
+			return static_cast<int>(it - sources.begin());
+
+		sources.push_back({ occlusion, metallicRoughness });
+		return static_cast<int>(sources.size() - 1);
+	}
+
+	std::string failureMessage()
+	{
+		std::stringstream error {};
+		error << "Failed to load packed texture: " << stbi_failure_reason() << std::endl;
+		return error.str();
+	}
+
+	// Size an image is packed at, scaled down like Texture does if it is larger than maxDimension
+	void sizeOf(const ChannelPacker::Image &image, int maxDimension, int &width, int &height)
+	{
+		int fileChannels {};
+		if (!stbi_info_from_memory(image.encoded, static_cast<int>(image.size), &width, &height, &fileChannels))
+			throw Texture::TextureLoadingException(failureMessage());
+
+		const int largest { std::max(width, height) };
+		if (maxDimension <= 0 || largest <= maxDimension)
+			return;
+		const double scale { static_cast<double>(maxDimension) / largest };
+		width = std::max(static_cast<int>(width * scale + 0.5), 1);
+		height = std::max(static_cast<int>(height * scale + 0.5), 1);
+	}
+
+	// JPEGs are scaled down in the DCT domain as far as possible without going below minWidth x minHeight
+	std::vector<unsigned char> decode(const ChannelPacker::Image &image, int minWidth, int minHeight, int &width, int &height)
+	{
+		std::vector<unsigned char> pixels {};
+		if (JpegDecoder::decode(image.encoded, image.size, decodedChannels, minWidth, minHeight, image.flipVertically, pixels, width, height))
+			return pixels;
+
+		stbi_set_flip_vertically_on_load_thread(image.flipVertically);
+		int fileChannels {};
+		unsigned char *data { stbi_load_from_memory(image.encoded, static_cast<int>(image.size), &width, &height, &fileChannels, decodedChannels) };
+		if (!data)
+			throw Texture::TextureLoadingException(failureMessage());
+		pixels.assign(data, data + static_cast<std::size_t>(width) * height * decodedChannels);
+		stbi_image_free(data);
+		return pixels;
+	}
+
+	/**
+	 * Copies one channel of a decoded image into a channel of the chain's level 0, resampling it if the sizes
+	 * differ. The images are data, so they are filtered without sRGB decoding.
+	 */
+	void copyChannel(const std::vector<unsigned char> &pixels, int width, int height, int channel, MipChain &chain, int destination, ThreadPool &pool)
+	{
+		const MipChain::Level &level { chain.getLevel(0) };
+		std::vector<unsigned char> plane(static_cast<std::size_t>(width) * height);
+		for (std::size_t i = 0; i < plane.size(); i++)
+			plane[i] = pixels[i * decodedChannels + channel];
+
+		if (width != level.width || height != level.height)
+		{
+			std::vector<unsigned char> resized(static_cast<std::size_t>(level.width) * level.height);
+			MipChain::Options options {};
+			options.srgb = false;
+			MipChain::resample(plane.data(), width, height, 1, resized.data(), level.width, level.height, options, pool);
+			plane = std::move(resized);
+		}
+
+		const int channels { chain.getChannels() };
+		unsigned char *data { chain.getData() };
+		for (std::size_t i = 0; i < plane.size(); i++)
+			data[i * channels + destination] = plane[i];
+	}
+
+	MipChain merge(const ChannelPacker::Source &source, const std::vector<ChannelPacker::Image> &images, int maxDimension, ThreadPool &pool)
+	{
+		// Occlusion is the channel that matters least, it is resampled to the metallicRoughness size if they differ
+		int width {}, height {};
+		sizeOf(images.at(source.metallicRoughness >= 0 ? source.metallicRoughness : source.occlusion), maxDimension, width, height);
+		const int channels { source.metallicRoughness < 0 ? 1 : source.occlusion < 0 ? 2 : 3 };
+		MipChain chain { width, height, channels };
+
+		int decodedWidth {}, decodedHeight {};
+		if (source.occlusion >= 0)
+		{
+			const std::vector<unsigned char> occlusion { decode(images.at(source.occlusion), width, height, decodedWidth, decodedHeight) };
+			copyChannel(occlusion, decodedWidth, decodedHeight, 0, chain, 0, pool);
+		}
+		if (source.metallicRoughness >= 0)
+		{
+			const std::vector<unsigned char> metallicRoughness { decode(images.at(source.metallicRoughness), width, height, decodedWidth, decodedHeight) };
+			const int first { source.occlusion >= 0 ? 1 : 0 };
+			copyChannel(metallicRoughness, decodedWidth, decodedHeight, 1, chain, first, pool);
+			copyChannel(metallicRoughness, decodedWidth, decodedHeight, 2, chain, first + 1, pool);
+		}
+		return chain;
+	}
+}
+
+/**
+ * @brief Decides which textures to pack and points the materials' references at them
+ * 
+ * Occlusion and metallicRoughness of a material are merged if both are present and use the same texture
+ * coordinates and sampler, otherwise each gets a texture of its own. Materials referencing the same images share
+ * the packed textures. References of materials whose occlusion and metallicRoughness already share one image are
+ * left alone, as are other references.
+ * 
+ * @param materials The materials of a model, their occlusion and metallicRoughness packed indices are set
+ * 
+ * @returns The images each packed texture is made of, indexed by TextureRef::packed
+ */
+std::vector<ChannelPacker::Source> ChannelPacker::plan(std::vector<Material> &materials)
+{
+	std::vector<Source> sources {};
+	for (Material &material : materials)
+	{
+		Material::TextureRef &occlusion { material.occlusion };
+		Material::TextureRef &metallicRoughness { material.metallicRoughness };
+		occlusion.packed = -1;
+		metallicRoughness.packed = -1;
+
+		// Both pointing at one image means it already is an ORM texture, packing would only upload it again
+		if (occlusion.image >= 0 && occlusion.image == metallicRoughness.image)
+			continue;
+
+		const bool mergeable { occlusion.image >= 0 && metallicRoughness.image >= 0 && occlusion.texCoord == metallicRoughness.texCoord && occlusion.sampler == metallicRoughness.sampler };
+		if (mergeable)
+		{
+			occlusion.packed = metallicRoughness.packed = indexOf(sources, occlusion.image, metallicRoughness.image);
+			continue;
+		}
+		if (occlusion.image >= 0)
+			occlusion.packed = indexOf(sources, occlusion.image, -1);
+		if (metallicRoughness.image >= 0)
+			metallicRoughness.packed = indexOf(sources, -1, metallicRoughness.image);
+	}
+	return sources;
+}
+
+/**
+ * @brief Packs the occlusion and metallicRoughness images of materials into ORM, R8 and RG8 textures
+ * 
+ * Images are decoded and merged on the pool, the textures are uploaded on the calling thread, which needs a
+ * current context. Images larger than options.maxDimension are packed at that size, JPEGs are decoded at a
+ * reduced size where possible, so a ResolutionBudget applies with its Orm role. The formats are picked from the
+ * number of packed channels and the textures are never filtered as sRGB, the images' own flags decide their
+ * orientation.
+ * 
+ * @param materials The materials of a model, see plan()
+ * @param images The encoded images the materials' indices refer to, they must outlive the call
+ * @param options Size limit, mipmaps and compression of the packed textures. Defaults to full size with OpenGL
+ * generated mipmaps
+ * @param target The texture unit the textures are created on. Defaults to GL_TEXTURE0
+ * @param pool The pool to decode and merge on. Defaults to the shared pool
+ * 
+ * @returns The packed textures, indexed by TextureRef::packed
+ * 
+ * @throws Texture::TextureLoadingException if an image could not be decoded
+ */
+std::vector<Texture> ChannelPacker::pack(std::vector<Material> &materials, const std::vector<Image> &images, const TextureLoadOptions &options, GLenum target, ThreadPool &pool)
+{
+	const std::vector<Source> sources { plan(materials) };
+
+	std::vector<std::future<MipChain>> chains {};
+	for (const Source &source : sources)
+		chains.push_back(pool.submit([&source, &images, &options, &pool]() { return merge(source, images, options.maxDimension, pool); }));
+
+	// Every task refers to sources and images, so all of them have to finish before an error is passed on
+	std::vector<MipChain> merged {};
+	std::exception_ptr error {};
+	for (std::future<MipChain> &future : chains)
+	{
+		try
+		{
+			merged.push_back(future.get());
+		}
+		catch (...)
+		{
+			if (!error)
+				error = std::current_exception();
+		}
+	}
+	if (error)
+		std::rethrow_exception(error);
+
+	std::vector<Texture> textures {};
+	for (MipChain &chain : merged)
+	{
+		TextureLoadOptions packed { options };
+		packed.type = GL_UNSIGNED_BYTE;
+		packed.mipOptions.srgb = false;
+		switch (chain.getChannels())
+		{
+			case 1:
+				packed.internalFormat = GL_R8;
+				packed.format = GL_RED;
+				break;
+			case 2:
+				packed.internalFormat = GL_RG8;
+				packed.format = GL_RG;
+				break;
+			default:
+				packed.internalFormat = GL_RGB8;
+				packed.format = GL_RGB;
+				break;
+		}
+		textures.emplace_back(chain, target, packed);
+		if (chain.getChannels() == 2)
+			textures.back().setSwizzle(GL_ONE, GL_RED, GL_GREEN, GL_ONE);
+	}
+
+	spdlog::debug("Packed occlusion and metallicRoughness of {} materials into {} textures", materials.size(), textures.size());
+	return textures;
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#include "GLExtensions.hpp"
+#include <unordered_set>
+#include <spdlog/spdlog.h>
+
+/**
+ * @brief Checks whether the current OpenGL context advertises an extension
+ * 
+ * The extension list is queried with glGetStringi once and cached, so it requires a current context with glad loaded.
+ * 
+ * @param name Full extension name, e.g. "GL_ARB_buffer_storage"
+ * 
+ * @returns true if the extension is supported, otherwise false
+ */
+bool hasGLExtension(const std::string &name)
+{
+	static const std::unordered_set<std::string> extensions {
+		[]()
+		{
+			std::unordered_set<std::string> result {};
+			GLint count {};
+			glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+			for (GLint i = 0; i < count; i++)
+				result.emplace(reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, i)));
+			spdlog::debug("Queried {} OpenGL extensions", count);
+			return result;
+		}()
+	};
+
+	return extensions.count(name) != 0;
+}
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include "Hash.hpp"
+#include <cstring>
+
+namespace
+{
+	constexpr std::uint64_t prime1 { 0x9E3779B185EBCA87ULL };
+	constexpr std::uint64_t prime2 { 0xC2B2AE3D27D4EB4FULL };
+	constexpr std::uint64_t prime3 { 0x165667B19E3779F9ULL };
+	constexpr std::uint64_t prime4 { 0x85EBCA77C2B2AE63ULL };
+	constexpr std::uint64_t prime5 { 0x27D4EB2F165667C5ULL };
+
+	std::uint64_t rotl(std::uint64_t x, int r)
+	{
+		return (x << r) | (x >> (64 - r));
+	}
+
+	std::uint64_t read64(const unsigned char *p)
+	{
+		std::uint64_t v {};
+		std::memcpy(&v, p, sizeof(v));
+		return v;
+	}
+
+	std::uint32_t read32(const unsigned char *p)
+	{
+		std::uint32_t v {};
+		std::memcpy(&v, p, sizeof(v));
+		return v;
+	}
+
+	std::uint64_t round(std::uint64_t acc, std::uint64_t input)
+	{
+		acc += input * prime2;
+		acc = rotl(acc, 31);
+		return acc * prime1;
+	}
+
+	std::uint64_t mergeRound(std::uint64_t acc, std::uint64_t val)
+	{
+		acc ^= round(0, val);
+		return acc * prime1 + prime4;
+	}
+}
+
+/**
+ * @brief Hashes a block of memory with XXH64
+ * 
+ * Fast enough to fingerprint whole encoded images, and stable across runs so the result can be used as an
+ * on-disk cache key. Assumes a little-endian host.
+ * 
+ * @param data Pointer to the bytes to hash
+ * @param size Number of bytes
+ * @param seed Optional seed. Defaults to 0
+ * 
+ * @returns 64-bit hash of the bytes
+ */
+std::uint64_t hashBytes(const void *data, std::size_t size, std::uint64_t seed)
+{
+	const unsigned char *p { static_cast<const unsigned char *>(data) };
+	const unsigned char *end { p + size };
+	std::uint64_t h {};
+
+	if (size >= 32)
+	{
+		std::uint64_t v1 { seed + prime1 + prime2 };
+		std::uint64_t v2 { seed + prime2 };
+		std::uint64_t v3 { seed };
+		std::uint64_t v4 { seed - prime1 };
+		const unsigned char *limit { end - 32 };
+		do
+		{
+			v1 = round(v1, read64(p));
+			v2 = round(v2, read64(p + 8));
+			v3 = round(v3, read64(p + 16));
+			v4 = round(v4, read64(p + 24));
+			p += 32;
+		} while (p <= limit);
+
+		h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+		h = mergeRound(h, v1);
+		h = mergeRound(h, v2);
+		h = mergeRound(h, v3);
+		h = mergeRound(h, v4);
+	}
+	else
+	{
+		h = seed + prime5;
+	}
+
+	h += static_cast<std::uint64_t>(size);
+
+	while (p + 8 <= end)
+	{
+		h ^= round(0, read64(p));
+		h = rotl(h, 27) * prime1 + prime4;
+		p += 8;
+	}
+	if (p + 4 <= end)
+	{
+		h ^= static_cast<std::uint64_t>(read32(p)) * prime1;
+		h = rotl(h, 23) * prime2 + prime3;
+		p += 4;
+	}
+	while (p < end)
+	{
+		h ^= (*p) * prime5;
+		h = rotl(h, 11) * prime1;
+		p++;
+	}
+
+	h ^= h >> 33;
+	h *= prime2;
+	h ^= h >> 29;
+	h *= prime3;
+	h ^= h >> 32;
+	return h;
+}
+
+/**
+ * @brief Mixes a value into an existing hash
+ * 
+ * @param seed The hash so far
+ * @param value The value to mix in
+ * 
+ * @returns The combined hash
+ */
+std::uint64_t hashCombine(std::uint64_t seed, std::uint64_t value)
+{
+	return hashBytes(&value, sizeof(value), seed);
+}
\ No newline at end of file
@@ -0,0 +1,346 @@
+#include "HdrPacker.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	constexpr int rgb9e5MantissaBits { 9 };
+	constexpr int rgb9e5Bias { 15 };
+	constexpr float rgb9e5Max { 65408.0f };
+	constexpr float r11Max { 65024.0f };
+	constexpr float b10Max { 64512.0f };
+	// The smallest normal value of the packed floats, 2^-14, below it they are denormal
+	constexpr float packedFloatMinNormal { 6.103515625e-05f };
+	constexpr std::size_t pixelsPerTask { 16384 };
+
+	std::uint32_t bitsOf(float value)
+	{
+		std::uint32_t bits {};
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	float clampTo(float value, float max)
+	{
+		// Written so that NaN fails the comparison and ends up as zero
+		return value > 0.0f ? std::min(value, max) : 0.0f;
+	}
+
+	std::uint32_t packRgb9E5Pixel(const float *rgb)
+	{
+		const float r { clampTo(rgb[0], rgb9e5Max) };
+		const float g { clampTo(rgb[1], rgb9e5Max) };
+		const float b { clampTo(rgb[2], rgb9e5Max) };
+		const float maxRgb { std::max(std::max(r, g), b) };
+
+		// floor(log2(maxRgb)) straight from the float exponent, zero and denormals end at the lower bound
+		const int floorLog2 { static_cast<int>((bitsOf(maxRgb) >> 23) & 0xFF) - 127 };
+		int exponent { std::max(-rgb9e5Bias - 1, floorLog2) + 1 + rgb9e5Bias };
+		float scale { std::ldexp(1.0f, rgb9e5Bias + rgb9e5MantissaBits - exponent) };
+		if (static_cast<int>(maxRgb * scale + 0.5f) == 1 << rgb9e5MantissaBits)
+		{
+			exponent++;
+			scale *= 0.5f;
+		}
+
+		const std::uint32_t rs { static_cast<std::uint32_t>(r * scale + 0.5f) };
+		const std::uint32_t gs { static_cast<std::uint32_t>(g * scale + 0.5f) };
+		const std::uint32_t bs { static_cast<std::uint32_t>(b * scale + 0.5f) };
+		return rs | (gs << 9) | (bs << 18) | (static_cast<std::uint32_t>(exponent) << 27);
+	}
+
+	/**
+	 * Converts a clamped value to an unsigned float with a 5-bit exponent and the given mantissa bits. Normal
+	 * values are rounded on the float's bit pattern, a carry out of the mantissa correctly bumps the exponent.
+	 */
+	std::uint32_t toPackedFloat(float value, int mantissaBits)
+	{
+		if (value < packedFloatMinNormal)
+			return static_cast<std::uint32_t>(value * std::ldexp(1.0f, 14 + mantissaBits) + 0.5f);
+		const std::uint32_t rounded { bitsOf(value) + (1u << (22 - mantissaBits)) };
+		return (rounded >> (23 - mantissaBits)) - ((127u - 15u) << mantissaBits);
+	}
+
+	std::uint32_t packR11G11B10FPixel(const float *rgb)
+	{
+		return toPackedFloat(clampTo(rgb[0], r11Max), 6) | (toPackedFloat(clampTo(rgb[1], r11Max), 6) << 11) | (toPackedFloat(clampTo(rgb[2], b10Max), 5) << 22);
+	}
+
+	float fromPackedFloat(std::uint32_t bits, int mantissaBits)
+	{
+		const int exponent { static_cast<int>(bits >> mantissaBits) };
+		const float mantissa { static_cast<float>(bits & ((1u << mantissaBits) - 1)) };
+		if (exponent == 0)
+			return std::ldexp(mantissa, -14 - mantissaBits);
+		return std::ldexp(1.0f + mantissa / (1 << mantissaBits), exponent - 15);
+	}
+
+#ifdef __SSE2__
+	void load4(const float *rgb, __m128 &r, __m128 &g, __m128 &b)
+	{
+		r = _mm_setr_ps(rgb[0], rgb[3], rgb[6], rgb[9]);
+		g = _mm_setr_ps(rgb[1], rgb[4], rgb[7], rgb[10]);
+		b = _mm_setr_ps(rgb[2], rgb[5], rgb[8], rgb[11]);
+	}
+
+	// _mm_max_ps returns its second operand if either is NaN, so NaN becomes zero like in clampTo()
+	__m128 clamp4(__m128 value, float max)
+	{
+		return _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(max));
+	}
+
+	__m128i select4(__m128i mask, __m128i ifTrue, __m128i ifFalse)
+	{
+		return _mm_or_si128(_mm_and_si128(mask, ifTrue), _mm_andnot_si128(mask, ifFalse));
+	}
+
+	void packRgb9E5x4(const float *rgb, std::uint32_t *output)
+	{
+		__m128 r {}, g {}, b {};
+		load4(rgb, r, g, b);
+		r = clamp4(r, rgb9e5Max);
+		g = clamp4(g, rgb9e5Max);
+		b = clamp4(b, rgb9e5Max);
+		const __m128 maxRgb { _mm_max_ps(_mm_max_ps(r, g), b) };
+
+		const __m128i floorLog2 { _mm_sub_epi32(_mm_srli_epi32(_mm_castps_si128(maxRgb), 23), _mm_set1_epi32(127)) };
+		const __m128i lowest { _mm_set1_epi32(-rgb9e5Bias - 1) };
+		__m128i exponent { _mm_add_epi32(select4(_mm_cmpgt_epi32(floorLog2, lowest), floorLog2, lowest), _mm_set1_epi32(1 + rgb9e5Bias)) };
+		// 2^(bias + mantissa bits - exponent) built from its bit pattern, the exponent stays well inside float range
+		__m128 scale { _mm_castsi128_ps(_mm_slli_epi32(_mm_sub_epi32(_mm_set1_epi32(127 + rgb9e5Bias + rgb9e5MantissaBits), exponent), 23)) };
+
+		const __m128 half { _mm_set1_ps(0.5f) };
+		const __m128i overflow { _mm_cmpeq_epi32(_mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(maxRgb, scale), half)), _mm_set1_epi32(1 << rgb9e5MantissaBits)) };
+		exponent = _mm_sub_epi32(exponent, overflow);
+		scale = _mm_castsi128_ps(_mm_add_epi32(_mm_castps_si128(scale), _mm_and_si128(overflow, _mm_set1_epi32(-(1 << 23)))));
+
+		const __m128i rs { _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(r, scale), half)) };
+		const __m128i gs { _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(g, scale), half)) };
+		const __m128i bs { _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(b, scale), half)) };
+		__m128i packed { _mm_or_si128(rs, _mm_slli_epi32(gs, 9)) };
+		packed = _mm_or_si128(packed, _mm_slli_epi32(bs, 18));
+		packed = _mm_or_si128(packed, _mm_slli_epi32(exponent, 27));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(output), packed);
+	}
+
+	__m128i toPackedFloat4(__m128 value, int mantissaBits)
+	{
+		const __m128i denormal { _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, _mm_set1_ps(std::ldexp(1.0f, 14 + mantissaBits))), _mm_set1_ps(0.5f))) };
+		const __m128i rounded { _mm_add_epi32(_mm_castps_si128(value), _mm_set1_epi32(1 << (22 - mantissaBits))) };
+		const __m128i normal { _mm_sub_epi32(_mm_srli_epi32(rounded, 23 - mantissaBits), _mm_set1_epi32((127 - 15) << mantissaBits)) };
+		return select4(_mm_castps_si128(_mm_cmplt_ps(value, _mm_set1_ps(packedFloatMinNormal))), denormal, normal);
+	}
+
+	void packR11G11B10Fx4(const float *rgb, std::uint32_t *output)
+	{
+		__m128 r {}, g {}, b {};
+		load4(rgb, r, g, b);
+		__m128i packed { toPackedFloat4(clamp4(r, r11Max), 6) };
+		packed = _mm_or_si128(packed, _mm_slli_epi32(toPackedFloat4(clamp4(g, r11Max), 6), 11));
+		packed = _mm_or_si128(packed, _mm_slli_epi32(toPackedFloat4(clamp4(b, b10Max), 5), 22));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(output), packed);
+	}
+#else
+	void packRgb9E5x4(const float *rgb, std::uint32_t *output)
+	{
+		for (int i = 0; i < 4; i++)
+			output[i] = packRgb9E5Pixel(rgb + i * 3);
+	}
+
+	void packR11G11B10Fx4(const float *rgb, std::uint32_t *output)
+	{
+		for (int i = 0; i < 4; i++)
+			output[i] = packR11G11B10FPixel(rgb + i * 3);
+	}
+#endif
+
+	template <typename Pack4, typename Pack1>
+	void packAll(const float *rgb, std::size_t count, std::uint32_t *output, ThreadPool &pool, Pack4 pack4, Pack1 pack1)
+	{
+		const std::size_t tasks { (count + pixelsPerTask - 1) / pixelsPerTask };
+		pool.parallelFor(0, tasks, [&](std::size_t begin, std::size_t end)
+		{
+			std::size_t i { begin * pixelsPerTask };
+			const std::size_t last { std::min(end * pixelsPerTask, count) };
+			for (; i + 4 <= last; i += 4)
+				pack4(rgb + i * 3, output + i);
+			for (; i < last; i++)
+				output[i] = pack1(rgb + i * 3);
+		});
+	}
+}
+
+/**
+ * @brief Packs linear RGB into GL_RGB9_E5 texels (GL_UNSIGNED_INT_5_9_9_9_REV)
+ * 
+ * Follows the conversion in EXT_texture_shared_exponent, the shared exponent is picked for the largest channel
+ * so the smaller ones lose precision relative to it.
+ * 
+ * @param rgb count tightly packed RGB pixels
+ * @param count Number of pixels
+ * @param output Storage for count texels
+ * @param pool The pool to pack on. Defaults to the shared pool
+ */
+void HdrPacker::packRgb9E5(const float *rgb, std::size_t count, std::uint32_t *output, ThreadPool &pool)
+{
+	packAll(rgb, count, output, pool, packRgb9E5x4, packRgb9E5Pixel);
+}
+
+/**
+ * @brief Packs linear RGB into GL_R11F_G11F_B10F texels (GL_UNSIGNED_INT_10F_11F_11F_REV)
+ * 
+ * Every channel keeps its own exponent, which suits colors whose channels differ a lot, at the cost of a shorter
+ * mantissa than RGB9_E5.
+ * 
+ * @param rgb count tightly packed RGB pixels
+ * @param count Number of pixels
+ * @param output Storage for count texels
+ * @param pool The pool to pack on. Defaults to the shared pool
+ */
+void HdrPacker::packR11G11B10F(const float *rgb, std::size_t count, std::uint32_t *output, ThreadPool &pool)
+{
+	packAll(rgb, count, output, pool, packR11G11B10Fx4, packR11G11B10FPixel);
+}
+
+/**
+ * @brief Unpacks one GL_RGB9_E5 texel
+ * 
+ * @param packed The texel
+ * @param rgb Receives the three channels
+ */
+void HdrPacker::unpackRgb9E5(std::uint32_t packed, float *rgb)
+{
+	const int exponent { static_cast<int>(packed >> 27) - rgb9e5Bias - rgb9e5MantissaBits };
+	for (int c = 0; c < 3; c++)
+		rgb[c] = std::ldexp(static_cast<float>((packed >> (c * 9)) & 0x1FF), exponent);
+}
+
+/**
+ * @brief Unpacks one GL_R11F_G11F_B10F texel
+ * 
+ * @param packed The texel
+ * @param rgb Receives the three channels
+ */
+void HdrPacker::unpackR11G11B10F(std::uint32_t packed, float *rgb)
+{
+	rgb[0] = fromPackedFloat(packed & 0x7FF, 6);
+	rgb[1] = fromPackedFloat((packed >> 11) & 0x7FF, 6);
+	rgb[2] = fromPackedFloat(packed >> 22, 5);
+}
+
+namespace
+{
+	struct Span
+	{
+		int first {};
+		std::vector<float> weights {};
+	};
+
+	// Source pixels covered by each destination pixel along one axis and how much of each, normalised to sum to 1
+	std::vector<Span> areaSpans(int size, int dstSize)
+	{
+		const double scale { static_cast<double>(size) / dstSize };
+		std::vector<Span> spans(dstSize);
+		for (int i = 0; i < dstSize; i++)
+		{
+			const double lo { i * scale };
+			const double hi { (i + 1) * scale };
+			spans[i].first = std::min(static_cast<int>(lo), size - 1);
+			const int last { std::min(static_cast<int>(std::ceil(hi)), size) };
+			for (int s = spans[i].first; s < last; s++)
+				spans[i].weights.push_back(static_cast<float>((std::min(hi, s + 1.0) - std::max(lo, static_cast<double>(s))) / (hi - lo)));
+		}
+		return spans;
+	}
+}
+
+/**
+ * @brief Halves a float RGB image with a 2x2 box, for the next level of a mip chain
+ * 
+ * Odd edges reuse the border pixel.
+ * 
+ * @param rgb Tightly packed RGB pixels
+ * @param width Width of the image
+ * @param height Height of the image
+ * @param pool The pool to filter on. Defaults to the shared pool
+ * 
+ * @returns The max(width / 2, 1) x max(height / 2, 1) image
+ */
+std::vector<float> HdrPacker::halve(const std::vector<float> &rgb, int width, int height, ThreadPool &pool)
+{
+	const int dstWidth { std::max(width / 2, 1) };
+	const int dstHeight { std::max(height / 2, 1) };
+	std::vector<float> dst(static_cast<std::size_t>(dstWidth) * dstHeight * 3);
+	pool.parallelFor(0, dstHeight, [&](std::size_t begin, std::size_t end)
+	{
+		for (std::size_t y = begin; y < end; y++)
+		{
+			const int y0 { std::min(static_cast<int>(y) * 2, height - 1) };
+			const int y1 { std::min(static_cast<int>(y) * 2 + 1, height - 1) };
+			for (int x = 0; x < dstWidth; x++)
+			{
+				const int x0 { std::min(x * 2, width - 1) };
+				const int x1 { std::min(x * 2 + 1, width - 1) };
+				for (int c = 0; c < 3; c++)
+				{
+					const float sum { rgb[(static_cast<std::size_t>(y0) * width + x0) * 3 + c] + rgb[(static_cast<std::size_t>(y0) * width + x1) * 3 + c]
+						+ rgb[(static_cast<std::size_t>(y1) * width + x0) * 3 + c] + rgb[(static_cast<std::size_t>(y1) * width + x1) * 3 + c] };
+					dst[(y * dstWidth + x) * 3 + c] = sum * 0.25f;
+				}
+			}
+		}
+	}, 16);
+	return dst;
+}
+
+/**
+ * @brief Resizes a float RGB image to an arbitrary size by averaging the area each output pixel covers
+ * 
+ * Meant for downscaling to a resolution budget. An area filter has no negative lobes, so unlike MipChain's Kaiser
+ * filter it can't ring around very bright pixels. Rows are filtered first, then columns, both in parallel.
+ * 
+ * @param rgb Tightly packed RGB pixels
+ * @param width Width of the image
+ * @param height Height of the image
+ * @param dstWidth Width of the resized image
+ * @param dstHeight Height of the resized image
+ * @param pool The pool to filter on. Defaults to the shared pool
+ * 
+ * @returns The dstWidth x dstHeight image
+ */
+std::vector<float> HdrPacker::resample(const std::vector<float> &rgb, int width, int height, int dstWidth, int dstHeight, ThreadPool &pool)
+{
+	const std::vector<Span> columns { areaSpans(width, dstWidth) };
+	const std::vector<Span> rows { areaSpans(height, dstHeight) };
+
+	std::vector<float> horizontal(static_cast<std::size_t>(dstWidth) * height * 3);
+	pool.parallelFor(0, height, [&](std::size_t begin, std::size_t end)
+	{
+		for (std::size_t y = begin; y < end; y++)
+			for (int x = 0; x < dstWidth; x++)
+			{
+				float sum[3] {};
+				for (std::size_t i = 0; i < columns[x].weights.size(); i++)
+					for (int c = 0; c < 3; c++)
+						sum[c] += columns[x].weights[i] * rgb[(y * width + columns[x].first + i) * 3 + c];
+				std::memcpy(&horizontal[(y * dstWidth + x) * 3], sum, sizeof(sum));
+			}
+	}, 16);
+
+	std::vector<float> dst(static_cast<std::size_t>(dstWidth) * dstHeight * 3);
+	pool.parallelFor(0, dstHeight, [&](std::size_t begin, std::size_t end)
+	{
+		for (std::size_t y = begin; y < end; y++)
+			for (std::size_t i = 0; i < rows[y].weights.size(); i++)
+			{
+				const float *src { &horizontal[(rows[y].first + i) * dstWidth * 3] };
+				for (std::size_t j = 0; j < static_cast<std::size_t>(dstWidth) * 3; j++)
+					dst[y * dstWidth * 3 + j] += rows[y].weights[i] * src[j];
+			}
+	}, 16);
+	return dst;
+}
\ No newline at end of file
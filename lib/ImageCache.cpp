@@ -0,0 +1,311 @@
+#include "ImageCache.hpp"
+#include "Hash.hpp"
+#include "BlockCompression.hpp"
+#include "JpegDecoder.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <spdlog/spdlog.h>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+	// Bump when the layout or anything feeding the payloads (decoder, filters, encoders) changes
+	constexpr std::uint64_t cacheVersion { 2 };
+	constexpr unsigned char identifier[8] { 0xAB, 'I', 'M', 'C', 0xBB, 0x0D, 0x0A, 0x1A };
+	constexpr std::size_t headerSize { 64 };
+	constexpr std::size_t levelEntrySize { 16 };
+	constexpr std::size_t levelAlignment { 16 };
+	constexpr std::uint32_t flagCompressed { 1 };
+
+	// Entries are only read back on the machine that wrote them, so fields are stored in native byte order
+	template <typename T>
+	T read(const unsigned char *p)
+	{
+		T value {};
+		std::memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	template <typename T>
+	void write(std::vector<unsigned char> &out, std::size_t offset, T value)
+	{
+		std::memcpy(out.data() + offset, &value, sizeof(value));
+	}
+
+	std::size_t alignUp(std::size_t value)
+	{
+		return (value + levelAlignment - 1) / levelAlignment * levelAlignment;
+	}
+
+	int componentsOf(GLenum format)
+	{
+		switch (format)
+		{
+			case GL_RED:
+			case GL_RED_INTEGER:
+				return 1;
+			case GL_RG:
+			case GL_RG_INTEGER:
+				return 2;
+			case GL_RGB:
+			case GL_BGR:
+			case GL_RGB_INTEGER:
+				return 3;
+			case GL_RGBA:
+			case GL_BGRA:
+			case GL_RGBA_INTEGER:
+				return 4;
+			default:
+				return 0;
+		}
+	}
+
+	// Bytes per texel of an uncompressed format and type, 0 for combinations the cache never writes
+	std::size_t texelSizeOf(GLenum format, GLenum type)
+	{
+		switch (type)
+		{
+			case GL_UNSIGNED_INT_5_9_9_9_REV:
+			case GL_UNSIGNED_INT_10F_11F_11F_REV:
+				return format == GL_RGB ? 4 : 0;
+			case GL_UNSIGNED_BYTE:
+			case GL_BYTE:
+				return componentsOf(format);
+			case GL_UNSIGNED_SHORT:
+			case GL_SHORT:
+			case GL_HALF_FLOAT:
+				return componentsOf(format) * 2;
+			case GL_UNSIGNED_INT:
+			case GL_INT:
+			case GL_FLOAT:
+				return componentsOf(format) * 4;
+			default:
+				return 0;
+		}
+	}
+
+	// Bytes per 4x4 block of a compressed internal format, 0 for formats BlockCompression doesn't produce
+	std::size_t blockSizeOf(GLint internalFormat)
+	{
+		const BlockCompression::Format formats[] { BlockCompression::Format::BC1, BlockCompression::Format::BC3, BlockCompression::Format::BC4,
+			BlockCompression::Format::BC5, BlockCompression::Format::BC6H, BlockCompression::Format::BC7 };
+		for (BlockCompression::Format format : formats)
+		{
+			if (static_cast<GLint>(BlockCompression::getInternalFormat(format, false)) == internalFormat || static_cast<GLint>(BlockCompression::getInternalFormat(format, true)) == internalFormat)
+				return BlockCompression::getBlockSize(format);
+		}
+		return 0;
+	}
+
+	/**
+	 * Size OpenGL reads for a level, tightly packed as Texture uploads cached levels with an unpack alignment of 1.
+	 * 0 if the format is unknown, which makes the entry foreign.
+	 */
+	std::size_t levelSizeOf(const ImageCache::Format &format, int width, int height)
+	{
+		if (format.compressed)
+			return blockSizeOf(format.internalFormat) * ((width + 3) / 4) * ((height + 3) / 4);
+		return texelSizeOf(format.format, format.type) * width * height;
+	}
+}
+
+ImageCache::Entry::Entry(MappedFile &&mapped) : file { std::move(mapped) }
+{
+}
+
+/**
+ * @brief Constructor for ImageCache storing entries in a directory
+ * 
+ * The directory is created if it doesn't exist, its parent has to exist.
+ * 
+ * @param directory The directory holding the entries
+ */
+ImageCache::ImageCache(const std::string &directory) : _directory { directory }
+{
+	if (!_directory.empty() && _directory.back() != '/' && _directory.back() != '\\')
+		_directory += '/';
+#ifdef _WIN32
+	_mkdir(directory.c_str());
+#else
+	mkdir(directory.c_str(), 0755);
+#endif
+	spdlog::debug("Caching decoded images in {}", _directory);
+}
+
+/**
+ * @brief Checks whether the cache has a directory
+ * 
+ * @returns false for the default constructed, disabled cache
+ */
+bool ImageCache::isEnabled()
+{
+	return !_directory.empty();
+}
+
+/**
+ * @brief Looks up a cached payload
+ * 
+ * Unreadable, truncated or foreign entries count as misses and are overwritten by the next store(). That includes
+ * entries with a format the cache doesn't know and levels smaller than their format and size imply. Whether the
+ * context can sample a compressed entry's format is up to the caller.
+ * 
+ * @param key Key from keyOf()
+ * 
+ * @returns The mapped entry with levels pointing into the mapping, or nullptr on a miss
+ */
+std::unique_ptr<ImageCache::Entry> ImageCache::find(std::uint64_t key)
+{
+	if (!isEnabled())
+		return nullptr;
+
+	std::unique_ptr<Entry> entry {};
+	try
+	{
+		entry.reset(new Entry(MappedFile { pathOf(key) }));
+	}
+	catch (const MappedFile::MappingException &)
+	{
+		return nullptr;
+	}
+
+	const unsigned char *data { entry->file.getData() };
+	const std::size_t size { entry->file.getSize() };
+	if (size < headerSize || std::memcmp(data, identifier, sizeof(identifier)) != 0 || read<std::uint64_t>(data + 8) != key)
+		return nullptr;
+
+	entry->format.internalFormat = read<GLint>(data + 16);
+	entry->format.format = read<GLenum>(data + 20);
+	entry->format.type = read<GLenum>(data + 24);
+	entry->format.compressed = (read<std::uint32_t>(data + 28) & flagCompressed) != 0;
+	const int width { read<std::int32_t>(data + 32) };
+	const int height { read<std::int32_t>(data + 36) };
+	entry->channels = read<std::int32_t>(data + 40);
+	const std::uint32_t levelCount { read<std::uint32_t>(data + 44) };
+	if (width <= 0 || height <= 0 || levelCount == 0 || levelCount > 32 || size < headerSize + levelCount * levelEntrySize)
+		return nullptr;
+
+	for (std::uint32_t i = 0; i < levelCount; i++)
+	{
+		const unsigned char *levelEntry { data + headerSize + i * levelEntrySize };
+		const std::uint64_t offset { read<std::uint64_t>(levelEntry) };
+		const std::uint64_t length { read<std::uint64_t>(levelEntry + 8) };
+		const int levelWidth { std::max(width >> i, 1) };
+		const int levelHeight { std::max(height >> i, 1) };
+		// OpenGL reads as much as the format and size imply whatever the entry claims, and rejects compressed
+		// levels whose size doesn't match exactly
+		const std::size_t expected { levelSizeOf(entry->format, levelWidth, levelHeight) };
+		const bool mismatched { entry->format.compressed ? length != expected : length < expected };
+		if (offset > size || length > size - offset || expected == 0 || mismatched)
+			return nullptr;
+		entry->levels.push_back({ data + offset, static_cast<std::size_t>(length), levelWidth, levelHeight });
+	}
+	return entry;
+}
+
+/**
+ * @brief Writes a payload into the cache
+ * 
+ * The entry is written to a temporary file and renamed into place, so concurrent readers never see a partial
+ * entry. Failing to write is not an error, the image is just decoded again next time.
+ * 
+ * @param key Key from keyOf()
+ * @param format The OpenGL formats the levels are uploaded with
+ * @param channels Number of channels of the decoded image
+ * @param levels The levels, level 0 first, each half the size of the previous one
+ */
+void ImageCache::store(std::uint64_t key, const Format &format, int channels, const std::vector<Level> &levels)
+{
+	if (!isEnabled() || levels.empty())
+		return;
+
+	const std::size_t tableEnd { headerSize + levels.size() * levelEntrySize };
+	std::vector<unsigned char> header(alignUp(tableEnd), 0);
+	std::memcpy(header.data(), identifier, sizeof(identifier));
+	write<std::uint64_t>(header, 8, key);
+	write<GLint>(header, 16, format.internalFormat);
+	write<GLenum>(header, 20, format.format);
+	write<GLenum>(header, 24, format.type);
+	write<std::uint32_t>(header, 28, format.compressed ? flagCompressed : 0);
+	write<std::int32_t>(header, 32, levels.front().width);
+	write<std::int32_t>(header, 36, levels.front().height);
+	write<std::int32_t>(header, 40, channels);
+	write<std::uint32_t>(header, 44, static_cast<std::uint32_t>(levels.size()));
+
+	std::size_t offset { header.size() };
+	for (std::size_t i = 0; i < levels.size(); i++)
+	{
+		write<std::uint64_t>(header, headerSize + i * levelEntrySize, offset);
+		write<std::uint64_t>(header, headerSize + i * levelEntrySize + 8, levels[i].size);
+		offset = alignUp(offset + levels[i].size);
+	}
+
+	const std::string path { pathOf(key) };
+	const std::string temporary { path + ".tmp" };
+	{
+		std::ofstream os { temporary, std::ios::binary };
+		os.write(reinterpret_cast<const char *>(header.data()), static_cast<std::streamsize>(header.size()));
+		const char padding[levelAlignment] {};
+		for (const Level &level : levels)
+		{
+			os.write(reinterpret_cast<const char *>(level.data), static_cast<std::streamsize>(level.size));
+			os.write(padding, static_cast<std::streamsize>(alignUp(level.size) - level.size));
+		}
+		if (!os)
+		{
+			spdlog::debug("Failed to write image cache entry {}", temporary);
+			os.close();
+			std::remove(temporary.c_str());
+			return;
+		}
+	}
+	std::remove(path.c_str());
+	if (std::rename(temporary.c_str(), path.c_str()) != 0)
+		std::remove(temporary.c_str());
+	spdlog::debug("Cached decoded image {} ({} levels)", path, levels.size());
+}
+
+/**
+ * @brief Computes the cache key of an image
+ * 
+ * @param encoded Pointer to the encoded image
+ * @param size Size of the encoded image in bytes
+ * @param options Everything influencing the decoded payload
+ * @param compressible Whether the context supports the block formats the options ask for. Contexts falling back
+ * to uncompressed levels store different payloads for the same options
+ * 
+ * @returns The key
+ */
+std::uint64_t ImageCache::keyOf(const unsigned char *encoded, std::size_t size, const TextureLoadOptions &options, bool compressible)
+{
+	std::uint64_t key { hashBytes(encoded, size, cacheVersion) };
+	// libjpeg and stb_image decode JPEGs slightly differently, builds with and without libjpeg must not share entries
+	key = hashCombine(key, JpegDecoder::isAvailable());
+	key = hashCombine(key, compressible);
+	return hashOptions(options, key);
+}
+
+/**
+ * @brief Gets the cache consulted by Texture, disabled until a cache with a directory is assigned to it
+ * 
+ * @returns The shared ImageCache
+ */
+ImageCache &ImageCache::shared()
+{
+	static ImageCache cache {};
+	return cache;
+}
+
+std::string ImageCache::pathOf(std::uint64_t key)
+{
+	std::stringstream path {};
+	path << _directory << std::hex << std::setw(16) << std::setfill('0') << key << ".img";
+	return path.str();
+}
\ No newline at end of file
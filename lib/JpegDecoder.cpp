@@ -0,0 +1,271 @@
+#ifdef HAVE_JPEG
+#include <algorithm>
+#include <csetjmp>
+#include <cstdio>
+#include <jpeglib.h>
+#endif
+#include <spdlog/spdlog.h>
+#include "JpegDecoder.hpp"
+
+#ifdef HAVE_JPEG
+namespace
+{
+	constexpr int maxBatch { 4 };
+
+	struct ErrorManager
+	{
+		jpeg_error_mgr base;
+		std::jmp_buf jump;
+	};
+
+	// libjpeg expects error_exit not to return, jump back into decode() which then reports the failure
+	void errorExit(j_common_ptr info)
+	{
+		char message[JMSG_LENGTH_MAX] {};
+		info->err->format_message(info, message);
+		spdlog::debug("libjpeg: {}", message);
+		std::longjmp(reinterpret_cast<ErrorManager *>(info->err)->jump, 1);
+	}
+
+	// Warnings about corrupt but decodable data would otherwise go to stderr
+	void emitMessage(j_common_ptr, int)
+	{
+	}
+
+	/**
+	 * Picks the smallest scale of the reduced IDCT (1/8, 1/4, 1/2 or 1/1) whose output is still at least
+	 * minWidth x minHeight. Without any minimum the image is decoded at full size.
+	 */
+	unsigned int scaleFor(JDIMENSION width, JDIMENSION height, int minWidth, int minHeight)
+	{
+		if (minWidth <= 0 && minHeight <= 0)
+			return 8;
+		unsigned int scale { 1 };
+		while (scale < 8 && ((width * scale + 7) / 8 < static_cast<JDIMENSION>(minWidth) || (height * scale + 7) / 8 < static_cast<JDIMENSION>(minHeight)))
+			scale *= 2;
+		return scale;
+	}
+
+	// Expands decoded gray or RGB samples to the requested channel count, added alpha is opaque
+	void expand(const unsigned char *src, int srcChannels, unsigned char *dst, int channels, JDIMENSION width)
+	{
+		for (JDIMENSION x = 0; x < width; x++)
+		{
+			for (int c = 0; c < channels; c++)
+				dst[x * channels + c] = c < srcChannels ? src[x * srcChannels + c] : 255;
+		}
+	}
+	// Where decoded pixels go, either a caller provided buffer or a vector sized to fit
+	struct Output
+	{
+		std::vector<unsigned char> *pixels {};
+		unsigned char *buffer {};
+		std::size_t capacity {};
+	};
+
+	/**
+	 * Everything changed between setjmp() and a longjmp() out of libjpeg. Locals of the function calling setjmp()
+	 * have indeterminate values after the jump, so these live in the frame of the caller.
+	 */
+	struct Decompression
+	{
+		jpeg_decompress_struct info {};
+		ErrorManager errors {};
+		std::vector<unsigned char> rows {};
+	};
+
+	bool decodeJpeg(Decompression &state, const unsigned char *encoded, std::size_t size, int channels, int minWidth, int minHeight, bool flipVertically, Output &output, int &width, int &height)
+	{
+		jpeg_decompress_struct &info { state.info };
+		ErrorManager &errors { state.errors };
+		std::vector<unsigned char> &rows { state.rows };
+		info.err = jpeg_std_error(&errors.base);
+		errors.base.error_exit = errorExit;
+		errors.base.emit_message = emitMessage;
+		if (setjmp(errors.jump))
+		{
+			jpeg_destroy_decompress(&info);
+			return false;
+		}
+
+		jpeg_create_decompress(&info);
+		jpeg_mem_src(&info, const_cast<unsigned char *>(encoded), static_cast<unsigned long>(size));
+		jpeg_read_header(&info, TRUE);
+		if (info.jpeg_color_space == JCS_CMYK || info.jpeg_color_space == JCS_YCCK)
+		{
+			jpeg_destroy_decompress(&info);
+			return false;
+		}
+
+		int decodedChannels { channels < 3 ? 1 : 3 };
+		info.out_color_space = channels < 3 ? JCS_GRAYSCALE : JCS_RGB;
+#ifdef JCS_EXTENSIONS
+		if (channels == 4)
+		{
+			decodedChannels = 4;
+			info.out_color_space = JCS_EXT_RGBA;
+		}
+#endif
+		info.scale_num = scaleFor(info.image_width, info.image_height, minWidth, minHeight);
+		info.scale_denom = 8;
+		jpeg_calc_output_dimensions(&info);
+
+		const std::size_t stride { static_cast<std::size_t>(info.output_width) * channels };
+		const std::size_t imageSize { stride * info.output_height };
+		if (output.pixels)
+		{
+			output.pixels->resize(imageSize);
+			output.buffer = output.pixels->data();
+		}
+		else if (imageSize > output.capacity)
+		{
+			jpeg_destroy_decompress(&info);
+			return false;
+		}
+		jpeg_start_decompress(&info);
+
+		// Reading as many rows as the upsampler produces at once saves libjpeg an extra copy of every row
+		const JDIMENSION batch { static_cast<JDIMENSION>(std::min(std::max(info.rec_outbuf_height, 1), maxBatch)) };
+		const std::size_t decodedStride { static_cast<std::size_t>(info.output_width) * decodedChannels };
+		if (decodedChannels != channels)
+			rows.resize(decodedStride * batch);
+		JSAMPROW scanlines[maxBatch] {};
+		while (info.output_scanline < info.output_height)
+		{
+			const JDIMENSION first { info.output_scanline };
+			const JDIMENSION count { std::min(batch, info.output_height - first) };
+			for (JDIMENSION i = 0; i < count; i++)
+			{
+				const JDIMENSION y { flipVertically ? info.output_height - 1 - first - i : first + i };
+				scanlines[i] = decodedChannels == channels ? output.buffer + y * stride : rows.data() + i * decodedStride;
+			}
+			const JDIMENSION read { jpeg_read_scanlines(&info, scanlines, count) };
+			for (JDIMENSION i = 0; i < read && decodedChannels != channels; i++)
+			{
+				const JDIMENSION y { flipVertically ? info.output_height - 1 - first - i : first + i };
+				expand(scanlines[i], decodedChannels, output.buffer + y * stride, channels, info.output_width);
+			}
+		}
+
+		width = static_cast<int>(info.output_width);
+		height = static_cast<int>(info.output_height);
+		if (info.scale_num < info.scale_denom)
+			spdlog::debug("Decoded JPEG at {}/{} scale ({}x{})", info.scale_num, info.scale_denom, width, height);
+		jpeg_finish_decompress(&info);
+		jpeg_destroy_decompress(&info);
+		return true;
+	}
+
+	bool decodeJpeg(const unsigned char *encoded, std::size_t size, int channels, int minWidth, int minHeight, bool flipVertically, Output &output, int &width, int &height)
+	{
+		if (!JpegDecoder::isJpeg(encoded, size) || channels < 1 || channels > 4)
+			return false;
+
+		Decompression state {};
+		return decodeJpeg(state, encoded, size, channels, minWidth, minHeight, flipVertically, output, width, height);
+	}
+}
+#endif
+
+/**
+ * @brief Checks whether core was built with libjpeg
+ * 
+ * @returns True if decode() can be used
+ */
+bool JpegDecoder::isAvailable()
+{
+#ifdef HAVE_JPEG
+	return true;
+#else
+	return false;
+#endif
+}
+
+/**
+ * @brief Checks for the JPEG start of image marker
+ * 
+ * @param encoded Pointer to the encoded image
+ * @param size Size of the encoded image in bytes
+ * 
+ * @returns True if the data starts like a JPEG file
+ */
+bool JpegDecoder::isJpeg(const unsigned char *encoded, std::size_t size)
+{
+	return size >= 3 && encoded[0] == 0xFF && encoded[1] == 0xD8 && encoded[2] == 0xFF;
+}
+
+/**
+ * @brief Decodes a JPEG at full size into caller provided memory, e.g. a staging buffer
+ * 
+ * libjpeg-turbo runs the IDCT, chroma upsampling and color conversion with SIMD, which is several times faster
+ * than stb_image for baseline and especially progressive JPEGs. The output matches what stb_image produces for
+ * the same channel count: gray for 1, gray and opaque alpha for 2, RGB for 3 and RGB with opaque alpha for 4.
+ * CMYK images are not supported and left to stb_image.
+ * 
+ * @param encoded Pointer to the encoded image
+ * @param size Size of the encoded image in bytes
+ * @param channels Number of 8-bit channels to decode to, 1 to 4
+ * @param flipVertically Whether the first row of the output is the bottom row of the image
+ * @param output Storage for the tightly packed pixels
+ * @param capacity Size of output in bytes, decoding fails if the image does not fit
+ * @param width Receives the decoded width
+ * @param height Receives the decoded height
+ * 
+ * @returns False if libjpeg is unavailable, the image is not a supported JPEG or decoding failed
+ */
+bool JpegDecoder::decode(const unsigned char *encoded, std::size_t size, int channels, bool flipVertically, unsigned char *output, std::size_t capacity, int &width, int &height)
+{
+#ifdef HAVE_JPEG
+	Output target {};
+	target.buffer = output;
+	target.capacity = capacity;
+	return decodeJpeg(encoded, size, channels, 0, 0, flipVertically, target, width, height);
+#else
+	(void)encoded;
+	(void)size;
+	(void)channels;
+	(void)flipVertically;
+	(void)output;
+	(void)capacity;
+	(void)width;
+	(void)height;
+	return false;
+#endif
+}
+
+/**
+ * @brief Decodes a JPEG, scaled down in the DCT domain as far as possible without going below a minimum size
+ * 
+ * Channels and orientation are handled like in the full size decode.
+ * 
+ * @param encoded Pointer to the encoded image
+ * @param size Size of the encoded image in bytes
+ * @param channels Number of 8-bit channels to decode to, 1 to 4
+ * @param minWidth Width the decoded image must at least have, 0 to always decode at full size
+ * @param minHeight Height the decoded image must at least have, 0 to always decode at full size
+ * @param flipVertically Whether the first row of the output is the bottom row of the image
+ * @param pixels Receives the tightly packed pixels
+ * @param width Receives the decoded width
+ * @param height Receives the decoded height
+ * 
+ * @returns False if libjpeg is unavailable, the image is not a supported JPEG or decoding failed
+ */
+bool JpegDecoder::decode(const unsigned char *encoded, std::size_t size, int channels, int minWidth, int minHeight, bool flipVertically, std::vector<unsigned char> &pixels, int &width, int &height)
+{
+#ifdef HAVE_JPEG
+	Output target {};
+	target.pixels = &pixels;
+	return decodeJpeg(encoded, size, channels, minWidth, minHeight, flipVertically, target, width, height);
+#else
+	(void)encoded;
+	(void)size;
+	(void)channels;
+	(void)minWidth;
+	(void)minHeight;
+	(void)flipVertically;
+	(void)pixels;
+	(void)width;
+	(void)height;
+	return false;
+#endif
+}
\ No newline at end of file
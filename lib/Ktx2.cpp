@@ -0,0 +1,472 @@
+#include "Ktx2.hpp"
+#include "BlockCompression.hpp"
+#include "MipChain.hpp"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace
+{
+	constexpr unsigned char identifier[12] { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+	constexpr std::size_t headerSize { 80 };
+	constexpr std::size_t levelIndexEntrySize { 24 };
+	constexpr std::size_t levelAlignment { 16 };
+
+	// Data format descriptor values from the Khronos Data Format Specification
+	constexpr std::uint32_t modelRGBSDA { 1 };
+	constexpr std::uint32_t modelBC6H { 133 };
+	constexpr std::uint32_t modelBC7 { 134 };
+	constexpr std::uint32_t primariesBT709 { 1 };
+	constexpr std::uint32_t transferLinear { 1 };
+	constexpr std::uint32_t transferSrgb { 2 };
+	constexpr std::uint32_t qualifierLinear { 0x10 };
+	constexpr std::uint32_t qualifierFloat { 0x80 };
+
+#ifdef HAVE_ZSTD
+	constexpr bool canDecompress { true };
+#else
+	constexpr bool canDecompress { false };
+#endif
+
+	struct FormatInfo
+	{
+		std::uint32_t vkFormat {};
+		Ktx2::GLFormat gl {};
+		BlockCompression::Format block {};
+		bool srgb {};
+	};
+
+	// Vulkan formats and the OpenGL formats they upload as. The block format is only used to check support
+	const FormatInfo formats[] {
+		{ 9, { GL_R8, GL_RED, GL_UNSIGNED_BYTE, false } },
+		{ 16, { GL_RG8, GL_RG, GL_UNSIGNED_BYTE, false } },
+		{ 23, { GL_RGB8, GL_RGB, GL_UNSIGNED_BYTE, false } },
+		{ 29, { GL_SRGB8, GL_RGB, GL_UNSIGNED_BYTE, false } },
+		{ Ktx2::formatRGBA8, { GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, false } },
+		{ Ktx2::formatRGBA8Srgb, { GL_SRGB8_ALPHA8, GL_RGBA, GL_UNSIGNED_BYTE, false } },
+		{ 97, { GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT, false } },
+		{ 109, { GL_RGBA32F, GL_RGBA, GL_FLOAT, false } },
+		{ 122, { GL_R11F_G11F_B10F, GL_RGB, GL_UNSIGNED_INT_10F_11F_11F_REV, false } },
+		{ 123, { GL_RGB9_E5, GL_RGB, GL_UNSIGNED_INT_5_9_9_9_REV, false } },
+		{ 131, { GL_COMPRESSED_RGB_S3TC_DXT1_EXT, GL_NONE, GL_NONE, true }, BlockCompression::Format::BC1, false },
+		{ 132, { GL_COMPRESSED_SRGB_S3TC_DXT1_EXT, GL_NONE, GL_NONE, true }, BlockCompression::Format::BC1, true },
+		{ 133, { GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, GL_NONE, GL_NONE, true }, BlockCompression::Format::BC1, false },
+		{ 134, { GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT, GL_NONE, GL_NONE, true }, BlockCompression::Format::BC1, true },
+		{ 137, { GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, GL_NONE, GL_NONE, true }, BlockCompression::Format::BC3, false },
+		{ 138, { GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT, GL_NONE, GL_NONE, true }, BlockCompression::Format::BC3, true },
+		{ 139, { GL_COMPRESSED_RED_RGTC1, GL_NONE, GL_NONE, true }, BlockCompression::Format::BC4, false },
+		{ 141, { GL_COMPRESSED_RG_RGTC2, GL_NONE, GL_NONE, true }, BlockCompression::Format::BC5, false },
+		{ Ktx2::formatBC6HUfloat, { GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT, GL_NONE, GL_NONE, true }, BlockCompression::Format::BC6H, false },
+		{ Ktx2::formatBC7, { GL_COMPRESSED_RGBA_BPTC_UNORM, GL_NONE, GL_NONE, true }, BlockCompression::Format::BC7, false },
+		{ Ktx2::formatBC7Srgb, { GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM, GL_NONE, GL_NONE, true }, BlockCompression::Format::BC7, true }
+	};
+
+	const FormatInfo *findFormat(std::uint32_t vkFormat)
+	{
+		for (const FormatInfo &info : formats)
+			if (info.vkFormat == vkFormat)
+				return &info;
+		return nullptr;
+	}
+
+	// Bytes a level of some dimensions takes, 0 for formats the loader doesn't know
+	std::size_t levelSizeOf(std::uint32_t vkFormat, int width, int height)
+	{
+		const FormatInfo *info { findFormat(vkFormat) };
+		if (!info)
+			return 0;
+		if (info->gl.compressed)
+			return BlockCompression::getBlockSize(info->block) * ((width + 3) / 4) * ((height + 3) / 4);
+
+		std::size_t texelSize {};
+		switch (info->gl.format)
+		{
+			case GL_RED:
+				texelSize = 1;
+				break;
+			case GL_RG:
+				texelSize = 2;
+				break;
+			case GL_RGB:
+				texelSize = 3;
+				break;
+			default:
+				texelSize = 4;
+				break;
+		}
+		if (info->gl.type == GL_HALF_FLOAT)
+			texelSize *= 2;
+		else if (info->gl.type == GL_FLOAT)
+			texelSize *= 4;
+		else if (info->gl.type != GL_UNSIGNED_BYTE)
+			texelSize = 4;
+		return texelSize * width * height;
+	}
+
+	struct Sample
+	{
+		std::uint32_t bitOffset {};
+		std::uint32_t bitLength {};
+		std::uint32_t channelType {};
+		std::uint32_t lower {};
+		std::uint32_t upper {};
+	};
+
+	std::uint32_t read32(const unsigned char *p)
+	{
+		return static_cast<std::uint32_t>(p[0]) | (static_cast<std::uint32_t>(p[1]) << 8) | (static_cast<std::uint32_t>(p[2]) << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+	}
+
+	std::uint64_t read64(const unsigned char *p)
+	{
+		return static_cast<std::uint64_t>(read32(p)) | (static_cast<std::uint64_t>(read32(p + 4)) << 32);
+	}
+
+	void write32(std::vector<unsigned char> &out, std::size_t offset, std::uint32_t value)
+	{
+		for (int i = 0; i < 4; i++)
+			out[offset + i] = static_cast<unsigned char>(value >> (i * 8));
+	}
+
+	void write64(std::vector<unsigned char> &out, std::size_t offset, std::uint64_t value)
+	{
+		write32(out, offset, static_cast<std::uint32_t>(value));
+		write32(out, offset + 4, static_cast<std::uint32_t>(value >> 32));
+	}
+
+	/**
+	 * Builds the data format descriptor (a single basic block) describing one of the writable formats.
+	 */
+	std::vector<unsigned char> formatDescriptor(std::uint32_t vkFormat)
+	{
+		std::uint32_t model {};
+		std::uint32_t transfer { transferLinear };
+		std::uint32_t blockDimensions { 0 };
+		std::uint32_t bytesPlane0 {};
+		std::vector<Sample> samples {};
+
+		switch (vkFormat)
+		{
+			case Ktx2::formatRGBA8Srgb:
+				transfer = transferSrgb;
+				// fall through
+			case Ktx2::formatRGBA8:
+				model = modelRGBSDA;
+				bytesPlane0 = 4;
+				for (std::uint32_t c = 0; c < 4; c++)
+				{
+					const std::uint32_t channel { c == 3 ? 15u | (transfer == transferSrgb ? qualifierLinear : 0u) : c };
+					samples.push_back({ c * 8, 7, channel, 0, 255 });
+				}
+				break;
+			case Ktx2::formatBC7Srgb:
+				transfer = transferSrgb;
+				// fall through
+			case Ktx2::formatBC7:
+				model = modelBC7;
+				blockDimensions = 3 | (3 << 8);
+				bytesPlane0 = 16;
+				samples.push_back({ 0, 127, 0, 0, 0xFFFFFFFF });
+				break;
+			case Ktx2::formatBC6HUfloat:
+				model = modelBC6H;
+				blockDimensions = 3 | (3 << 8);
+				bytesPlane0 = 16;
+				samples.push_back({ 0, 127, qualifierFloat, 0xBF800000, 0x7F800000 });
+				break;
+			default:
+			{
+				std::stringstream error {};
+				error << "Cannot write KTX2 with vkFormat " << vkFormat << std::endl;
+				throw Ktx2::UnsupportedFormatException(error.str());
+			}
+		}
+
+		const std::uint32_t blockSize { static_cast<std::uint32_t>(24 + samples.size() * 16) };
+		std::vector<unsigned char> dfd(4 + blockSize, 0);
+		write32(dfd, 0, static_cast<std::uint32_t>(dfd.size()));
+		write32(dfd, 4, 0);
+		write32(dfd, 8, 2 | (blockSize << 16));
+		write32(dfd, 12, model | (primariesBT709 << 8) | (transfer << 16));
+		write32(dfd, 16, blockDimensions);
+		write32(dfd, 20, bytesPlane0);
+		for (std::size_t i = 0; i < samples.size(); i++)
+		{
+			const std::size_t offset { 28 + i * 16 };
+			write32(dfd, offset, samples[i].bitOffset | (samples[i].bitLength << 16) | (samples[i].channelType << 24));
+			write32(dfd, offset + 8, samples[i].lower);
+			write32(dfd, offset + 12, samples[i].upper);
+		}
+		return dfd;
+	}
+}
+
+constexpr std::uint32_t Ktx2::formatRGBA8;
+constexpr std::uint32_t Ktx2::formatRGBA8Srgb;
+constexpr std::uint32_t Ktx2::formatBC6HUfloat;
+constexpr std::uint32_t Ktx2::formatBC7;
+constexpr std::uint32_t Ktx2::formatBC7Srgb;
+constexpr std::uint32_t Ktx2::supercompressionNone;
+constexpr std::uint32_t Ktx2::supercompressionZstd;
+
+/**
+ * @brief Constructor for Ktx2 parsing a container held in memory
+ * 
+ * The data is not copied and must outlive the view.
+ * 
+ * @param data Pointer to the start of the container
+ * @param size Size of the container in bytes
+ * 
+ * @throws InvalidFileException if the data is not a well formed KTX2 container
+ * @throws UnsupportedFormatException if the container holds anything but a single 2D texture, or is
+ * supercompressed with a scheme other than zstd
+ */
+Ktx2::Ktx2(const unsigned char *data, std::size_t size)
+{
+	if (!isKtx2(data, size) || size < headerSize)
+		throw InvalidFileException("Data is not a KTX2 container\n");
+
+	_vkFormat = read32(data + 12);
+	_width = static_cast<int>(read32(data + 20));
+	_height = static_cast<int>(read32(data + 24));
+	const std::uint32_t depth { read32(data + 28) };
+	const std::uint32_t layerCount { read32(data + 32) };
+	const std::uint32_t faceCount { read32(data + 36) };
+	const std::size_t levelCount { std::max<std::uint32_t>(read32(data + 40), 1) };
+	const std::uint32_t supercompression { read32(data + 44) };
+
+	if (_width <= 0 || _height <= 0 || depth != 0 || layerCount > 1 || faceCount != 1)
+		throw UnsupportedFormatException("Only single 2D KTX2 textures are supported\n");
+	_supercompression = supercompression;
+	if (supercompression != supercompressionNone && (supercompression != supercompressionZstd || !canDecompress))
+	{
+		std::stringstream error {};
+		error << "Unsupported KTX2 supercompression scheme " << supercompression << std::endl;
+		throw UnsupportedFormatException(error.str());
+	}
+	if (levelCount > MipChain::levelCountFor(_width, _height))
+		throw InvalidFileException("KTX2 container has more levels than its dimensions allow\n");
+	if (headerSize + levelCount * levelIndexEntrySize > size)
+		throw InvalidFileException("KTX2 level index is truncated\n");
+
+	for (std::size_t i = 0; i < levelCount; i++)
+	{
+		const unsigned char *entry { data + headerSize + i * levelIndexEntrySize };
+		const std::uint64_t offset { read64(entry) };
+		const std::uint64_t length { read64(entry + 8) };
+		if (offset > size || length > size - offset)
+		{
+			std::stringstream error {};
+			error << "KTX2 level " << i << " lies outside the file" << std::endl;
+			throw InvalidFileException(error.str());
+		}
+
+		Level level {};
+		level.data = data + offset;
+		level.size = static_cast<std::size_t>(length);
+		level.uncompressedSize = static_cast<std::size_t>(read64(entry + 16));
+		level.width = std::max(_width >> i, 1);
+		level.height = std::max(_height >> i, 1);
+
+		// Supercompressed levels are checked by their declared size, decompressLevel() makes sure the data fills it
+		const std::size_t expected { levelSizeOf(_vkFormat, level.width, level.height) };
+		const std::size_t stored { supercompression == supercompressionNone ? level.size : level.uncompressedSize };
+		if (stored < expected)
+		{
+			std::stringstream error {};
+			error << "KTX2 level " << i << " is too short for " << level.width << "x" << level.height << " texels" << std::endl;
+			throw InvalidFileException(error.str());
+		}
+		_levels.push_back(level);
+	}
+}
+
+/**
+ * @brief Getter for the format of the texture
+ * 
+ * @returns The VkFormat stored in the header
+ */
+std::uint32_t Ktx2::getVkFormat()
+{
+	return _vkFormat;
+}
+
+/**
+ * @brief Getter for the width of the texture
+ * 
+ * @returns Width of level 0 in pixels
+ */
+int Ktx2::getWidth()
+{
+	return _width;
+}
+
+/**
+ * @brief Getter for the height of the texture
+ * 
+ * @returns Height of level 0 in pixels
+ */
+int Ktx2::getHeight()
+{
+	return _height;
+}
+
+/**
+ * @brief Getter for the number of mip levels
+ * 
+ * @returns Number of levels stored in the container
+ */
+std::size_t Ktx2::getLevelCount()
+{
+	return _levels.size();
+}
+
+/**
+ * @brief Gets one mip level
+ * 
+ * @param level Index of the level, 0 being the largest
+ * 
+ * @returns Dimensions of the level and a pointer to its data inside the container
+ */
+const Ktx2::Level &Ktx2::getLevel(std::size_t level)
+{
+	return _levels.at(level);
+}
+
+/**
+ * @brief Maps the texture's format to the OpenGL formats to upload it with
+ * 
+ * @returns Internal format, and format and type for uncompressed data
+ * 
+ * @throws UnsupportedFormatException if the format has no OpenGL equivalent known to the loader
+ */
+Ktx2::GLFormat Ktx2::getGLFormat()
+{
+	const FormatInfo *info { findFormat(_vkFormat) };
+	if (!info)
+	{
+		std::stringstream error {};
+		error << "Unsupported KTX2 vkFormat " << _vkFormat << std::endl;
+		throw UnsupportedFormatException(error.str());
+	}
+	return info->gl;
+}
+
+/**
+ * @brief Checks whether the current context can sample the texture's format
+ * 
+ * @returns true if the texture can be uploaded, otherwise false
+ */
+bool Ktx2::isSupported()
+{
+	const FormatInfo *info { findFormat(_vkFormat) };
+	if (!info)
+		return false;
+	return !info->gl.compressed || BlockCompression::isSupported(info->block, info->srgb);
+}
+
+/**
+ * @brief Getter for the supercompression scheme of the level data
+ * 
+ * @returns supercompressionNone, or supercompressionZstd if the levels have to be decompressed
+ */
+std::uint32_t Ktx2::getSupercompression()
+{
+	return _supercompression;
+}
+
+/**
+ * @brief Decompresses one zstd supercompressed level
+ * 
+ * Levels are independent, so several can be decompressed on different threads at once.
+ * 
+ * @param level Index of the level, 0 being the largest
+ * @param output Destination for the level's uncompressedSize bytes
+ * 
+ * @throws InvalidFileException if the level data is corrupt
+ * @throws UnsupportedFormatException if the loader was built without zstd
+ */
+void Ktx2::decompressLevel(std::size_t level, unsigned char *output)
+{
+	const Level &source { _levels.at(level) };
+#ifdef HAVE_ZSTD
+	const std::size_t written { ZSTD_decompress(output, source.uncompressedSize, source.data, source.size) };
+	if (ZSTD_isError(written) || written != source.uncompressedSize)
+	{
+		std::stringstream error {};
+		error << "Failed to decompress KTX2 level " << level << std::endl;
+		throw InvalidFileException(error.str());
+	}
+#else
+	(void)source;
+	(void)output;
+	throw UnsupportedFormatException("KTX2 zstd supercompression needs a build with zstd\n");
+#endif
+}
+
+/**
+ * @brief Checks for the KTX2 file identifier
+ * 
+ * @param data Pointer to the start of a file
+ * @param size Size of the file in bytes
+ * 
+ * @returns true if the data starts like a KTX2 container, otherwise false
+ */
+bool Ktx2::isKtx2(const unsigned char *data, std::size_t size)
+{
+	return size >= sizeof(identifier) && std::memcmp(data, identifier, sizeof(identifier)) == 0;
+}
+
+/**
+ * @brief Writes a 2D texture and its mip chain into a KTX2 container
+ * 
+ * Levels are stored smallest first, each aligned to 16 bytes, so a reader streaming the file gets usable low
+ * resolution levels first. No supercompression or key/value data is written.
+ * 
+ * @param vkFormat One of the format constants of this class
+ * @param width Width of level 0 in pixels
+ * @param height Height of level 0 in pixels
+ * @param levels The data of each level, level 0 first
+ * 
+ * @returns The encoded container
+ * 
+ * @throws UnsupportedFormatException if the format cannot be described
+ */
+std::vector<unsigned char> Ktx2::encode(std::uint32_t vkFormat, int width, int height, const std::vector<std::vector<unsigned char>> &levels)
+{
+	const std::vector<unsigned char> dfd { formatDescriptor(vkFormat) };
+	const std::size_t dfdOffset { headerSize + levels.size() * levelIndexEntrySize };
+
+	std::vector<std::size_t> offsets(levels.size());
+	std::size_t end { dfdOffset + dfd.size() };
+	for (std::size_t i = levels.size(); i-- > 0;)
+	{
+		offsets[i] = (end + levelAlignment - 1) / levelAlignment * levelAlignment;
+		end = offsets[i] + levels[i].size();
+	}
+
+	std::vector<unsigned char> out(end, 0);
+	std::memcpy(out.data(), identifier, sizeof(identifier));
+	write32(out, 12, vkFormat);
+	write32(out, 16, 1);
+	write32(out, 20, static_cast<std::uint32_t>(width));
+	write32(out, 24, static_cast<std::uint32_t>(height));
+	write32(out, 36, 1);
+	write32(out, 40, static_cast<std::uint32_t>(levels.size()));
+	write32(out, 48, static_cast<std::uint32_t>(dfdOffset));
+	write32(out, 52, static_cast<std::uint32_t>(dfd.size()));
+
+	for (std::size_t i = 0; i < levels.size(); i++)
+	{
+		const std::size_t entry { headerSize + i * levelIndexEntrySize };
+		write64(out, entry, offsets[i]);
+		write64(out, entry + 8, levels[i].size());
+		write64(out, entry + 16, levels[i].size());
+		std::memcpy(out.data() + offsets[i], levels[i].data(), levels[i].size());
+	}
+	std::memcpy(out.data() + dfdOffset, dfd.data(), dfd.size());
+	return out;
+}
\ No newline at end of file
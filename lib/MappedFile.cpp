@@ -0,0 +1,160 @@
+#include "MappedFile.hpp"
+#include <sstream>
+#include <utility>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	std::string failureMessage(const std::string &path)
+	{
+		std::stringstream error {};
+		error << "Failed to map file: " << path << std::endl;
+		return error.str();
+	}
+}
+
+/**
+ * @brief Constructor for MappedFile mapping a whole file read-only
+ * 
+ * Empty files are valid and have no data.
+ * 
+ * @param path The path to the file
+ * 
+ * @throws MappingException if the file could not be opened or mapped
+ */
+MappedFile::MappedFile(const std::string &path)
+{
+#ifdef _WIN32
+	_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	LARGE_INTEGER size {};
+	if (_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(_file, &size))
+	{
+		if (_file != INVALID_HANDLE_VALUE)
+			CloseHandle(_file);
+		_file = nullptr;
+		throw MappingException(failureMessage(path));
+	}
+	_size = static_cast<std::size_t>(size.QuadPart);
+	if (_size == 0)
+		return;
+
+	_mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	_data = _mapping ? static_cast<const unsigned char *>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+	if (!_data)
+	{
+		unmap();
+		throw MappingException(failureMessage(path));
+	}
+#else
+	const int fd { open(path.c_str(), O_RDONLY) };
+	struct stat info {};
+	if (fd < 0 || fstat(fd, &info) != 0)
+	{
+		if (fd >= 0)
+			close(fd);
+		throw MappingException(failureMessage(path));
+	}
+	_size = static_cast<std::size_t>(info.st_size);
+	if (_size == 0)
+	{
+		close(fd);
+		return;
+	}
+
+	void *mapping { mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0) };
+	close(fd);
+	if (mapping == MAP_FAILED)
+		throw MappingException(failureMessage(path));
+	// Loaders read the file front to back right away
+	madvise(mapping, _size, MADV_SEQUENTIAL);
+	madvise(mapping, _size, MADV_WILLNEED);
+	_data = static_cast<const unsigned char *>(mapping);
+#endif
+}
+
+/**
+ * @brief Move constructor for MappedFile
+ */
+MappedFile::MappedFile(MappedFile &&rhs)
+	: _data { rhs._data }, _size { rhs._size }
+#ifdef _WIN32
+	, _file { rhs._file }, _mapping { rhs._mapping }
+#endif
+{
+	rhs._data = nullptr;
+	rhs._size = 0;
+#ifdef _WIN32
+	rhs._file = nullptr;
+	rhs._mapping = nullptr;
+#endif
+}
+
+/**
+ * @brief Destructor for MappedFile, unmaps the file
+ */
+MappedFile::~MappedFile()
+{
+	unmap();
+}
+
+/**
+ * @brief Move assignment operator for MappedFile
+ */
+MappedFile &MappedFile::operator=(MappedFile &&rhs)
+{
+	std::swap(_data, rhs._data);
+	std::swap(_size, rhs._size);
+#ifdef _WIN32
+	std::swap(_file, rhs._file);
+	std::swap(_mapping, rhs._mapping);
+#endif
+
+	return *this;
+}
+
+/**
+ * @brief Getter for the mapped contents
+ * 
+ * @returns Pointer to the first byte of the file, nullptr for an empty file
+ */
+const unsigned char *MappedFile::getData()
+{
+	return _data;
+}
+
+/**
+ * @brief Getter for the file size
+ * 
+ * @returns Size of the file in bytes
+ */
+std::size_t MappedFile::getSize()
+{
+	return _size;
+}
+
+void MappedFile::unmap()
+{
+#ifdef _WIN32
+	if (_data)
+		UnmapViewOfFile(_data);
+	if (_mapping)
+		CloseHandle(_mapping);
+	if (_file)
+		CloseHandle(_file);
+	_file = nullptr;
+	_mapping = nullptr;
+#else
+	if (_data)
+		munmap(const_cast<unsigned char *>(_data), _size);
+#endif
+	_data = nullptr;
+	_size = 0;
+}
\ No newline at end of file
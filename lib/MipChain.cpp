@@ -0,0 +1,413 @@
+#include "MipChain.hpp"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	constexpr int lanes { 4 };
+	constexpr int linearToSrgbBits { 14 };
+	constexpr float kaiserWidth { 3.0f };
+	constexpr float kaiserAlpha { 4.0f };
+	constexpr float pi { 3.14159265358979f };
+
+	struct Taps
+	{
+		int first {};
+		std::vector<float> weights {};
+	};
+
+	float srgbToLinear(float v)
+	{
+		return v <= 0.04045f ? v / 12.92f : std::pow((v + 0.055f) / 1.055f, 2.4f);
+	}
+
+	float linearToSrgb(float v)
+	{
+		return v <= 0.0031308f ? v * 12.92f : 1.055f * std::pow(v, 1.0f / 2.4f) - 0.055f;
+	}
+
+	const std::vector<float> &srgbToLinearTable()
+	{
+		static const std::vector<float> table {
+			[]()
+			{
+				std::vector<float> result(256);
+				for (int i = 0; i < 256; i++)
+					result[i] = srgbToLinear(i / 255.0f);
+				return result;
+			}()
+		};
+		return table;
+	}
+
+	const std::vector<unsigned char> &linearToSrgbTable()
+	{
+		static const std::vector<unsigned char> table {
+			[]()
+			{
+				const int size { 1 << linearToSrgbBits };
+				std::vector<unsigned char> result(size);
+				for (int i = 0; i < size; i++)
+					result[i] = static_cast<unsigned char>(linearToSrgb((i + 0.5f) / size) * 255.0f + 0.5f);
+				return result;
+			}()
+		};
+		return table;
+	}
+
+	float besselI0(float x)
+	{
+		float sum { 1.0f };
+		float term { 1.0f };
+		for (int k = 1; k < 20; k++)
+		{
+			float f { x / (2.0f * k) };
+			term *= f * f;
+			sum += term;
+		}
+		return sum;
+	}
+
+	float kaiser(float x)
+	{
+		if (std::fabs(x) >= kaiserWidth)
+			return 0.0f;
+		float sinc { x == 0.0f ? 1.0f : std::sin(pi * x) / (pi * x) };
+		float t { x / kaiserWidth };
+		return sinc * besselI0(kaiserAlpha * std::sqrt(1.0f - t * t)) / besselI0(kaiserAlpha);
+	}
+
+	/**
+	 * Computes the source taps for every destination pixel along one axis. Box weights are the exact overlap of
+	 * the destination footprint, Kaiser weights sample the kernel (in destination pixel units) at source centers.
+	 * Taps falling off the edge are clamped to the border pixel.
+	 */
+	std::vector<Taps> computeTaps(int srcSize, int dstSize, MipChain::Filter filter)
+	{
+		std::vector<Taps> result(dstSize);
+		const float scale { static_cast<float>(srcSize) / dstSize };
+		const float radius { filter == MipChain::Filter::Box ? 0.5f * scale : kaiserWidth * scale };
+
+		for (int x = 0; x < dstSize; x++)
+		{
+			const float center { (x + 0.5f) * scale };
+			const int first { static_cast<int>(std::floor(center - radius)) };
+			const int last { static_cast<int>(std::ceil(center + radius)) };
+			std::vector<float> weights(std::min(last, srcSize) - std::max(first, 0), 0.0f);
+			float total { 0.0f };
+
+			for (int i = first; i < last; i++)
+			{
+				float w {};
+				if (filter == MipChain::Filter::Box)
+					w = std::max(0.0f, std::min(i + 1.0f, center + radius) - std::max(static_cast<float>(i), center - radius));
+				else
+					w = kaiser((i + 0.5f - center) / scale);
+				weights[std::min(std::max(i, 0), srcSize - 1) - std::max(first, 0)] += w;
+				total += w;
+			}
+			for (float &w : weights)
+				w /= total;
+
+			result[x].first = std::max(first, 0);
+			result[x].weights = std::move(weights);
+		}
+		return result;
+	}
+
+	void accumulate(float *dst, const float *src, float weight)
+	{
+#ifdef __SSE2__
+		_mm_storeu_ps(dst, _mm_add_ps(_mm_loadu_ps(dst), _mm_mul_ps(_mm_set1_ps(weight), _mm_loadu_ps(src))));
+#else
+		for (int c = 0; c < lanes; c++)
+			dst[c] += weight * src[c];
+#endif
+	}
+
+	void accumulateRow(float *dst, const float *src, float weight, std::size_t count)
+	{
+		std::size_t i { 0 };
+#ifdef __SSE2__
+		const __m128 w { _mm_set1_ps(weight) };
+		for (; i + 4 <= count; i += 4)
+			_mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(w, _mm_loadu_ps(src + i))));
+#endif
+		for (; i < count; i++)
+			dst[i] += weight * src[i];
+	}
+
+	std::size_t rowGrain(int width)
+	{
+		return std::max<std::size_t>(1, 16384 / std::max(width, 1));
+	}
+
+	// How 8-bit pixels map to the linear, premultiplied floats the filters run on
+	struct Conversion
+	{
+		int channels {};
+		int alphaLane {};
+		bool premultiply {};
+		bool srgb {};
+	};
+
+	Conversion conversionFor(int channels, const MipChain::Options &options)
+	{
+		Conversion conversion {};
+		conversion.channels = channels;
+		conversion.alphaLane = channels == 2 ? 1 : channels == 4 ? 3 : -1;
+		conversion.premultiply = conversion.alphaLane >= 0 && !options.premultipliedAlpha;
+		conversion.srgb = options.srgb;
+		return conversion;
+	}
+
+	std::vector<float> toLinear(const unsigned char *src, int width, int height, const Conversion &conversion, ThreadPool &pool)
+	{
+		const std::vector<float> &toLinear { srgbToLinearTable() };
+		std::vector<float> result(static_cast<std::size_t>(width) * height * lanes, 0.0f);
+		pool.parallelFor(0, height, [&](std::size_t begin, std::size_t end)
+		{
+			for (std::size_t p = begin * width; p < end * width; p++)
+			{
+				float *pixel { &result[p * lanes] };
+				for (int c = 0; c < conversion.channels; c++)
+				{
+					unsigned char v { src[p * conversion.channels + c] };
+					pixel[c] = (conversion.srgb && c != conversion.alphaLane) ? toLinear[v] : v / 255.0f;
+				}
+				if (conversion.premultiply)
+					for (int c = 0; c < conversion.channels; c++)
+						if (c != conversion.alphaLane)
+							pixel[c] *= pixel[conversion.alphaLane];
+			}
+		}, rowGrain(width));
+		return result;
+	}
+
+	/**
+	 * Resamples linear pixels with a separable filter, rows split across the pool's workers, and encodes the
+	 * result back to 8 bits into output. Returns the resampled linear pixels for the next reduction.
+	 */
+	std::vector<float> resampleLinear(const std::vector<float> &current, int srcWidth, int srcHeight, int dstWidth, int dstHeight,
+		MipChain::Filter filter, const Conversion &conversion, unsigned char *output, ThreadPool &pool)
+	{
+		const std::vector<unsigned char> &toSrgb { linearToSrgbTable() };
+		const std::vector<Taps> horizontal { computeTaps(srcWidth, dstWidth, filter) };
+		const std::vector<Taps> vertical { computeTaps(srcHeight, dstHeight, filter) };
+		const int channels { conversion.channels };
+		const int alphaLane { conversion.alphaLane };
+
+		std::vector<float> rows(static_cast<std::size_t>(dstWidth) * srcHeight * lanes, 0.0f);
+		pool.parallelFor(0, srcHeight, [&](std::size_t begin, std::size_t end)
+		{
+			for (std::size_t y = begin; y < end; y++)
+			{
+				const float *in { &current[y * srcWidth * lanes] };
+				float *out { &rows[y * dstWidth * lanes] };
+				for (int x = 0; x < dstWidth; x++)
+				{
+					const Taps &taps { horizontal[x] };
+					for (std::size_t t = 0; t < taps.weights.size(); t++)
+						accumulate(out + x * lanes, in + (taps.first + t) * lanes, taps.weights[t]);
+				}
+			}
+		}, rowGrain(srcWidth));
+
+		std::vector<float> next(static_cast<std::size_t>(dstWidth) * dstHeight * lanes, 0.0f);
+		pool.parallelFor(0, dstHeight, [&](std::size_t begin, std::size_t end)
+		{
+			const std::size_t rowFloats { static_cast<std::size_t>(dstWidth) * lanes };
+			for (std::size_t y = begin; y < end; y++)
+			{
+				float *out { &next[y * rowFloats] };
+				const Taps &taps { vertical[y] };
+				for (std::size_t t = 0; t < taps.weights.size(); t++)
+					accumulateRow(out, &rows[(taps.first + t) * rowFloats], taps.weights[t], rowFloats);
+
+				for (int x = 0; x < dstWidth; x++)
+				{
+					float *pixel { out + x * lanes };
+					for (int c = 0; c < channels; c++)
+						pixel[c] = std::min(std::max(pixel[c], 0.0f), 1.0f);
+					const float alpha { alphaLane >= 0 ? pixel[alphaLane] : 1.0f };
+					if (conversion.premultiply)
+						for (int c = 0; c < channels; c++)
+							if (c != alphaLane)
+								pixel[c] = std::min(pixel[c], alpha);
+
+					unsigned char *encoded { output + (y * dstWidth + x) * channels };
+					for (int c = 0; c < channels; c++)
+					{
+						float v { pixel[c] };
+						if (conversion.premultiply && c != alphaLane)
+							v = alpha > 0.0f ? v / alpha : 0.0f;
+						if (conversion.srgb && c != alphaLane)
+							encoded[c] = toSrgb[std::min(static_cast<int>(v * (1 << linearToSrgbBits)), (1 << linearToSrgbBits) - 1)];
+						else
+							encoded[c] = static_cast<unsigned char>(v * 255.0f + 0.5f);
+					}
+				}
+			}
+		}, rowGrain(dstWidth));
+
+		return next;
+	}
+}
+
+/**
+ * @brief Constructor for MipChain allocating storage for every level of an image
+ * 
+ * @param width Width of level 0 in pixels
+ * @param height Height of level 0 in pixels
+ * @param channels Number of 8-bit channels per pixel, 1 to 4
+ * 
+ * @throws InvalidImageException if the dimensions or channel count are invalid
+ */
+MipChain::MipChain(int width, int height, int channels) : _channels { channels }
+{
+	if (width <= 0 || height <= 0 || channels < 1 || channels > lanes)
+	{
+		std::stringstream error {};
+		error << "Cannot build mip chain for " << width << "x" << height << " image with " << channels << " channels" << std::endl;
+		throw InvalidImageException(error.str());
+	}
+
+	std::size_t offset { 0 };
+	for (std::size_t i = 0; i < levelCountFor(width, height); i++)
+	{
+		Level level {};
+		level.width = std::max(width >> i, 1);
+		level.height = std::max(height >> i, 1);
+		level.offset = offset;
+		level.size = static_cast<std::size_t>(level.width) * level.height * channels;
+		offset += level.size;
+		_levels.push_back(level);
+	}
+	_data.resize(offset);
+}
+
+/**
+ * @brief Filters levels 1 and up from the contents of level 0
+ * 
+ * Level 0 is converted to linear, premultiplied floats once. Each further level is reduced from the previous one
+ * with a separable filter, rows split across the pool's workers, and then unpremultiplied and re-encoded.
+ * 
+ * @param options Filter kernel and how to interpret color and alpha
+ * @param pool The pool to run the filter passes on. Defaults to the shared pool
+ */
+void MipChain::generate(const Options &options, ThreadPool &pool)
+{
+	const Conversion conversion { conversionFor(_channels, options) };
+	std::vector<float> current { toLinear(getLevelData(0), _levels[0].width, _levels[0].height, conversion, pool) };
+	for (std::size_t i = 1; i < _levels.size(); i++)
+	{
+		const Level &src { _levels[i - 1] };
+		const Level &dst { _levels[i] };
+		current = resampleLinear(current, src.width, src.height, dst.width, dst.height, options.filter, conversion, getLevelData(i), pool);
+	}
+}
+
+/**
+ * @brief Gets the storage of the whole chain
+ * 
+ * @returns Pointer to level 0, the other levels follow it back to back
+ */
+unsigned char *MipChain::getData()
+{
+	return _data.data();
+}
+
+/**
+ * @brief Gets the pixels of one level
+ * 
+ * @param level Index of the level, 0 being the largest
+ * 
+ * @returns Pointer to the tightly packed pixels of the level
+ */
+unsigned char *MipChain::getLevelData(std::size_t level)
+{
+	return _data.data() + _levels.at(level).offset;
+}
+
+/**
+ * @brief Getter for the size of the whole chain
+ * 
+ * @returns Size of all levels in bytes
+ */
+std::size_t MipChain::getSize()
+{
+	return _data.size();
+}
+
+/**
+ * @brief Getter for the number of levels
+ * 
+ * @returns Number of levels, down to 1x1
+ */
+std::size_t MipChain::getLevelCount()
+{
+	return _levels.size();
+}
+
+/**
+ * @brief Getter for the layout of one level
+ * 
+ * @param level Index of the level, 0 being the largest
+ * 
+ * @returns Dimensions, offset and size of the level
+ */
+const MipChain::Level &MipChain::getLevel(std::size_t level)
+{
+	return _levels.at(level);
+}
+
+/**
+ * @brief Getter for the number of channels per pixel
+ * 
+ * @returns Number of 8-bit channels
+ */
+int MipChain::getChannels()
+{
+	return _channels;
+}
+
+/**
+ * @brief Computes the length of a full mip chain
+ * 
+ * @param width Width of level 0
+ * @param height Height of level 0
+ * 
+ * @returns Number of levels down to 1x1
+ */
+std::size_t MipChain::levelCountFor(int width, int height)
+{
+	std::size_t count { 1 };
+	for (int size = std::max(width, height); size > 1; size >>= 1)
+		count++;
+	return count;
+}
+
+/**
+ * @brief Resizes an image with the same filtering as the levels of a chain
+ * 
+ * Used to downscale images to a resolution budget before their chain is built, any ratio is supported.
+ * 
+ * @param src Tightly packed source pixels
+ * @param width Width of the source
+ * @param height Height of the source
+ * @param channels Number of 8-bit channels per pixel, 1 to 4
+ * @param dst Storage for dstWidth * dstHeight * channels bytes
+ * @param dstWidth Width to resize to
+ * @param dstHeight Height to resize to
+ * @param options Filter kernel and how to interpret color and alpha
+ * @param pool The pool to run the filter passes on. Defaults to the shared pool
+ */
+void MipChain::resample(const unsigned char *src, int width, int height, int channels, unsigned char *dst, int dstWidth, int dstHeight, const Options &options, ThreadPool &pool)
+{
+	const Conversion conversion { conversionFor(channels, options) };
+	resampleLinear(toLinear(src, width, height, conversion, pool), width, height, dstWidth, dstHeight, options.filter, conversion, dst, pool);
+}
\ No newline at end of file
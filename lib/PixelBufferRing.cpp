@@ -0,0 +1,219 @@
+#include "PixelBufferRing.hpp"
+#include "GLExtensions.hpp"
+#include <sstream>
+#include <spdlog/spdlog.h>
+
+namespace
+{
+	// Segment offsets are kept aligned so they satisfy GL_MIN_MAP_BUFFER_ALIGNMENT and any unpack alignment
+	constexpr GLsizeiptr segmentAlignment { 256 };
+	constexpr GLuint64 fenceTimeout { 1000000000 };
+
+	GLsizeiptr alignUp(GLsizeiptr value)
+	{
+		return (value + segmentAlignment - 1) & ~(segmentAlignment - 1);
+	}
+
+	void waitForFence(GLsync fence)
+	{
+		GLenum result { glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, fenceTimeout) };
+		while (result == GL_TIMEOUT_EXPIRED)
+			result = glClientWaitSync(fence, 0, fenceTimeout);
+		glDeleteSync(fence);
+	}
+}
+
+/**
+ * @brief Constructor for PixelBufferRing with a given capacity
+ * 
+ * Uses immutable, persistently mapped storage if ARB_buffer_storage is available, otherwise falls back to
+ * glBufferData and maps each segment when it is acquired.
+ * 
+ * @param capacity Size of the ring in bytes
+ * 
+ * @throws StagingException if the persistent mapping could not be created
+ */
+PixelBufferRing::PixelBufferRing(GLsizeiptr capacity) : _capacity { alignUp(capacity) }
+{
+	if (!glBufferStorage && hasGLExtension("GL_ARB_buffer_storage"))
+		glad_glBufferStorage = reinterpret_cast<PFNGLBUFFERSTORAGEPROC>(glfwGetProcAddress("glBufferStorage"));
+	_persistent = glBufferStorage != nullptr;
+
+	glGenBuffers(1, &_buffer);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _buffer);
+	if (_persistent)
+	{
+		const GLbitfield flags { GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT };
+		glBufferStorage(GL_PIXEL_UNPACK_BUFFER, _capacity, nullptr, flags);
+		_mapping = static_cast<char *>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, _capacity, flags));
+		if (!_mapping)
+		{
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			throw StagingException("Failed to persistently map pixel unpack buffer");
+		}
+	}
+	else
+	{
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, _capacity, nullptr, GL_STREAM_DRAW);
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	spdlog::debug("Created pixel buffer ring: capacity={}, persistent={}", _capacity, _persistent);
+}
+
+/**
+ * @brief Destructor for PixelBufferRing, releases the buffer and any outstanding fences
+ * 
+ * GL objects are only deleted while a context is still current, so a ring outliving the window is harmless.
+ */
+PixelBufferRing::~PixelBufferRing()
+{
+	if (!glfwGetCurrentContext())
+		return;
+
+	for (InFlight &segment : _inFlight)
+		glDeleteSync(segment.fence);
+	if (_persistent)
+	{
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _buffer);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
+	glDeleteBuffers(1, &_buffer);
+}
+
+/**
+ * @brief Acquires writable staging memory and binds its buffer to GL_PIXEL_UNPACK_BUFFER
+ * 
+ * Blocks until the GPU has finished reading any earlier upload that used the same region of the ring.
+ * Requests larger than the ring get a dedicated, orphaned buffer instead. Without persistent mapping, only one
+ * segment may be acquired at a time.
+ * 
+ * @param size Number of bytes needed
+ * 
+ * @returns The acquired segment, with data pointing at mapped memory
+ * 
+ * @throws StagingException if the memory could not be mapped
+ */
+PixelBufferRing::Segment PixelBufferRing::acquire(GLsizeiptr size)
+{
+	Segment segment {};
+	segment.size = size;
+
+	if (alignUp(size) > _capacity)
+	{
+		segment.dedicated = true;
+		glGenBuffers(1, &segment.buffer);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, segment.buffer);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+		segment.data = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		spdlog::debug("Staging {} bytes in a dedicated pixel buffer", size);
+	}
+	else
+	{
+		if (_head + alignUp(size) > _capacity)
+			_head = 0;
+		waitForRange(_head, alignUp(size));
+
+		segment.buffer = _buffer;
+		segment.offset = _head;
+		_head += alignUp(size);
+
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _buffer);
+		if (_persistent)
+			segment.data = _mapping + segment.offset;
+		else
+			segment.data = glMapBufferRange(
+				GL_PIXEL_UNPACK_BUFFER,
+				segment.offset,
+				size,
+				GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT
+			);
+	}
+
+	if (!segment.data)
+	{
+		std::stringstream error {};
+		error << "Failed to map " << size << " bytes of pixel unpack buffer" << std::endl;
+		throw StagingException(error.str());
+	}
+	return segment;
+}
+
+/**
+ * @brief Finishes writing to a segment and makes it the source of the next pixel unpack
+ * 
+ * @param segment A segment returned by acquire()
+ * 
+ * @returns The value to pass as the pixels pointer to glTexImage2D and friends
+ */
+const void *PixelBufferRing::unpack(Segment &segment)
+{
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, segment.buffer);
+	if (segment.dedicated || !_persistent)
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+	segment.data = nullptr;
+
+	return reinterpret_cast<const void *>(segment.offset);
+}
+
+/**
+ * @brief Returns a segment to the ring once the uploads reading from it have been issued
+ * 
+ * Inserts a fence so that the region is not overwritten before the GPU is done with it, and unbinds
+ * GL_PIXEL_UNPACK_BUFFER so later client memory uploads are unaffected.
+ * 
+ * @param segment A segment previously passed to unpack()
+ */
+void PixelBufferRing::release(Segment &segment)
+{
+	if (segment.dedicated)
+		glDeleteBuffers(1, &segment.buffer);
+	else
+		_inFlight.push_back({ segment.offset, alignUp(segment.size), glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) });
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	segment = Segment {};
+}
+
+/**
+ * @brief Checks whether the ring is persistently mapped
+ * 
+ * @returns true if ARB_buffer_storage is in use, otherwise false
+ */
+bool PixelBufferRing::isPersistent()
+{
+	return _persistent;
+}
+
+/**
+ * @brief Getter for the ring's capacity
+ * 
+ * @returns Capacity of the ring in bytes
+ */
+GLsizeiptr PixelBufferRing::getCapacity()
+{
+	return _capacity;
+}
+
+/**
+ * @brief Waits for every in-flight upload overlapping a region of the ring
+ * 
+ * Fences signal in submission order, so everything older than the newest overlapping upload is retired as well.
+ * 
+ * @param offset Start of the region
+ * @param size Size of the region
+ */
+void PixelBufferRing::waitForRange(GLintptr offset, GLsizeiptr size)
+{
+	std::size_t retire { 0 };
+	for (std::size_t i = 0; i < _inFlight.size(); i++)
+	{
+		const InFlight &segment { _inFlight[i] };
+		if (segment.offset < offset + size && offset < segment.offset + segment.size)
+			retire = i + 1;
+	}
+	for (std::size_t i = 0; i < retire; i++)
+	{
+		waitForFence(_inFlight.front().fence);
+		_inFlight.pop_front();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,236 @@
+#include "ProgramCache.hpp"
+#include "GLExtensions.hpp"
+#include "Hash.hpp"
+#include "MappedFile.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <spdlog/spdlog.h>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+	// Bump when the layout changes
+	constexpr std::uint64_t cacheVersion { 1 };
+	constexpr unsigned char identifier[8] { 0xAB, 'P', 'R', 'G', 0xBB, 0x0D, 0x0A, 0x1A };
+	constexpr std::size_t headerSize { 24 };
+
+	// Entries are only read back on the machine that wrote them, so fields are stored in native byte order
+	template <typename T>
+	T read(const unsigned char *p)
+	{
+		T value {};
+		std::memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	std::uint64_t hashString(const GLubyte *string, std::uint64_t seed)
+	{
+		const char *chars { reinterpret_cast<const char *>(string) };
+		return chars ? hashBytes(chars, std::strlen(chars), seed) : seed;
+	}
+}
+
+/**
+ * @brief Constructor for ProgramCache storing entries in a directory
+ * 
+ * The directory is created if it doesn't exist, its parent has to exist.
+ * 
+ * @param directory The directory holding the entries
+ */
+ProgramCache::ProgramCache(const std::string &directory) : _directory { directory }
+{
+	if (!_directory.empty() && _directory.back() != '/' && _directory.back() != '\\')
+		_directory += '/';
+#ifdef _WIN32
+	_mkdir(directory.c_str());
+#else
+	mkdir(directory.c_str(), 0755);
+#endif
+	spdlog::debug("Caching shader program binaries in {}", _directory);
+}
+
+/**
+ * @brief Checks whether the cache has a directory
+ * 
+ * @returns false for the default constructed, disabled cache
+ */
+bool ProgramCache::isEnabled()
+{
+	return !_directory.empty();
+}
+
+/**
+ * @brief Loads a cached binary into a program
+ * 
+ * Unreadable or foreign entries and binaries the driver rejects count as misses and are overwritten by the next
+ * store().
+ * 
+ * @param key Key from keyOf()
+ * @param program A program object without attached shaders
+ * 
+ * @returns True if the program is linked from the cached binary
+ */
+bool ProgramCache::load(std::uint64_t key, GLuint program)
+{
+	if (!isEnabled() || !isSupported())
+		return false;
+
+	try
+	{
+		MappedFile file { pathOf(key) };
+		const unsigned char *data { file.getData() };
+		const std::size_t size { file.getSize() };
+		if (size < headerSize || std::memcmp(data, identifier, sizeof(identifier)) != 0 || read<std::uint64_t>(data + 8) != key)
+			return false;
+
+		const GLenum format { read<GLenum>(data + 16) };
+		const std::uint32_t length { read<std::uint32_t>(data + 20) };
+		if (length == 0 || length > size - headerSize)
+			return false;
+
+		glProgramBinary(program, format, data + headerSize, static_cast<GLsizei>(length));
+	}
+	catch (const MappedFile::MappingException &)
+	{
+		return false;
+	}
+
+	GLint success {};
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		spdlog::debug("Driver rejected cached shader program {}", pathOf(key));
+		return false;
+	}
+	spdlog::debug("Loaded shader program from {}", pathOf(key));
+	return true;
+}
+
+/**
+ * @brief Writes the binary of a linked program into the cache
+ * 
+ * The program should have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set. The entry is written to a
+ * temporary file and renamed into place, so concurrent readers never see a partial entry. Failing to write is
+ * not an error, the program is just compiled again next time.
+ * 
+ * @param key Key from keyOf()
+ * @param program A successfully linked program
+ */
+void ProgramCache::store(std::uint64_t key, GLuint program)
+{
+	if (!isEnabled() || !isSupported())
+		return;
+
+	GLint length {};
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+		return;
+
+	std::vector<unsigned char> binary(static_cast<std::size_t>(length));
+	GLenum format {};
+	GLsizei written {};
+	glGetProgramBinary(program, length, &written, &format, binary.data());
+	if (written <= 0)
+		return;
+
+	unsigned char header[headerSize] {};
+	const std::uint32_t size { static_cast<std::uint32_t>(written) };
+	std::memcpy(header, identifier, sizeof(identifier));
+	std::memcpy(header + 8, &key, sizeof(key));
+	std::memcpy(header + 16, &format, sizeof(format));
+	std::memcpy(header + 20, &size, sizeof(size));
+
+	const std::string path { pathOf(key) };
+	const std::string temporary { path + ".tmp" };
+	{
+		std::ofstream os { temporary, std::ios::binary };
+		os.write(reinterpret_cast<const char *>(header), static_cast<std::streamsize>(headerSize));
+		os.write(reinterpret_cast<const char *>(binary.data()), static_cast<std::streamsize>(size));
+		if (!os)
+		{
+			spdlog::debug("Failed to write program cache entry {}", temporary);
+			os.close();
+			std::remove(temporary.c_str());
+			return;
+		}
+	}
+	std::remove(path.c_str());
+	if (std::rename(temporary.c_str(), path.c_str()) != 0)
+		std::remove(temporary.c_str());
+	spdlog::debug("Cached shader program {} ({} bytes)", path, size);
+}
+
+/**
+ * @brief Checks whether the current context can retrieve and load program binaries
+ * 
+ * Loads the entry points of ARB_get_program_binary if the context is older than 4.1 but advertises the
+ * extension. Requires a current context with glad loaded.
+ * 
+ * @returns True if the driver supports at least one binary format
+ */
+bool ProgramCache::isSupported()
+{
+	static const bool supported {
+		[]()
+		{
+			if (!glProgramBinary && hasGLExtension("GL_ARB_get_program_binary"))
+			{
+				glad_glProgramBinary = reinterpret_cast<PFNGLPROGRAMBINARYPROC>(glfwGetProcAddress("glProgramBinary"));
+				glad_glGetProgramBinary = reinterpret_cast<PFNGLGETPROGRAMBINARYPROC>(glfwGetProcAddress("glGetProgramBinary"));
+				glad_glProgramParameteri = reinterpret_cast<PFNGLPROGRAMPARAMETERIPROC>(glfwGetProcAddress("glProgramParameteri"));
+			}
+			if (!glProgramBinary || !glGetProgramBinary || !glProgramParameteri)
+				return false;
+
+			GLint formats {};
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+			spdlog::debug("Driver supports {} program binary formats", formats);
+			return formats > 0;
+		}()
+	};
+
+	return supported;
+}
+
+/**
+ * @brief Computes the cache key of a program, requires a current context
+ * 
+ * @param sources The final source of every stage in attachment order, after preprocessing and injecting defines
+ * 
+ * @returns The key
+ */
+std::uint64_t ProgramCache::keyOf(const std::vector<std::string> &sources)
+{
+	std::uint64_t key { cacheVersion };
+	key = hashString(glGetString(GL_VENDOR), key);
+	key = hashString(glGetString(GL_RENDERER), key);
+	key = hashString(glGetString(GL_VERSION), key);
+	for (const std::string &source : sources)
+		key = hashCombine(key, hashBytes(source.data(), source.size(), source.size()));
+	return key;
+}
+
+/**
+ * @brief Gets the cache consulted by Shader, disabled until a cache with a directory is assigned to it
+ * 
+ * @returns The shared ProgramCache
+ */
+ProgramCache &ProgramCache::shared()
+{
+	static ProgramCache cache {};
+	return cache;
+}
+
+std::string ProgramCache::pathOf(std::uint64_t key)
+{
+	std::stringstream path {};
+	path << _directory << std::hex << std::setw(16) << std::setfill('0') << key << ".prg";
+	return path.str();
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include "ResolutionBudget.hpp"
+#include <algorithm>
+
+namespace
+{
+	// Combines two limits where 0 means unlimited
+	int tighter(int a, int b)
+	{
+		if (a <= 0)
+			return std::max(b, 0);
+		return b <= 0 ? a : std::min(a, b);
+	}
+}
+
+constexpr std::size_t ResolutionBudget::roleCount;
+
+/**
+ * @brief Constructor for a budget with the same limit for every role
+ * 
+ * @param maxDimension Largest width or height textures are loaded at, 0 for unlimited
+ */
+ResolutionBudget::ResolutionBudget(int maxDimension)
+	: _limit { maxDimension }
+{
+}
+
+/**
+ * @brief Sets the limit applying to every role
+ * 
+ * @param maxDimension Largest width or height textures are loaded at, 0 for unlimited
+ */
+void ResolutionBudget::setLimit(int maxDimension)
+{
+	_limit = maxDimension;
+}
+
+/**
+ * @brief Sets the limit of one role, on top of the global one
+ * 
+ * @param role The material role, e.g. Role::Normal
+ * @param maxDimension Largest width or height textures of the role are loaded at, 0 for unlimited
+ */
+void ResolutionBudget::setLimit(Role role, int maxDimension)
+{
+	_roleLimits.at(static_cast<std::size_t>(role)) = maxDimension;
+}
+
+/**
+ * @brief Gets the effective limit of a role
+ * 
+ * @param role The material role
+ * 
+ * @returns The smaller of the global and the role's limit, 0 if both are unlimited
+ */
+int ResolutionBudget::getLimit(Role role)
+{
+	return tighter(_limit, _roleLimits.at(static_cast<std::size_t>(role)));
+}
+
+/**
+ * @brief Applies the limit of a role to load options
+ * 
+ * @param options Options to start from, a maxDimension already set in them is kept if it is tighter
+ * @param role The role the texture is loaded for
+ * 
+ * @returns A copy of options with maxDimension capped to the role's limit
+ */
+TextureLoadOptions ResolutionBudget::apply(const TextureLoadOptions &options, Role role)
+{
+	TextureLoadOptions capped { options };
+	capped.maxDimension = tighter(options.maxDimension, getLimit(role));
+	return capped;
+}
\ No newline at end of file
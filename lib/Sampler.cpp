@@ -0,0 +1,150 @@
+#include "Sampler.hpp"
+#include "GLExtensions.hpp"
+#include <algorithm>
+#include <utility>
+#include <spdlog/spdlog.h>
+
+/**
+ * @brief Compares two sampler states
+ * 
+ * @returns true if all parameters are equal
+ */
+bool SamplerState::operator==(const SamplerState &rhs) const
+{
+	return wrapS == rhs.wrapS && wrapT == rhs.wrapT && minFilter == rhs.minFilter && magFilter == rhs.magFilter && anisotropy == rhs.anisotropy;
+}
+
+/**
+ * @brief Compares two sampler states
+ * 
+ * @returns true if any parameter differs
+ */
+bool SamplerState::operator!=(const SamplerState &rhs) const
+{
+	return !(*this == rhs);
+}
+
+/**
+ * @brief Creates the state of a glTF sampler
+ * 
+ * glTF stores the OpenGL enum values themselves, with filters left undefined (0 or absent) if the implementation
+ * may choose.
+ * 
+ * @param magFilter The sampler's magFilter, or 0 if undefined
+ * @param minFilter The sampler's minFilter, or 0 if undefined
+ * @param wrapS The sampler's wrapS, or 0 for the default GL_REPEAT
+ * @param wrapT The sampler's wrapT, or 0 for the default GL_REPEAT
+ * @param anisotropy Maximum anisotropy to sample with, 1 disables anisotropic filtering
+ * 
+ * @returns The sampler state
+ */
+SamplerState SamplerState::fromGltf(int magFilter, int minFilter, int wrapS, int wrapT, float anisotropy)
+{
+	SamplerState state {};
+	if (magFilter > 0)
+		state.magFilter = magFilter;
+	if (minFilter > 0)
+		state.minFilter = minFilter;
+	if (wrapS > 0)
+		state.wrapS = wrapS;
+	if (wrapT > 0)
+		state.wrapT = wrapT;
+	state.anisotropy = std::max(anisotropy, 1.0f);
+	return state;
+}
+
+/**
+ * @brief Constructor for Sampler creating a sampler object with the given state
+ * 
+ * Anisotropy is clamped to what the context supports and ignored without anisotropic filtering support.
+ * 
+ * @param state Wrap, filter and anisotropy parameters
+ */
+Sampler::Sampler(const SamplerState &state) : _state { state }
+{
+	glGenSamplers(1, &_id);
+	glSamplerParameteri(_id, GL_TEXTURE_WRAP_S, state.wrapS);
+	glSamplerParameteri(_id, GL_TEXTURE_WRAP_T, state.wrapT);
+	glSamplerParameteri(_id, GL_TEXTURE_MIN_FILTER, state.minFilter);
+	glSamplerParameteri(_id, GL_TEXTURE_MAG_FILTER, state.magFilter);
+	const float anisotropy { std::min(state.anisotropy, getMaxAnisotropy()) };
+	if (anisotropy > 1.0f)
+		glSamplerParameterf(_id, GL_TEXTURE_MAX_ANISOTROPY, anisotropy);
+	spdlog::debug("Created sampler {}: wrap={:#x}/{:#x}, filter={:#x}/{:#x}, anisotropy={}", _id, state.wrapS, state.wrapT, state.minFilter, state.magFilter, anisotropy);
+}
+
+/**
+ * @brief Move constructor for Sampler
+ */
+Sampler::Sampler(Sampler &&rhs) : _id { rhs._id }, _state { rhs._state }
+{
+	rhs._id = 0;
+}
+
+/**
+ * @brief Destructor for Sampler, deletes the sampler object while a context is still current
+ */
+Sampler::~Sampler()
+{
+	if (_id && glfwGetCurrentContext())
+		glDeleteSamplers(1, &_id);
+}
+
+/**
+ * @brief Move assignment operator for Sampler
+ */
+Sampler &Sampler::operator=(Sampler &&rhs)
+{
+	std::swap(_id, rhs._id);
+	_state = rhs._state;
+
+	return *this;
+}
+
+/**
+ * @brief Binds the sampler to a given texture unit
+ * 
+ * @param target The texture unit to bind to, e.g. GL_TEXTURE0
+ */
+void Sampler::bind(GLenum target)
+{
+	glBindSampler(target - GL_TEXTURE0, _id);
+}
+
+/**
+ * @brief Getter for the OpenGL sampler name
+ * 
+ * @returns The sampler's id
+ */
+GLuint Sampler::getId()
+{
+	return _id;
+}
+
+/**
+ * @brief Getter for the sampler's parameters
+ * 
+ * @returns The state the sampler was created with
+ */
+const SamplerState &Sampler::getState()
+{
+	return _state;
+}
+
+/**
+ * @brief Gets the largest anisotropy the context supports
+ * 
+ * @returns The maximum anisotropy, 1 if anisotropic filtering is not supported
+ */
+float Sampler::getMaxAnisotropy()
+{
+	static const float maxAnisotropy { []()
+	{
+		if (!hasGLExtension("GL_EXT_texture_filter_anisotropic") && !hasGLExtension("GL_ARB_texture_filter_anisotropic"))
+			return 1.0f;
+		GLfloat value { 1.0f };
+		glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &value);
+		return value;
+	}() };
+	return maxAnisotropy;
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include "SamplerCache.hpp"
+#include <algorithm>
+
+/**
+ * @brief Gets the sampler for a state, creating it on first use
+ * 
+ * @param state Wrap, filter and anisotropy parameters
+ * 
+ * @returns The sampler, valid as long as the cache
+ */
+Sampler &SamplerCache::get(const SamplerState &state)
+{
+	auto it { std::find_if(_samplers.begin(), _samplers.end(), [&state](Sampler &sampler) { return sampler.getState() == state; }) };
+	if (it != _samplers.end())
+		return *it;
+
+	_samplers.emplace_back(state);
+	return _samplers.back();
+}
+
+/**
+ * @brief Binds the sampler for a state to a texture unit, unless it is bound there already
+ * 
+ * @param target The texture unit to bind to, e.g. GL_TEXTURE0
+ * @param state Wrap, filter and anisotropy parameters
+ */
+void SamplerCache::bind(GLenum target, const SamplerState &state)
+{
+	bindId(target, get(state).getId());
+}
+
+/**
+ * @brief Removes the sampler from a texture unit, so the bound texture's own parameters apply
+ * 
+ * @param target The texture unit, e.g. GL_TEXTURE0
+ */
+void SamplerCache::unbind(GLenum target)
+{
+	bindId(target, 0);
+}
+
+/**
+ * @brief Getter for the number of unique samplers
+ * 
+ * @returns Number of sampler objects created
+ */
+std::size_t SamplerCache::getCount()
+{
+	return _samplers.size();
+}
+
+/**
+ * @brief Gets the cache shared by textures, creating it on first use
+ * 
+ * Requires a current context on first use, like every sampler creation.
+ * 
+ * @returns The shared SamplerCache
+ */
+SamplerCache &SamplerCache::shared()
+{
+	static SamplerCache cache {};
+	return cache;
+}
+
+void SamplerCache::bindId(GLenum target, GLuint id)
+{
+	const std::size_t unit { target - GL_TEXTURE0 };
+	if (unit >= _bound.size())
+		_bound.resize(unit + 1, 0);
+	else if (_bound[unit] == id)
+		return;
+
+	glBindSampler(static_cast<GLuint>(unit), id);
+	_bound[unit] = id;
+}
\ No newline at end of file
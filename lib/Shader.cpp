@@ -1,111 +1,508 @@
 #include "Shader.hpp"
-#include <fstream>
+#include "ProgramCache.hpp"
+#include "ShaderPreprocessor.hpp"
+#include "UniformBlocks.hpp"
+#include <algorithm>
+#include <cstring>
 #include <sstream>
 #include <spdlog/spdlog.h>
 #include <glm/gtc/type_ptr.hpp>
 
+namespace
+{
+	GLuint compileStage(GLenum stage, const std::string &source)
+	{
+		const char *text { source.c_str() };
+		GLuint shader { glCreateShader(stage) };
+		glShaderSource(shader, 1, &text, nullptr);
+		glCompileShader(shader);
+		return shader;
+	}
+
+	// Called once linking failed, a stage that did not compile is the more useful error
+	void throwStageError(GLenum stage, GLuint shader)
+	{
+		GLint success {};
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+		if (success)
+			return;
+
+		char infoLog[512] {};
+		glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+		std::stringstream error {};
+		if (stage == GL_VERTEX_SHADER)
+		{
+			error << "Vertex Shader compilation failed: " << infoLog << std::endl;
+			throw Shader::VertexShaderCompilationException(error.str());
+		}
+		error << "Fragment Shader compilation failed: " << infoLog << std::endl;
+		throw Shader::FragmentShaderCompilationException(error.str());
+	}
+}
+
 /**
  * @brief Constructor for a Shader from a path to vertex and fragment shader
  * 
+ * If the shared ProgramCache is enabled, a cached binary of the program is loaded instead of compiling it, and
+ * newly linked programs are added to the cache.
+ * 
  * @param vertPath The path to a vertex shader
  * @param fragPath The path to a fragment shader
  * 
  * @throws VertexShaderCompilationException if failed to compile vertex shader
  * @throws FragmentShaderCompilationException if failed to compile fragment shader
  * @throws ShaderProgramLinkingException if failed to link shader program
+ * @throws ShaderPreprocessor::PreprocessingException if a source or one of its includes could not be read
  */
-Shader::Shader(const std::string &vertPath, const std::string &fragPath) : _id { glCreateProgram() }
-{
-	std::ifstream is { vertPath };
-	std::stringstream ss {};
-	ss << is.rdbuf();
-	std::string vertShaderStr { ss.str() };
-	const char *vertShaderSource { vertShaderStr.c_str() };
-	is.close();
-	ss.str(std::string());
-
-	GLuint vertShader { glCreateShader(GL_VERTEX_SHADER) };
-	glShaderSource(vertShader, 1, &vertShaderSource, nullptr);
-	glCompileShader(vertShader);
-	
-	GLint success {};
-	char infoLog[512] {};
-	glGetShaderiv(vertShader, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(vertShader, 512, nullptr, infoLog);
-		std::stringstream error {};
-		error << "Vertex Shader compilation failed: " << infoLog << std::endl;
-		throw VertexShaderCompilationException(error.str());
-	}
-	spdlog::debug("Compiled Vertex Shader");
-
-	is.open(fragPath);
-	ss << is.rdbuf();
-	std::string fragShaderStr { ss.str() };
-	const char *fragShaderSource { fragShaderStr.c_str() };
-	is.close();
-	ss.str(std::string());
-	
-	GLuint fragShader { glCreateShader(GL_FRAGMENT_SHADER) };
-	glShaderSource(fragShader, 1, &fragShaderSource, nullptr);
-	glCompileShader(fragShader);
-
-	glGetShaderiv(fragShader, GL_COMPILE_STATUS, &success);
-	if (!success)
+Shader::Shader(const std::string &vertPath, const std::string &fragPath) : Shader { begin(vertPath, fragPath, std::string {}) }
+{
+}
+
+/**
+ * @brief Constructor for a Shader from a path to vertex and fragment shader with extra source text
+ * 
+ * The prelude is inserted after the #version line of both stages, e.g. UniformBlocks::declarations() or
+ * #defines. Files may #include others, see ShaderPreprocessor.
+ * 
+ * @param vertPath The path to a vertex shader
+ * @param fragPath The path to a fragment shader
+ * @param prelude GLSL source to insert into both stages
+ * 
+ * @throws VertexShaderCompilationException if failed to compile vertex shader
+ * @throws FragmentShaderCompilationException if failed to compile fragment shader
+ * @throws ShaderProgramLinkingException if failed to link shader program
+ * @throws ShaderPreprocessor::PreprocessingException if a source or one of its includes could not be read
+ */
+Shader::Shader(const std::string &vertPath, const std::string &fragPath, const std::string &prelude) : Shader { begin(vertPath, fragPath, prelude) }
+{
+}
+
+/**
+ * @brief Constructor for a Shader finishing a build started with begin()
+ * 
+ * Statuses are only queried here, after compiling and linking have been issued, so the driver never has to
+ * finish a stage before the next one is submitted.
+ * 
+ * @param build The started build, its shaders are deleted and on failure its program as well
+ * 
+ * @throws VertexShaderCompilationException if failed to compile vertex shader
+ * @throws FragmentShaderCompilationException if failed to compile fragment shader
+ * @throws ShaderProgramLinkingException if failed to link shader program
+ */
+Shader::Shader(Build &&build) : _program { std::make_shared<Program>() }
+{
+	_program->id = build.program;
+	_program->vertPath = build.vertPath;
+	_program->fragPath = build.fragPath;
+	_program->prelude = build.prelude;
+	if (!build.loaded)
 	{
-		glGetShaderInfoLog(fragShader, 512, nullptr, infoLog);
-		std::stringstream error {};
-		error << "Fragment Shader compilation failed: " << infoLog << std::endl;
-		throw FragmentShaderCompilationException(error.str());
+		GLint success {};
+		glGetProgramiv(_program->id, GL_LINK_STATUS, &success);
+		if (!success)
+		{
+			char infoLog[512] {};
+			glGetProgramInfoLog(_program->id, 512, nullptr, infoLog);
+			try
+			{
+				throwStageError(GL_VERTEX_SHADER, build.vertShader);
+				throwStageError(GL_FRAGMENT_SHADER, build.fragShader);
+			}
+			catch (...)
+			{
+				cancel(build);
+				throw;
+			}
+			cancel(build);
+			std::stringstream error {};
+			error << "Failed to link Shader Program: " << infoLog << std::endl;
+			throw ShaderProgramLinkingException(error.str());
+		}
+		spdlog::debug("Linked Shader Program");
+
+		glDetachShader(_program->id, build.vertShader);
+		glDetachShader(_program->id, build.fragShader);
+		glDeleteShader(build.vertShader);
+		glDeleteShader(build.fragShader);
+		if (build.cached)
+			ProgramCache::shared().store(build.key, _program->id);
 	}
-	spdlog::debug("Compiled Fragment Shader");
 
-	glAttachShader(_id, vertShader);
-	glAttachShader(_id, fragShader);
-	glLinkProgram(_id);
+	UniformBlocks::bind(_program->id);
+	_program->reflection = ShaderReflection { _program->id };
+	resolveUniforms();
+}
 
-	glGetProgramiv(_id, GL_LINK_STATUS, &success);
-	if (!success)
+/**
+ * @brief Sets shader program as active using glUseProgram
+ */
+void Shader::useProgram()
+{
+	glUseProgram(_program->id);
+}
+
+/**
+ * @brief Rebuilds the program from its files and replaces it if the new version links
+ * 
+ * All copies of the Shader use the new program afterwards. Uniform handles stay valid, but uniforms have to be
+ * set again. If the new version fails to compile or link, the error is logged and the old program is kept.
+ * 
+ * @returns True if the program was replaced
+ */
+bool Shader::reload()
+{
+	try
 	{
-		glGetProgramInfoLog(_id, 512, nullptr, infoLog);
-		std::stringstream error {};
-		error << "Failed to link Shader Program: " << infoLog << std::endl;
-		throw ShaderProgramLinkingException(error.str());
+		Shader rebuilt { begin(_program->vertPath, _program->fragPath, _program->prelude) };
+		adopt(rebuilt);
+	}
+	catch (const std::runtime_error &e)
+	{
+		spdlog::error("Failed to reload {} and {}: {}", _program->vertPath, _program->fragPath, e.what());
+		return false;
 	}
-	spdlog::debug("Linked Shader Program");
+	return true;
+}
 
-	glDeleteShader(vertShader);
-	glDeleteShader(fragShader);
+/**
+ * @brief Gets the path of the vertex shader
+ * 
+ * @returns The path the Shader was created from
+ */
+std::string Shader::getVertPath()
+{
+	return _program->vertPath;
 }
 
+/**
+ * @brief Gets the path of the fragment shader
+ * 
+ * @returns The path the Shader was created from
+ */
+std::string Shader::getFragPath()
+{
+	return _program->fragPath;
+}
 
 /**
- * @brief Sets shader program as active using glUseProgram
+ * @brief Gets the active attributes, uniforms and uniform blocks of the program
+ * 
+ * @returns The reflection, replaced when the program is reloaded
  */
-void Shader::useProgram()
+ShaderReflection &Shader::getReflection()
 {
-	glUseProgram(_id);
+	return _program->reflection;
 }
 
 /**
- * @brief Sets GLint uniform
+ * @brief Looks up a uniform by name
+ * 
+ * Elements of arrays are found by their full name ("lights[2]"), the array itself by its name with or without
+ * the "[0]" suffix.
  * 
  * @param name Uniform name
+ * 
+ * @returns A handle to pass to setUniform(), invalid if the program has no such active uniform
+ */
+Shader::Uniform Shader::getUniform(const std::string &name)
+{
+	return getUniform(hashName(name.c_str()));
+}
+
+/**
+ * @brief Looks up a uniform by the hash of its name, see hashName()
+ * 
+ * @param nameHash Hash of the uniform name
+ * 
+ * @returns A handle to pass to setUniform(), invalid if the program has no such active uniform
+ */
+Shader::Uniform Shader::getUniform(std::uint64_t nameHash)
+{
+	Uniform uniform {};
+	uniform._index = indexOf(nameHash);
+	uniform._nameHash = nameHash;
+	uniform._generation = _program->generation;
+	return uniform;
+}
+
+/**
+ * @brief Sets GLint uniform, the program must be in use
+ * 
+ * @param uniform Handle from getUniform()
  * @param val The GLint value the uniform should be set to
  */
-void Shader::setUniform(std::string name, GLint val)
+void Shader::setUniform(Uniform uniform, GLint val)
+{
+	const GLint location { update(uniform, &val, sizeof(val)) };
+	if (location >= 0)
+		glUniform1i(location, val);
+}
+
+/**
+ * @brief Sets float uniform, the program must be in use
+ * 
+ * @param uniform Handle from getUniform()
+ * @param val The float the uniform should be set to
+ */
+void Shader::setUniform(Uniform uniform, GLfloat val)
 {
-	glUniform1i(glGetUniformLocation(_id, name.c_str()), val);
+	const GLint location { update(uniform, &val, sizeof(val)) };
+	if (location >= 0)
+		glUniform1f(location, val);
 }
 
 /**
- * @brief Sets mat4 uniform
+ * @brief Sets vec2 uniform, the program must be in use
+ * 
+ * @param uniform Handle from getUniform()
+ * @param val The vec2 the uniform should be set to
+ */
+void Shader::setUniform(Uniform uniform, const glm::vec2 &val)
+{
+	const GLint location { update(uniform, glm::value_ptr(val), sizeof(val)) };
+	if (location >= 0)
+		glUniform2fv(location, 1, glm::value_ptr(val));
+}
+
+/**
+ * @brief Sets vec3 uniform, the program must be in use
+ * 
+ * @param uniform Handle from getUniform()
+ * @param val The vec3 the uniform should be set to
+ */
+void Shader::setUniform(Uniform uniform, const glm::vec3 &val)
+{
+	const GLint location { update(uniform, glm::value_ptr(val), sizeof(val)) };
+	if (location >= 0)
+		glUniform3fv(location, 1, glm::value_ptr(val));
+}
+
+/**
+ * @brief Sets vec4 uniform, the program must be in use
+ * 
+ * @param uniform Handle from getUniform()
+ * @param val The vec4 the uniform should be set to
+ */
+void Shader::setUniform(Uniform uniform, const glm::vec4 &val)
+{
+	const GLint location { update(uniform, glm::value_ptr(val), sizeof(val)) };
+	if (location >= 0)
+		glUniform4fv(location, 1, glm::value_ptr(val));
+}
+
+/**
+ * @brief Sets mat4 uniform, the program must be in use
+ * 
+ * @param uniform Handle from getUniform()
+ * @param val The mat4 the uniform should be set to
+ */
+void Shader::setUniform(Uniform uniform, const glm::mat4 &val)
+{
+	const GLint location { update(uniform, glm::value_ptr(val), sizeof(val)) };
+	if (location >= 0)
+		glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(val));
+}
+
+/**
+ * @brief Sets GLint uniform by name, the program must be in use
+ * 
+ * @param name Uniform name
+ * @param val The GLint value the uniform should be set to
+ */
+void Shader::setUniform(const std::string &name, GLint val)
+{
+	setUniform(getUniform(name), val);
+}
+
+/**
+ * @brief Sets vec4 uniform by name, the program must be in use
+ * 
+ * @param name Uniform name
+ * @param val The vec4 the uniform should be set to
+ */
+void Shader::setUniform(const std::string &name, const glm::vec4 &val)
+{
+	setUniform(getUniform(name), val);
+}
+
+/**
+ * @brief Sets mat4 uniform by name, the program must be in use
  * 
  * @param name Uniform name
  * @param val The mat4 the uniform should be set to
  */
-void Shader::setUniform(std::string name, glm::mat4 &val)
+void Shader::setUniform(const std::string &name, const glm::mat4 &val)
+{
+	setUniform(getUniform(name), val);
+}
+
+
+/**
+ * @brief Builds the uniform table from the reflected uniforms of the linked program
+ * 
+ * Members of uniform blocks have no location and are left out.
+ */
+void Shader::resolveUniforms()
+{
+	_program->uniforms = UniformTable {};
+	std::vector<std::pair<std::uint64_t, int>> &names { _program->uniforms.names };
+	std::vector<UniformSlot> &slots { _program->uniforms.slots };
+
+	for (const ShaderReflection::Uniform &uniform : _program->reflection.getUniforms())
+	{
+		const std::string &name { uniform.name };
+		const GLint location { uniform.location };
+		if (location < 0)
+			continue;
+
+		names.emplace_back(hashName(name.c_str()), static_cast<int>(slots.size()));
+		slots.push_back({ location, false, {} });
+
+		// Arrays are reported as "name[0]", the plain name refers to the same element
+		const std::size_t suffix { name.size() > 3 ? name.size() - 3 : 0 };
+		if (suffix == 0 || name.compare(suffix, 3, "[0]") != 0)
+			continue;
+		const std::string base { name.substr(0, suffix) };
+		names.emplace_back(hashName(base.c_str()), static_cast<int>(slots.size() - 1));
+		for (GLint element = 1; element < uniform.size; element++)
+		{
+			const std::string elementName { base + "[" + std::to_string(element) + "]" };
+			names.emplace_back(hashName(elementName.c_str()), static_cast<int>(slots.size()));
+			slots.push_back({ glGetUniformLocation(_program->id, elementName.c_str()), false, {} });
+		}
+	}
+
+	std::sort(names.begin(), names.end());
+	spdlog::debug("Resolved {} uniform locations", slots.size());
+}
+
+/**
+ * @brief Finds a uniform in the table
+ * 
+ * @param nameHash Hash of the uniform name
+ * 
+ * @returns The slot index, or -1 if the program has no such active uniform
+ */
+int Shader::indexOf(std::uint64_t nameHash)
+{
+	const std::vector<std::pair<std::uint64_t, int>> &names { _program->uniforms.names };
+	auto it { std::lower_bound(names.begin(), names.end(), nameHash, [](const std::pair<std::uint64_t, int> &name, std::uint64_t hash)
+	{
+		return name.first < hash;
+	}) };
+	if (it != names.end() && it->first == nameHash)
+		return it->second;
+	return -1;
+}
+
+/**
+ * @brief Remembers the value a uniform is set to
+ * 
+ * Handles resolved before a reload are looked up again by their name hash.
+ * 
+ * @param uniform Handle from getUniform()
+ * @param value Pointer to the new value
+ * @param size Size of the value in bytes
+ * 
+ * @returns The location to upload the value to, or -1 if the handle is invalid or the uniform already has the value
+ */
+GLint Shader::update(Uniform uniform, const void *value, std::size_t size)
+{
+	const int index { uniform._generation == _program->generation ? uniform._index : indexOf(uniform._nameHash) };
+	if (index < 0 || static_cast<std::size_t>(index) >= _program->uniforms.slots.size())
+		return -1;
+
+	UniformSlot &slot { _program->uniforms.slots[static_cast<std::size_t>(index)] };
+	if (slot.uploaded && std::memcmp(slot.value.data(), value, size) == 0)
+		return -1;
+
+	std::memcpy(slot.value.data(), value, size);
+	slot.uploaded = true;
+	return slot.location;
+}
+
+/**
+ * @brief Starts building a program without waiting for the driver
+ * 
+ * Expands the sources with the shared ShaderPreprocessor, then loads the program from the shared ProgramCache if
+ * possible, otherwise issues compiling both stages and linking them without querying any status. The build is
+ * finished by the Shader constructor taking it.
+ * 
+ * @param vertPath The path to a vertex shader
+ * @param fragPath The path to a fragment shader
+ * @param prelude GLSL source to insert into both stages, may be empty
+ * 
+ * @returns The started build
+ * 
+ * @throws ShaderPreprocessor::PreprocessingException if a source or one of its includes could not be read
+ */
+Shader::Build Shader::begin(const std::string &vertPath, const std::string &fragPath, const std::string &prelude)
+{
+	ShaderPreprocessor &preprocessor { ShaderPreprocessor::shared() };
+	const std::string vertSource { preprocessor.process(vertPath, prelude) };
+	const std::string fragSource { preprocessor.process(fragPath, prelude) };
+
+	Build build {};
+	build.vertPath = vertPath;
+	build.fragPath = fragPath;
+	build.prelude = prelude;
+	build.program = glCreateProgram();
+	ProgramCache &cache { ProgramCache::shared() };
+	build.cached = cache.isEnabled() && ProgramCache::isSupported();
+	if (build.cached)
+	{
+		build.key = ProgramCache::keyOf({ vertSource, fragSource });
+		build.loaded = cache.load(build.key, build.program);
+		if (build.loaded)
+			return build;
+	}
+
+	build.vertShader = compileStage(GL_VERTEX_SHADER, vertSource);
+	build.fragShader = compileStage(GL_FRAGMENT_SHADER, fragSource);
+	glAttachShader(build.program, build.vertShader);
+	glAttachShader(build.program, build.fragShader);
+	if (build.cached)
+		glProgramParameteri(build.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	glLinkProgram(build.program);
+	return build;
+}
+
+/**
+ * @brief Deletes the objects of a build that will not be finished
+ * 
+ * @param build The started build
+ */
+void Shader::cancel(Build &build)
 {
-	glUniformMatrix4fv(glGetUniformLocation(_id, name.c_str()), 1, GL_FALSE, glm::value_ptr(val));
+	if (build.vertShader)
+		glDeleteShader(build.vertShader);
+	if (build.fragShader)
+		glDeleteShader(build.fragShader);
+	glDeleteProgram(build.program);
+	build = Build {};
 }
+
+/**
+ * @brief Replaces the program of this Shader and its copies with a rebuilt one
+ * 
+ * The old program is deleted, the rebuilt Shader is left without a program.
+ * 
+ * @param rebuilt A Shader built from the same files
+ */
+void Shader::adopt(Shader &rebuilt)
+{
+	// Vertex arrays keep the old locations, inputs the linker placed differently this time would read wrong data
+	for (const ShaderReflection::Attribute &input : rebuilt._program->reflection.getAttributes())
+	{
+		const ShaderReflection::Attribute *previous { _program->reflection.findAttribute(input.name) };
+		if (previous && input.location >= 0 && previous->location != input.location)
+			spdlog::warn("Input {} of {} moved from location {} to {}, give it a layout(location) qualifier", input.name, _program->vertPath, previous->location, input.location);
+	}
+	glDeleteProgram(_program->id);
+	_program->id = rebuilt._program->id;
+	_program->reflection = std::move(rebuilt._program->reflection);
+	_program->uniforms = std::move(rebuilt._program->uniforms);
+	_program->generation++;
+	rebuilt._program->id = 0;
+	spdlog::debug("Reloaded {} and {}", _program->vertPath, _program->fragPath);
+}
\ No newline at end of file
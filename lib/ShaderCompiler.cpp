@@ -0,0 +1,139 @@
+#include "ShaderCompiler.hpp"
+#include "GLExtensions.hpp"
+#include <utility>
+#include <spdlog/spdlog.h>
+
+namespace
+{
+	// KHR_parallel_shader_compile and ARB_parallel_shader_compile share their enums, glad is generated without them
+	constexpr GLenum completionStatus { 0x91B1 };
+	constexpr GLuint driverChoosesThreads { 0xFFFFFFFF };
+
+	typedef void (APIENTRYP MaxShaderCompilerThreadsProc)(GLuint count);
+}
+
+/**
+ * @brief Destructor for ShaderCompiler, deletes the programs of unfinished jobs while a context is still current
+ */
+ShaderCompiler::~ShaderCompiler()
+{
+	if (!glfwGetCurrentContext())
+		return;
+
+	for (std::pair<const Job, Shader::Build> &job : _jobs)
+		Shader::cancel(job.second);
+}
+
+/**
+ * @brief Starts compiling and linking a program
+ * 
+ * Programs found in the shared ProgramCache are ready right away.
+ * 
+ * @param vertPath The path to a vertex shader
+ * @param fragPath The path to a fragment shader
+ * @param prelude GLSL source to insert after the #version line of both stages. Defaults to none
+ * 
+ * @returns The job to poll and finish
+ */
+ShaderCompiler::Job ShaderCompiler::submit(const std::string &vertPath, const std::string &fragPath, const std::string &prelude)
+{
+	isParallel();
+	const Job job { _next++ };
+	_jobs.emplace(job, Shader::begin(vertPath, fragPath, prelude));
+	return job;
+}
+
+/**
+ * @brief Checks without blocking whether a job can be finished without waiting for the driver
+ * 
+ * @param job A submitted, unfinished job
+ * 
+ * @returns True if the program is done compiling and linking, successfully or not. Always true without
+ * parallel compilation support
+ */
+bool ShaderCompiler::isReady(Job job)
+{
+	const Shader::Build &build { _jobs.at(job) };
+	if (build.loaded || !isParallel())
+		return true;
+
+	GLint done {};
+	glGetProgramiv(build.program, completionStatus, &done);
+	return done == GL_TRUE;
+}
+
+/**
+ * @brief Finishes a job, blocking if the driver is still working on it
+ * 
+ * @param job A submitted, unfinished job, it is finished afterwards even if an exception is thrown
+ * 
+ * @returns The Shader
+ * 
+ * @throws Shader::VertexShaderCompilationException if failed to compile vertex shader
+ * @throws Shader::FragmentShaderCompilationException if failed to compile fragment shader
+ * @throws Shader::ShaderProgramLinkingException if failed to link shader program
+ * @throws std::out_of_range if the job is unknown
+ */
+Shader ShaderCompiler::finish(Job job)
+{
+	Shader::Build build { _jobs.at(job) };
+	_jobs.erase(job);
+	return Shader { std::move(build) };
+}
+
+/**
+ * @brief Abandons a job and deletes its program
+ * 
+ * @param job A submitted job, unknown jobs are ignored
+ */
+void ShaderCompiler::cancel(Job job)
+{
+	auto it { _jobs.find(job) };
+	if (it == _jobs.end())
+		return;
+
+	Shader::cancel(it->second);
+	_jobs.erase(it);
+}
+
+/**
+ * @brief Gets the number of submitted, unfinished jobs
+ * 
+ * @returns The job count
+ */
+std::size_t ShaderCompiler::getPendingCount()
+{
+	return _jobs.size();
+}
+
+/**
+ * @brief Checks whether the driver compiles in the background and completion can be polled
+ * 
+ * Lets the driver pick the number of compiler threads the first time it is called. Requires a current context
+ * with glad loaded.
+ * 
+ * @returns True if KHR_parallel_shader_compile or ARB_parallel_shader_compile is supported
+ */
+bool ShaderCompiler::isParallel()
+{
+	static const bool parallel {
+		[]()
+		{
+			const char *function { nullptr };
+			if (hasGLExtension("GL_KHR_parallel_shader_compile"))
+				function = "glMaxShaderCompilerThreadsKHR";
+			else if (hasGLExtension("GL_ARB_parallel_shader_compile"))
+				function = "glMaxShaderCompilerThreadsARB";
+			if (!function)
+				return false;
+
+			MaxShaderCompilerThreadsProc maxShaderCompilerThreads { reinterpret_cast<MaxShaderCompilerThreadsProc>(glfwGetProcAddress(function)) };
+			if (maxShaderCompilerThreads)
+				maxShaderCompilerThreads(driverChoosesThreads);
+			spdlog::debug("Compiling shaders in parallel with {}", function);
+			return true;
+		}()
+	};
+
+	return parallel;
+}
\ No newline at end of file
@@ -0,0 +1,349 @@
+#include "ShaderPreprocessor.hpp"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+#include <spdlog/spdlog.h>
+
+namespace
+{
+	bool stat(const std::string &path, std::int64_t &modified, std::int64_t &size)
+	{
+		struct stat info {};
+		if (::stat(path.c_str(), &info) != 0)
+			return false;
+#ifdef __linux__
+		// Saves within the same second must not look unchanged
+		modified = static_cast<std::int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+#else
+		modified = static_cast<std::int64_t>(info.st_mtime);
+#endif
+		size = static_cast<std::int64_t>(info.st_size);
+		return true;
+	}
+
+	std::string directoryOf(const std::string &path)
+	{
+		const std::size_t slash { path.find_last_of("/\\") };
+		return slash == std::string::npos ? std::string {} : path.substr(0, slash + 1);
+	}
+
+	bool exists(const std::string &path)
+	{
+		std::int64_t modified {}, size {};
+		return stat(path, modified, size);
+	}
+
+	// Splits a line into the directive name and the rest, empty if the line is no directive
+	std::string directiveOf(const std::string &line, std::string &rest)
+	{
+		std::size_t i { line.find_first_not_of(" \t") };
+		if (i == std::string::npos || line[i] != '#')
+			return std::string {};
+		i = line.find_first_not_of(" \t", i + 1);
+		if (i == std::string::npos)
+			return std::string {};
+		const std::size_t end { std::min(line.find_first_of(" \t", i), line.size()) };
+		const std::size_t restBegin { std::min(line.find_first_not_of(" \t", end), line.size()) };
+		rest = line.substr(restBegin);
+		while (!rest.empty() && (rest.back() == '\r' || rest.back() == ' ' || rest.back() == '\t'))
+			rest.pop_back();
+		return line.substr(i, end - i);
+	}
+
+	/**
+	 * Finds the guard of a file: #pragma once anywhere, or an #ifndef NAME immediately followed by #define NAME
+	 * as the first directives, ignoring blank and comment lines.
+	 */
+	std::string guardOf(const std::string &path, const std::string &text)
+	{
+		std::istringstream lines { text };
+		std::string line {}, rest {}, ifndef {};
+		bool first { true };
+		while (std::getline(lines, line))
+		{
+			const std::string directive { directiveOf(line, rest) };
+			if (directive == "pragma" && rest == "once")
+				return path;
+			if (!first)
+				continue;
+
+			const std::size_t content { line.find_first_not_of(" \t\r") };
+			if (directive.empty() && (content == std::string::npos || line.compare(content, 2, "//") == 0))
+				continue;
+			if (ifndef.empty() && directive == "ifndef")
+			{
+				ifndef = rest;
+				continue;
+			}
+			if (!ifndef.empty() && directive == "define" && rest.substr(0, rest.find_first_of(" \t")) == ifndef)
+				return ifndef;
+			first = false;
+		}
+		return std::string {};
+	}
+}
+
+/**
+ * @brief Adds a directory searched for included files not found next to the including file
+ * 
+ * @param directory The directory
+ */
+void ShaderPreprocessor::addIncludeDirectory(const std::string &directory)
+{
+	std::string path { directory };
+	if (!path.empty() && path.back() != '/' && path.back() != '\\')
+		path += '/';
+	_includeDirectories.push_back(path);
+	_expansions.clear();
+}
+
+/**
+ * @brief Expands the includes of a shader and injects a prelude after its #version line
+ * 
+ * @param path Path of the shader file
+ * @param prelude GLSL source to inject, e.g. #defines of a variant. Defaults to none
+ * 
+ * @returns The source to compile
+ * 
+ * @throws PreprocessingException if a file could not be read, an include was not found or includes are circular
+ */
+std::string ShaderPreprocessor::process(const std::string &path, const std::string &prelude)
+{
+	auto it { _expansions.find(path) };
+	if (it == _expansions.end() || !isCurrent(it->second))
+	{
+		Expansion expansion {};
+		std::vector<std::string> stack {};
+		std::unordered_set<std::string> guards {};
+		expand(path, expansion, stack, guards);
+		spdlog::debug("Expanded {} ({} files)", path, expansion.files.size());
+		Expansion &cached { _expansions[path] };
+		cached = std::move(expansion);
+		return inject(cached.text, prelude);
+	}
+	return inject(it->second.text, prelude);
+}
+
+/**
+ * @brief Gets the files a shader consists of
+ * 
+ * @param path Path of the shader file
+ * 
+ * @returns The shader and every file it includes, in the order of their source string numbers. Empty if the
+ * shader was not processed yet
+ */
+std::vector<std::string> ShaderPreprocessor::getDependencies(const std::string &path)
+{
+	std::vector<std::string> dependencies {};
+	auto it { _expansions.find(path) };
+	if (it != _expansions.end())
+	{
+		for (const Dependency &file : it->second.files)
+			dependencies.push_back(file.path);
+	}
+	return dependencies;
+}
+
+/**
+ * @brief Forgets all cached files and expansions
+ */
+void ShaderPreprocessor::clear()
+{
+	_files.clear();
+	_expansions.clear();
+}
+
+/**
+ * @brief Inserts text after the #version line, which has to stay first
+ * 
+ * A #line directive keeps the line numbers in compile errors pointing at the file.
+ * 
+ * @param source A GLSL source
+ * @param prelude The text to insert, may be empty
+ * 
+ * @returns The source with the prelude
+ */
+std::string ShaderPreprocessor::inject(const std::string &source, const std::string &prelude)
+{
+	if (prelude.empty())
+		return source;
+
+	const std::size_t version { source.find("#version") };
+	if (version == std::string::npos)
+		return prelude + "#line 1\n" + source;
+
+	const std::size_t lineEnd { source.find('\n', version) };
+	if (lineEnd == std::string::npos)
+		return source + "\n" + prelude;
+	const std::size_t line { static_cast<std::size_t>(std::count(source.begin(), source.begin() + lineEnd, '\n')) + 2 };
+	return source.substr(0, lineEnd + 1) + prelude + "#line " + std::to_string(line) + "\n" + source.substr(lineEnd + 1);
+}
+
+/**
+ * @brief Gets the preprocessor used by Shader
+ * 
+ * @returns The shared ShaderPreprocessor
+ */
+ShaderPreprocessor &ShaderPreprocessor::shared()
+{
+	static ShaderPreprocessor preprocessor {};
+	return preprocessor;
+}
+
+/**
+ * @brief Reads a file, or reuses it if it didn't change since it was last read
+ * 
+ * @param path Path of the file
+ * 
+ * @returns The cached file
+ * 
+ * @throws PreprocessingException if the file could not be read
+ */
+ShaderPreprocessor::File &ShaderPreprocessor::load(const std::string &path)
+{
+	std::int64_t modified {}, size {};
+	if (!stat(path, modified, size))
+	{
+		std::stringstream error {};
+		error << "Failed to read shader source " << path << std::endl;
+		throw PreprocessingException(error.str());
+	}
+
+	File &file { _files[path] };
+	if (file.modified == modified && file.size == size && !file.text.empty())
+		return file;
+
+	std::ifstream is { path, std::ios::binary };
+	std::stringstream ss {};
+	ss << is.rdbuf();
+	file.modified = modified;
+	file.size = size;
+	file.text = ss.str();
+	file.guard = guardOf(path, file.text);
+	return file;
+}
+
+/**
+ * @brief Checks whether none of the files of an expansion changed since the expansion was built
+ * 
+ * Compares against the times recorded in the expansion rather than the file cache, which another expansion
+ * sharing an include may already have refreshed.
+ * 
+ * @param expansion A cached expansion
+ * 
+ * @returns True if the expansion can be reused
+ */
+bool ShaderPreprocessor::isCurrent(const Expansion &expansion)
+{
+	for (const Dependency &file : expansion.files)
+	{
+		std::int64_t modified {}, size {};
+		if (!stat(file.path, modified, size) || file.modified != modified || file.size != size)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Finds the source string number of a file in an expansion
+ * 
+ * @param expansion The expansion
+ * @param path Path of the file
+ * 
+ * @returns The number, or the number of files if the file is not part of the expansion yet
+ */
+std::size_t ShaderPreprocessor::sourceNumberOf(const Expansion &expansion, const std::string &path)
+{
+	auto it { std::find_if(expansion.files.begin(), expansion.files.end(), [&path](const Dependency &file) { return file.path == path; }) };
+	return static_cast<std::size_t>(it - expansion.files.begin());
+}
+
+/**
+ * @brief Appends a file to an expansion, replacing its #include lines by the included files
+ * 
+ * @param path Path of the file
+ * @param expansion The expansion to append to
+ * @param stack The files currently being expanded, to detect circular includes
+ * @param guards Guards of the files already expanded
+ * 
+ * @throws PreprocessingException if a file could not be read, an include was not found or includes are circular
+ */
+void ShaderPreprocessor::expand(const std::string &path, Expansion &expansion, std::vector<std::string> &stack, std::unordered_set<std::string> &guards)
+{
+	if (std::find(stack.begin(), stack.end(), path) != stack.end())
+	{
+		std::stringstream error {};
+		error << "Circular include of " << path << " in " << stack.front() << std::endl;
+		throw PreprocessingException(error.str());
+	}
+
+	// Copied, loading an included file may rehash _files
+	const File file { load(path) };
+	if (!file.guard.empty() && !guards.insert(file.guard).second)
+		return;
+
+	const std::size_t sourceNumber { sourceNumberOf(expansion, path) };
+	if (sourceNumber == expansion.files.size())
+		expansion.files.push_back({ path, file.modified, file.size });
+
+	stack.push_back(path);
+	std::istringstream lines { file.text };
+	std::string line {}, rest {};
+	std::size_t lineNumber { 0 };
+	while (std::getline(lines, line))
+	{
+		lineNumber++;
+		const std::string directive { directiveOf(line, rest) };
+		if (directive == "pragma" && rest == "once")
+		{
+			expansion.text += "\n";
+			continue;
+		}
+		if (directive != "include")
+		{
+			expansion.text += line;
+			expansion.text += "\n";
+			continue;
+		}
+
+		if (rest.size() < 2 || rest.front() != '"' || rest.back() != '"')
+		{
+			std::stringstream error {};
+			error << "Malformed #include in " << path << " line " << lineNumber << std::endl;
+			throw PreprocessingException(error.str());
+		}
+		const std::string included { resolve(path, rest.substr(1, rest.size() - 2)) };
+		const std::size_t includedNumber { sourceNumberOf(expansion, included) };
+		expansion.text += "#line 1 " + std::to_string(includedNumber) + "\n";
+		expand(included, expansion, stack, guards);
+		expansion.text += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(sourceNumber) + "\n";
+	}
+	stack.pop_back();
+}
+
+/**
+ * @brief Finds an included file
+ * 
+ * @param includingPath Path of the file containing the #include
+ * @param name The name in the #include
+ * 
+ * @returns The path of the included file
+ * 
+ * @throws PreprocessingException if the file exists neither next to the including file nor in an include directory
+ */
+std::string ShaderPreprocessor::resolve(const std::string &includingPath, const std::string &name)
+{
+	const std::string relative { directoryOf(includingPath) + name };
+	if (exists(relative))
+		return relative;
+	for (const std::string &directory : _includeDirectories)
+	{
+		if (exists(directory + name))
+			return directory + name;
+	}
+
+	std::stringstream error {};
+	error << "Included file " << name << " not found from " << includingPath << std::endl;
+	throw PreprocessingException(error.str());
+}
\ No newline at end of file
@@ -0,0 +1,358 @@
+#include "ShaderReflection.hpp"
+#include <algorithm>
+#include <sstream>
+#include <spdlog/spdlog.h>
+
+namespace
+{
+	bool isIntegerData(GLenum type)
+	{
+		switch (type)
+		{
+			case GL_BYTE:
+			case GL_UNSIGNED_BYTE:
+			case GL_SHORT:
+			case GL_UNSIGNED_SHORT:
+			case GL_INT:
+			case GL_UNSIGNED_INT:
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	std::size_t sizeOfData(GLenum type)
+	{
+		switch (type)
+		{
+			case GL_BYTE:
+			case GL_UNSIGNED_BYTE:
+				return 1;
+			case GL_SHORT:
+			case GL_UNSIGNED_SHORT:
+			case GL_HALF_FLOAT:
+				return 2;
+			default:
+				return 4;
+		}
+	}
+
+	const VertexLayout::Attribute *find(const VertexLayout &layout, const std::string &name)
+	{
+		auto it { std::find_if(layout.attributes.begin(), layout.attributes.end(), [&name](const VertexLayout::Attribute &attribute)
+		{
+			return attribute.name == name;
+		}) };
+		return it == layout.attributes.end() ? nullptr : &*it;
+	}
+}
+
+/**
+ * @brief Constructor for ShaderReflection querying a linked program
+ * 
+ * @param program A linked program
+ */
+ShaderReflection::ShaderReflection(GLuint program)
+{
+	GLint count {}, maxLength {};
+	glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &count);
+	glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+	std::vector<char> buffer(static_cast<std::size_t>(std::max(maxLength, 1)));
+	for (GLint i = 0; i < count; i++)
+	{
+		GLsizei length {};
+		Attribute attribute {};
+		glGetActiveAttrib(program, static_cast<GLuint>(i), static_cast<GLsizei>(buffer.size()), &length, &attribute.size, &attribute.type, buffer.data());
+		attribute.name.assign(buffer.data(), static_cast<std::size_t>(length));
+		attribute.location = glGetAttribLocation(program, attribute.name.c_str());
+		_attributes.push_back(attribute);
+	}
+
+	glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+	glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength);
+	buffer.resize(static_cast<std::size_t>(std::max(maxLength, 1)));
+	for (GLint i = 0; i < count; i++)
+	{
+		GLsizei length {};
+		UniformBlock block {};
+		block.index = static_cast<GLuint>(i);
+		glGetActiveUniformBlockName(program, block.index, static_cast<GLsizei>(buffer.size()), &length, buffer.data());
+		block.name.assign(buffer.data(), static_cast<std::size_t>(length));
+		glGetActiveUniformBlockiv(program, block.index, GL_UNIFORM_BLOCK_DATA_SIZE, &block.dataSize);
+		glGetActiveUniformBlockiv(program, block.index, GL_UNIFORM_BLOCK_BINDING, &block.binding);
+		_blocks.push_back(block);
+	}
+
+	glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+	glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+	buffer.resize(static_cast<std::size_t>(std::max(maxLength, 1)));
+	std::vector<GLuint> indices(static_cast<std::size_t>(count));
+	std::vector<GLint> blocks(indices.size()), offsets(indices.size());
+	for (GLint i = 0; i < count; i++)
+		indices[static_cast<std::size_t>(i)] = static_cast<GLuint>(i);
+	if (count > 0)
+	{
+		glGetActiveUniformsiv(program, count, indices.data(), GL_UNIFORM_BLOCK_INDEX, blocks.data());
+		glGetActiveUniformsiv(program, count, indices.data(), GL_UNIFORM_OFFSET, offsets.data());
+	}
+	for (GLint i = 0; i < count; i++)
+	{
+		GLsizei length {};
+		Uniform uniform {};
+		glGetActiveUniform(program, static_cast<GLuint>(i), static_cast<GLsizei>(buffer.size()), &length, &uniform.size, &uniform.type, buffer.data());
+		uniform.name.assign(buffer.data(), static_cast<std::size_t>(length));
+		uniform.block = blocks[static_cast<std::size_t>(i)];
+		uniform.offset = offsets[static_cast<std::size_t>(i)];
+		if (uniform.block < 0)
+			uniform.location = glGetUniformLocation(program, uniform.name.c_str());
+		_uniforms.push_back(uniform);
+	}
+
+	spdlog::debug("Reflected {} attributes, {} uniforms and {} uniform blocks", _attributes.size(), _uniforms.size(), _blocks.size());
+}
+
+/**
+ * @brief Constructor for ShaderReflection from tables, e.g. to validate layouts without a context
+ * 
+ * @param attributes The active attributes
+ * @param uniforms The active uniforms
+ * @param blocks The active uniform blocks
+ */
+ShaderReflection::ShaderReflection(const std::vector<Attribute> &attributes, const std::vector<Uniform> &uniforms, const std::vector<UniformBlock> &blocks) : _attributes { attributes }, _uniforms { uniforms }, _blocks { blocks }
+{
+}
+
+/**
+ * @brief Gets the active vertex attributes
+ * 
+ * @returns The attributes, including built-in ones like gl_VertexID which have location -1
+ */
+std::vector<ShaderReflection::Attribute> &ShaderReflection::getAttributes()
+{
+	return _attributes;
+}
+
+/**
+ * @brief Gets the active uniforms
+ * 
+ * @returns The uniforms, plain ones and members of uniform blocks
+ */
+std::vector<ShaderReflection::Uniform> &ShaderReflection::getUniforms()
+{
+	return _uniforms;
+}
+
+/**
+ * @brief Gets the active uniform blocks
+ * 
+ * @returns The uniform blocks
+ */
+std::vector<ShaderReflection::UniformBlock> &ShaderReflection::getUniformBlocks()
+{
+	return _blocks;
+}
+
+/**
+ * @brief Looks up an active attribute
+ * 
+ * @param name Attribute name
+ * 
+ * @returns The attribute, or nullptr if the program has no such active attribute
+ */
+ShaderReflection::Attribute *ShaderReflection::findAttribute(const std::string &name)
+{
+	auto it { std::find_if(_attributes.begin(), _attributes.end(), [&name](const Attribute &attribute) { return attribute.name == name; }) };
+	return it == _attributes.end() ? nullptr : &*it;
+}
+
+/**
+ * @brief Looks up an active uniform block
+ * 
+ * @param name Block name
+ * 
+ * @returns The block, or nullptr if the program has no such active block
+ */
+ShaderReflection::UniformBlock *ShaderReflection::findUniformBlock(const std::string &name)
+{
+	auto it { std::find_if(_blocks.begin(), _blocks.end(), [&name](const UniformBlock &block) { return block.name == name; }) };
+	return it == _blocks.end() ? nullptr : &*it;
+}
+
+/**
+ * @brief Checks whether a vertex layout feeds every input of the program
+ * 
+ * An input without a matching attribute, an integer input fed normalized or floating point data, a component
+ * count outside 1 to 4 and double inputs are errors. So are matrix and array inputs with a stride of 0, which
+ * OpenGL would take as tightly packed per column rather than per vertex. Attributes the program doesn't use are
+ * fine.
+ * 
+ * @param layout The mesh's vertex layout
+ * 
+ * @returns One message per problem, empty if the layout fits the program
+ */
+std::vector<std::string> ShaderReflection::validate(const VertexLayout &layout)
+{
+	std::vector<std::string> problems {};
+	for (const Attribute &input : _attributes)
+	{
+		if (input.location < 0)
+			continue;
+
+		std::stringstream problem {};
+		const VertexLayout::Attribute *attribute { find(layout, input.name) };
+		if (!attribute)
+			problem << "Input " << input.name << " at location " << input.location << " is not provided by the vertex layout";
+		else if (componentsOf(input.type) == 0)
+			problem << "Input " << input.name << " has unsupported type " << std::hex << std::showbase << input.type;
+		else if (attribute->components < 1 || attribute->components > 4)
+			problem << "Attribute " << input.name << " has " << attribute->components << " components";
+		else if (isInteger(input.type) && (!isIntegerData(attribute->type) || attribute->normalized))
+			problem << "Integer input " << input.name << " is fed " << (attribute->normalized ? "normalized" : "floating point") << " data";
+		else if (locationsOf(input.type) * input.size > 1 && attribute->stride == 0)
+			problem << "Input " << input.name << " takes " << locationsOf(input.type) * input.size << " locations and needs an explicit stride";
+		else
+			continue;
+		problems.push_back(problem.str());
+	}
+	return problems;
+}
+
+/**
+ * @brief Sets up the bound vertex array to feed a vertex layout to the program's inputs
+ * 
+ * Uses the locations of the current program. The vertex array keeps them when the shader is hot reloaded, so
+ * shaders whose vertex arrays outlive a reload need layout(location) qualifiers, otherwise the linker may move
+ * inputs. Matrix inputs take one column per location, consecutive in memory. Leaves GL_ARRAY_BUFFER bound to the
+ * last buffer used.
+ * 
+ * @param layout The mesh's vertex layout
+ * 
+ * @throws VertexLayoutException if validate() finds problems, nothing is set up then
+ */
+void ShaderReflection::bindVertexLayout(const VertexLayout &layout)
+{
+	const std::vector<std::string> problems { validate(layout) };
+	if (!problems.empty())
+	{
+		std::stringstream error {};
+		error << "Vertex layout does not fit the shader:" << std::endl;
+		for (const std::string &problem : problems)
+			error << problem << std::endl;
+		throw VertexLayoutException(error.str());
+	}
+
+	for (const Attribute &input : _attributes)
+	{
+		if (input.location < 0)
+			continue;
+
+		const VertexLayout::Attribute &attribute { *find(layout, input.name) };
+		if (attribute.buffer)
+			glBindBuffer(GL_ARRAY_BUFFER, attribute.buffer);
+		const std::size_t columnSize { static_cast<std::size_t>(attribute.components) * sizeOfData(attribute.type) };
+		for (int column = 0; column < locationsOf(input.type) * input.size; column++)
+		{
+			const GLuint location { static_cast<GLuint>(input.location + column) };
+			const void *offset { reinterpret_cast<const void *>(attribute.offset + column * columnSize) };
+			glEnableVertexAttribArray(location);
+			if (isInteger(input.type))
+				glVertexAttribIPointer(location, attribute.components, attribute.type, attribute.stride, offset);
+			else
+				glVertexAttribPointer(location, attribute.components, attribute.type, attribute.normalized ? GL_TRUE : GL_FALSE, attribute.stride, offset);
+		}
+	}
+}
+
+/**
+ * @brief Gets the number of components of an attribute type, per column for matrices
+ * 
+ * @param type The type reported by glGetActiveAttrib, e.g. GL_FLOAT_VEC3
+ * 
+ * @returns 1 to 4, or 0 for unsupported (double) types
+ */
+int ShaderReflection::componentsOf(GLenum type)
+{
+	switch (type)
+	{
+		case GL_FLOAT:
+		case GL_INT:
+		case GL_UNSIGNED_INT:
+			return 1;
+		case GL_FLOAT_VEC2:
+		case GL_INT_VEC2:
+		case GL_UNSIGNED_INT_VEC2:
+		case GL_FLOAT_MAT2:
+		case GL_FLOAT_MAT3x2:
+		case GL_FLOAT_MAT4x2:
+			return 2;
+		case GL_FLOAT_VEC3:
+		case GL_INT_VEC3:
+		case GL_UNSIGNED_INT_VEC3:
+		case GL_FLOAT_MAT3:
+		case GL_FLOAT_MAT2x3:
+		case GL_FLOAT_MAT4x3:
+			return 3;
+		case GL_FLOAT_VEC4:
+		case GL_INT_VEC4:
+		case GL_UNSIGNED_INT_VEC4:
+		case GL_FLOAT_MAT4:
+		case GL_FLOAT_MAT2x4:
+		case GL_FLOAT_MAT3x4:
+			return 4;
+		default:
+			return 0;
+	}
+}
+
+/**
+ * @brief Gets the number of locations an attribute type occupies
+ * 
+ * @param type The type reported by glGetActiveAttrib
+ * 
+ * @returns The number of matrix columns, 1 for scalars and vectors
+ */
+int ShaderReflection::locationsOf(GLenum type)
+{
+	switch (type)
+	{
+		case GL_FLOAT_MAT2:
+		case GL_FLOAT_MAT2x3:
+		case GL_FLOAT_MAT2x4:
+			return 2;
+		case GL_FLOAT_MAT3:
+		case GL_FLOAT_MAT3x2:
+		case GL_FLOAT_MAT3x4:
+			return 3;
+		case GL_FLOAT_MAT4:
+		case GL_FLOAT_MAT4x2:
+		case GL_FLOAT_MAT4x3:
+			return 4;
+		default:
+			return 1;
+	}
+}
+
+/**
+ * @brief Checks whether an attribute type is a signed or unsigned integer type
+ * 
+ * @param type The type reported by glGetActiveAttrib
+ * 
+ * @returns True for int, uint and their vectors, which have to be fed with glVertexAttribIPointer
+ */
+bool ShaderReflection::isInteger(GLenum type)
+{
+	switch (type)
+	{
+		case GL_INT:
+		case GL_INT_VEC2:
+		case GL_INT_VEC3:
+		case GL_INT_VEC4:
+		case GL_UNSIGNED_INT:
+		case GL_UNSIGNED_INT_VEC2:
+		case GL_UNSIGNED_INT_VEC3:
+		case GL_UNSIGNED_INT_VEC4:
+			return true;
+		default:
+			return false;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,198 @@
+#include "ShaderVariants.hpp"
+#include "UniformBlocks.hpp"
+#include <sstream>
+#include <utility>
+#include <spdlog/spdlog.h>
+
+namespace
+{
+	const std::pair<ShaderVariants::Feature, const char *> featureDefines[] {
+		{ ShaderVariants::NormalMap, "HAS_NORMAL_MAP" },
+		{ ShaderVariants::OcclusionMap, "HAS_OCCLUSION_MAP" },
+		{ ShaderVariants::EmissiveMap, "HAS_EMISSIVE_MAP" },
+		{ ShaderVariants::VertexColors, "HAS_VERTEX_COLORS" },
+		{ ShaderVariants::AlphaMask, "ALPHA_MASK" },
+		{ ShaderVariants::AlphaBlend, "ALPHA_BLEND" },
+		{ ShaderVariants::Skinned, "SKINNED" },
+		{ ShaderVariants::MorphTargets, "MORPH_TARGETS" },
+		{ ShaderVariants::TexCoord0, "HAS_TEXCOORD_0" },
+		{ ShaderVariants::TexCoord1, "HAS_TEXCOORD_1" },
+		{ ShaderVariants::Unlit, "MATERIAL_UNLIT" },
+		{ ShaderVariants::Clearcoat, "MATERIAL_CLEARCOAT" },
+		{ ShaderVariants::Sheen, "MATERIAL_SHEEN" },
+		{ ShaderVariants::Transmission, "MATERIAL_TRANSMISSION" },
+		{ ShaderVariants::Volume, "MATERIAL_VOLUME" },
+		{ ShaderVariants::Specular, "MATERIAL_SPECULAR" },
+		{ ShaderVariants::Ior, "MATERIAL_IOR" },
+		{ ShaderVariants::EmissiveStrength, "MATERIAL_EMISSIVE_STRENGTH" }
+	};
+
+	ShaderVariants::Features texCoordFeature(const Material::TextureRef &ref)
+	{
+		if (ref.image < 0)
+			return 0;
+		return ref.texCoord == 0 ? ShaderVariants::TexCoord0 : ShaderVariants::TexCoord1;
+	}
+}
+
+/**
+ * @brief Constructor for ShaderVariants of a vertex and fragment shader, nothing is compiled yet
+ * 
+ * @param vertPath The path to a vertex shader
+ * @param fragPath The path to a fragment shader
+ */
+ShaderVariants::ShaderVariants(const std::string &vertPath, const std::string &fragPath) : _vertPath { vertPath }, _fragPath { fragPath }
+{
+}
+
+/**
+ * @brief Gets the variant for a set of features, compiling it if it doesn't exist yet
+ * 
+ * @param features Bitwise or of Feature values
+ * 
+ * @returns The variant, valid as long as the ShaderVariants
+ * 
+ * @throws Shader::VertexShaderCompilationException if failed to compile vertex shader
+ * @throws Shader::FragmentShaderCompilationException if failed to compile fragment shader
+ * @throws Shader::ShaderProgramLinkingException if failed to link shader program
+ */
+Shader &ShaderVariants::get(Features features)
+{
+	auto it { _variants.find(features) };
+	if (it != _variants.end())
+		return it->second;
+
+	Shader shader { _vertPath, _fragPath, definesFor(features) + UniformBlocks::declarations() };
+	spdlog::debug("Compiled variant {:#x} of {} and {}", features, _vertPath, _fragPath);
+	return _variants.emplace(features, std::move(shader)).first->second;
+}
+
+/**
+ * @brief Gets the variant for a set of features without waiting for it to compile
+ * 
+ * Requests the variant if that hasn't happened yet and takes it over once the compiler is done with it. A
+ * variant that failed to compile is reported once by the exception and replaced by the fallback afterwards.
+ * All requests of a ShaderVariants have to go to the same compiler.
+ * 
+ * @param features Bitwise or of Feature values
+ * @param compiler The compiler the variant is requested from
+ * @param fallback The program to use while the variant is compiling
+ * 
+ * @returns The variant if it is ready, otherwise the fallback
+ * 
+ * @throws Shader::VertexShaderCompilationException if failed to compile vertex shader
+ * @throws Shader::FragmentShaderCompilationException if failed to compile fragment shader
+ * @throws Shader::ShaderProgramLinkingException if failed to link shader program
+ */
+Shader &ShaderVariants::get(Features features, ShaderCompiler &compiler, Shader &fallback)
+{
+	auto it { _variants.find(features) };
+	if (it != _variants.end())
+	{
+		// It was compiled synchronously by the other get() while the request was still running
+		auto pending { _pending.find(features) };
+		if (pending != _pending.end())
+		{
+			compiler.cancel(pending->second);
+			_pending.erase(pending);
+		}
+		return it->second;
+	}
+	if (_failed.count(features))
+		return fallback;
+
+	request(features, compiler);
+	const ShaderCompiler::Job job { _pending.at(features) };
+	if (!compiler.isReady(job))
+		return fallback;
+
+	_pending.erase(features);
+	try
+	{
+		Shader shader { compiler.finish(job) };
+		spdlog::debug("Compiled variant {:#x} of {} and {}", features, _vertPath, _fragPath);
+		return _variants.emplace(features, std::move(shader)).first->second;
+	}
+	catch (...)
+	{
+		_failed.insert(features);
+		throw;
+	}
+}
+
+/**
+ * @brief Starts compiling a variant in the background unless it exists or was already requested
+ * 
+ * @param features Bitwise or of Feature values
+ * @param compiler The compiler to submit the variant to
+ */
+void ShaderVariants::request(Features features, ShaderCompiler &compiler)
+{
+	if (_variants.count(features) || _pending.count(features) || _failed.count(features))
+		return;
+
+	_pending.emplace(features, compiler.submit(_vertPath, _fragPath, definesFor(features) + UniformBlocks::declarations()));
+}
+
+/**
+ * @brief Gets the number of variants compiled so far
+ * 
+ * @returns The variant count
+ */
+std::size_t ShaderVariants::getCount()
+{
+	return _variants.size();
+}
+
+/**
+ * @brief Derives the features a material's textures and alpha mode imply
+ * 
+ * Features of the primitive (vertex colors, skinning, morph targets) and of extensions are added by the caller.
+ * 
+ * @param material The material
+ * 
+ * @returns The features
+ */
+ShaderVariants::Features ShaderVariants::featuresOf(const Material &material)
+{
+	Features features {};
+	if (material.normal.image >= 0)
+		features |= NormalMap;
+	if (material.occlusion.image >= 0)
+		features |= OcclusionMap;
+	if (material.emissive.image >= 0)
+		features |= EmissiveMap;
+	if (material.alphaMode == Material::AlphaMode::Mask)
+		features |= AlphaMask;
+	if (material.alphaMode == Material::AlphaMode::Blend)
+		features |= AlphaBlend;
+
+	features |= texCoordFeature(material.baseColor);
+	features |= texCoordFeature(material.metallicRoughness);
+	features |= texCoordFeature(material.normal);
+	features |= texCoordFeature(material.occlusion);
+	features |= texCoordFeature(material.emissive);
+	return features;
+}
+
+/**
+ * @brief Generates the #defines of a variant
+ * 
+ * Besides one define per feature, TEXCOORD_COUNT is the number of texture coordinate sets the variant reads.
+ * 
+ * @param features Bitwise or of Feature values
+ * 
+ * @returns The defines, one per line
+ */
+std::string ShaderVariants::definesFor(Features features)
+{
+	std::stringstream defines {};
+	for (const std::pair<Feature, const char *> &define : featureDefines)
+	{
+		if (features & define.first)
+			defines << "#define " << define.second << "\n";
+	}
+	const int texCoordCount { (features & TexCoord1) ? 2 : (features & TexCoord0) ? 1 : 0 };
+	defines << "#define TEXCOORD_COUNT " << texCoordCount << "\n";
+	return defines.str();
+}
\ No newline at end of file
@@ -0,0 +1,168 @@
+#include "ShaderWatcher.hpp"
+#include "ShaderPreprocessor.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <spdlog/spdlog.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	std::string fileName(const std::string &path)
+	{
+		const std::size_t slash { path.find_last_of("/\\") };
+		return slash == std::string::npos ? path : path.substr(slash + 1);
+	}
+}
+
+/**
+ * @brief Constructor for ShaderWatcher watching a directory
+ * 
+ * Editors often save by writing a new file and renaming it over the old one, so the directory is watched rather
+ * than the files themselves.
+ * 
+ * @param directory The directory holding the shader files, e.g. "res/shaders"
+ */
+ShaderWatcher::ShaderWatcher(const std::string &directory) : _directory { directory }
+{
+#ifdef __linux__
+	_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (_fd >= 0 && inotify_add_watch(_fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0)
+	{
+		close(_fd);
+		_fd = -1;
+	}
+#endif
+	if (_fd < 0)
+		spdlog::debug("Cannot watch {} for shader changes", directory);
+	else
+		spdlog::debug("Watching {} for shader changes", directory);
+}
+
+/**
+ * @brief Destructor for ShaderWatcher, stops watching
+ */
+ShaderWatcher::~ShaderWatcher()
+{
+#ifdef __linux__
+	if (_fd >= 0)
+		close(_fd);
+#endif
+}
+
+/**
+ * @brief Checks whether the directory is being watched
+ * 
+ * @returns False if inotify is unavailable or the directory could not be watched
+ */
+bool ShaderWatcher::isAvailable()
+{
+	return _fd >= 0;
+}
+
+/**
+ * @brief Reloads a shader whenever one of its files in the watched directory changes
+ * 
+ * @param shader The shader, it and all its copies get the reloaded program
+ */
+void ShaderWatcher::watch(Shader &shader)
+{
+	_shaders.push_back(shader);
+}
+
+/**
+ * @brief Starts reloading shaders whose files changed and swaps in those that finished, call once per frame
+ * 
+ * Requires the context the shaders were created with to be current.
+ */
+void ShaderWatcher::poll()
+{
+	if (!isAvailable())
+		return;
+
+	const std::vector<std::string> changes { readChanges() };
+	for (std::size_t i = 0; i < _shaders.size() && !changes.empty(); i++)
+	{
+		Shader &shader { _shaders[i] };
+		std::vector<std::string> files { ShaderPreprocessor::shared().getDependencies(shader.getVertPath()) };
+		const std::vector<std::string> fragFiles { ShaderPreprocessor::shared().getDependencies(shader.getFragPath()) };
+		files.insert(files.end(), fragFiles.begin(), fragFiles.end());
+		files.push_back(shader.getVertPath());
+		files.push_back(shader.getFragPath());
+		const bool changed { std::any_of(files.begin(), files.end(), [&changes](const std::string &file)
+		{
+			return std::find(changes.begin(), changes.end(), fileName(file)) != changes.end();
+		}) };
+		if (!changed)
+			continue;
+
+		// A newer save supersedes a rebuild still in flight
+		auto pending { _pending.find(i) };
+		if (pending != _pending.end())
+		{
+			_compiler.cancel(pending->second);
+			_pending.erase(pending);
+		}
+		// Preprocessing runs here, a missing or circular #include saved while editing must not end the program
+		try
+		{
+			_pending[i] = _compiler.submit(shader.getVertPath(), shader.getFragPath(), shader._program->prelude);
+			spdlog::debug("Rebuilding {} and {}", shader.getVertPath(), shader.getFragPath());
+		}
+		catch (const std::runtime_error &e)
+		{
+			spdlog::error("Keeping previous version of {} and {}: {}", shader.getVertPath(), shader.getFragPath(), e.what());
+		}
+	}
+
+	for (auto it = _pending.begin(); it != _pending.end();)
+	{
+		if (!_compiler.isReady(it->second))
+		{
+			++it;
+			continue;
+		}
+
+		Shader &shader { _shaders[it->first] };
+		try
+		{
+			Shader rebuilt { _compiler.finish(it->second) };
+			shader.adopt(rebuilt);
+		}
+		catch (const std::runtime_error &e)
+		{
+			spdlog::error("Keeping previous version of {} and {}: {}", shader.getVertPath(), shader.getFragPath(), e.what());
+		}
+		it = _pending.erase(it);
+	}
+}
+
+/**
+ * @brief Drains the pending inotify events
+ * 
+ * @returns Names of the files that changed, relative to the watched directory
+ */
+std::vector<std::string> ShaderWatcher::readChanges()
+{
+	std::vector<std::string> names {};
+#ifdef __linux__
+	alignas(inotify_event) char buffer[4096];
+	for (;;)
+	{
+		const ssize_t length { read(_fd, buffer, sizeof(buffer)) };
+		if (length <= 0)
+			break;
+
+		for (ssize_t offset = 0; offset < length;)
+		{
+			const inotify_event *event { reinterpret_cast<const inotify_event *>(buffer + offset) };
+			if (event->len > 0 && std::find(names.begin(), names.end(), event->name) == names.end())
+				names.emplace_back(event->name);
+			offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+		}
+	}
+#endif
+	return names;
+}
\ No newline at end of file
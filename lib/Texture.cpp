@@ -1,6 +1,146 @@
 #include <stb_image.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <utility>
 #include <sstream>
+#include <spdlog/spdlog.h>
 #include "Texture.hpp"
+#include "SamplerCache.hpp"
+#include "ImageCache.hpp"
+#include "JpegDecoder.hpp"
+#include "HdrPacker.hpp"
+
+namespace
+{
+	// Frees pixels allocated by stb_image when they go out of scope, also if a later step throws
+	struct StbiDeleter
+	{
+		void operator()(void *data) const
+		{
+			stbi_image_free(data);
+		}
+	};
+
+	using StbiPixels = std::unique_ptr<unsigned char, StbiDeleter>;
+	using StbiFloats = std::unique_ptr<float, StbiDeleter>;
+
+	TextureLoadOptions makeOptions(GLint internalFormat, GLenum format, GLenum type, bool flipVertically)
+	{
+		TextureLoadOptions options {};
+		options.internalFormat = internalFormat;
+		options.format = format;
+		options.type = type;
+		options.flipVertically = flipVertically;
+		return options;
+	}
+
+	BlockCompression::Format blockFormat(TextureLoadOptions::Compression compression)
+	{
+		switch (compression)
+		{
+			case TextureLoadOptions::Compression::BC3:
+				return BlockCompression::Format::BC3;
+			case TextureLoadOptions::Compression::BC4:
+				return BlockCompression::Format::BC4;
+			case TextureLoadOptions::Compression::BC5:
+				return BlockCompression::Format::BC5;
+			default:
+				return BlockCompression::Format::BC1;
+		}
+	}
+
+	// Whether the context supports every block format the options may compress to, which changes the cached payload
+	bool isCompressible(const TextureLoadOptions &options)
+	{
+		if (options.normalMap)
+			return BlockCompression::isSupported(BlockCompression::Format::BC5, false);
+		if (options.hdrFormat == TextureLoadOptions::HdrFormat::BC6H && !BlockCompression::isSupported(BlockCompression::Format::BC6H, false))
+			return false;
+		return options.compression == TextureLoadOptions::Compression::None || BlockCompression::isSupported(blockFormat(options.compression), isSrgbFormat(options.internalFormat));
+	}
+
+	// Whether the context can sample a cached payload, entries may have been written by a context with more formats
+	bool isSampleable(const ImageCache::Format &format)
+	{
+		if (!format.compressed)
+			return true;
+		const BlockCompression::Format formats[] { BlockCompression::Format::BC1, BlockCompression::Format::BC3, BlockCompression::Format::BC4,
+			BlockCompression::Format::BC5, BlockCompression::Format::BC6H, BlockCompression::Format::BC7 };
+		for (BlockCompression::Format candidate : formats)
+			for (bool srgb : { false, true })
+				if (static_cast<GLint>(BlockCompression::getInternalFormat(candidate, srgb)) == format.internalFormat)
+					return BlockCompression::isSupported(candidate, srgb);
+		return false;
+	}
+
+	// Normal maps are data, so they are filtered linearly, and only X and Y are stored
+	TextureLoadOptions normalMapOptions(const TextureLoadOptions &options)
+	{
+		TextureLoadOptions resolved { options };
+		resolved.internalFormat = GL_RG8;
+		resolved.format = GL_RG;
+		resolved.type = GL_UNSIGNED_BYTE;
+		resolved.mipmaps = TextureLoadOptions::Mipmaps::Cpu;
+		resolved.compression = TextureLoadOptions::Compression::BC5;
+		resolved.mipOptions.srgb = false;
+		// MipChain treats the second of two channels as alpha, Y must not be premultiplied into X
+		resolved.mipOptions.premultipliedAlpha = true;
+		return resolved;
+	}
+
+	MipChain keepXY(MipChain &chain)
+	{
+		const MipChain::Level &level { chain.getLevel(0) };
+		MipChain xy { level.width, level.height, 2 };
+		const int channels { chain.getChannels() };
+		const unsigned char *src { chain.getData() };
+		unsigned char *dst { xy.getData() };
+		for (std::size_t i = 0; i < static_cast<std::size_t>(level.width) * level.height; i++)
+		{
+			dst[i * 2] = src[i * channels];
+			dst[i * 2 + 1] = src[i * channels + 1];
+		}
+		return xy;
+	}
+
+	/**
+	 * Decodes an image at its full size into output, JPEGs with JpegDecoder if core was built with libjpeg and
+	 * everything else, including JPEGs libjpeg rejects, with stb_image. libjpeg only ever writes its output rows,
+	 * so it decodes straight into output. stb_image reads back what it wrote, to flip rows and to unfilter PNGs,
+	 * which must not happen in write only staging memory, so it decodes on the heap and the image is copied
+	 * into output. Returns false if decoding failed or produced an image of another size than stbi_info reported.
+	 */
+	bool decodeInto(const unsigned char *encoded, std::size_t size, int width, int height, int channels, bool flipVertically, unsigned char *output)
+	{
+		const std::size_t outputSize { static_cast<std::size_t>(width) * height * channels };
+		int decodedWidth {}, decodedHeight {}, fileChannels {};
+		if (JpegDecoder::decode(encoded, size, channels, flipVertically, output, outputSize, decodedWidth, decodedHeight) && decodedWidth == width && decodedHeight == height)
+			return true;
+
+		StbiPixels data { stbi_load_from_memory(encoded, static_cast<int>(size), &decodedWidth, &decodedHeight, &fileChannels, channels) };
+		if (!data || decodedWidth != width || decodedHeight != height)
+			return false;
+		std::memcpy(output, data.get(), outputSize);
+		return true;
+	}
+
+	std::string failureMessage(const std::string &name)
+	{
+		std::stringstream error {};
+		error << "Failed to load texture: " << name << ": " << stbi_failure_reason() << std::endl;
+		return error.str();
+	}
+
+	std::string failureMessage(const std::string &name, const std::exception &e)
+	{
+		std::stringstream error {};
+		error << "Failed to load texture: " << name << ": " << e.what();
+		return error.str();
+	}
+}
 
 /**
  * @brief Constructor for a Texture from a path to an image file
@@ -17,36 +157,952 @@
 Texture::Texture(const std::string &path, GLenum target, GLint internalFormat, GLenum format, GLenum type, bool flipVertically)
 	: _target { target }
 {
-	glGenTextures(1, &_id);
-	
-	this->bind();
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	try
+	{
+		MappedFile file { mapFile(path) };
+		upload(file.getData(), file.getSize(), path, makeOptions(internalFormat, format, type, flipVertically));
+	}
+	catch (...)
+	{
+		destroy();
+		throw;
+	}
+}
 
-	stbi_set_flip_vertically_on_load(flipVertically);
-	
-	unsigned char *data = stbi_load(path.c_str(), &_width, &_height, &_nrChannels, 0);
-	if (data)
+/**
+ * @brief Constructor for a Texture from an encoded image already in memory
+ * 
+ * @param encoded Pointer to the encoded image file (PNG, JPEG, ...)
+ * @param size Size of the encoded image in bytes
+ * @param target The desired texture unit
+ * @param internalFormat The format that openGL should store the texture as. Defaults to GL_RGBA
+ * @param format The format that the image is stored as. Defaults to GL_RGBA
+ * @param type The type that the image is stored as. Defaults to GL_UNSIGNED_BYTE
+ * @param flipVertically Decides whether the image should be flipped vertically or not. Defaults to true
+ * 
+ * @throws TextureLoadingException if texture failed to load
+ */
+Texture::Texture(const unsigned char *encoded, std::size_t size, GLenum target, GLint internalFormat, GLenum format, GLenum type, bool flipVertically)
+	: _target { target }
+{
+	try
 	{
-		glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, _width, _height, 0, format, type, data);
-		glGenerateMipmap(GL_TEXTURE_2D);
+		upload(encoded, size, "<memory>", makeOptions(internalFormat, format, type, flipVertically));
 	}
-	else
+	catch (...)
+	{
+		destroy();
+		throw;
+	}
+}
+
+/**
+ * @brief Constructor for a Texture from a path to an image file with explicit load options
+ * 
+ * @param path The path to an image file
+ * @param target The desired texture unit
+ * @param options Formats, orientation and how mipmaps should be generated
+ * 
+ * @throws TextureLoadingException if texture failed to load
+ */
+Texture::Texture(const std::string &path, GLenum target, const TextureLoadOptions &options)
+	: _target { target }
+{
+	try
+	{
+		MappedFile file { mapFile(path) };
+		upload(file.getData(), file.getSize(), path, options);
+	}
+	catch (...)
+	{
+		destroy();
+		throw;
+	}
+}
+
+/**
+ * @brief Constructor for a Texture from an encoded image in memory with explicit load options
+ * 
+ * @param encoded Pointer to the encoded image file (PNG, JPEG, ...)
+ * @param size Size of the encoded image in bytes
+ * @param target The desired texture unit
+ * @param options Formats, orientation and how mipmaps should be generated
+ * 
+ * @throws TextureLoadingException if texture failed to load
+ */
+Texture::Texture(const unsigned char *encoded, std::size_t size, GLenum target, const TextureLoadOptions &options)
+	: _target { target }
+{
+	try
+	{
+		upload(encoded, size, "<memory>", options);
+	}
+	catch (...)
+	{
+		destroy();
+		throw;
+	}
+}
+
+/**
+ * @brief Constructor for a Texture from pixels which are already decoded, e.g. channels packed on the CPU
+ * 
+ * @param chain Mip chain with level 0 filled in, the remaining levels are generated according to options
+ * @param target The desired texture unit
+ * @param options Formats, how mipmaps should be generated and compression. Orientation and maxDimension are ignored
+ */
+Texture::Texture(MipChain &chain, GLenum target, const TextureLoadOptions &options)
+	: _target { target }, _width { chain.getLevel(0).width }, _height { chain.getLevel(0).height }, _nrChannels { chain.getChannels() }
+{
+	create();
+	try
+	{
+		uploadChain(chain, "<mip chain>", options, 0);
+	}
+	catch (...)
+	{
+		destroy();
+		throw;
+	}
+}
+
+/**
+ * @brief Constructor for a streamed Texture uploading only the smaller levels of a KTX2 container
+ * 
+ * The container must stay valid for as long as levels are streamed with setResidentBaseLevel().
+ * 
+ * @param container A parsed KTX2 container
+ * @param target The desired texture unit
+ * @param baseLevel The largest level to upload initially
+ * 
+ * @throws TextureLoadingException if texture failed to load
+ */
+Texture::Texture(Ktx2 &container, GLenum target, std::size_t baseLevel)
+	: _target { target }
+{
+	create();
+	try
+	{
+		uploadKtx2(container, "<ktx2>", baseLevel);
+	}
+	catch (const Ktx2::InvalidFileException &e)
+	{
+		destroy();
+		throw TextureLoadingException(failureMessage("<ktx2>", e));
+	}
+	catch (const Ktx2::UnsupportedFormatException &e)
+	{
+		destroy();
+		throw TextureLoadingException(failureMessage("<ktx2>", e));
+	}
+	catch (...)
+	{
+		destroy();
+		throw;
+	}
+}
+
+/**
+ * @brief Move constructor for Texture
+ */
+Texture::Texture(Texture &&rhs)
+	: _id { rhs._id }, _target { rhs._target }, _width { rhs._width }, _height { rhs._height }, _nrChannels { rhs._nrChannels }, _baseLevel { rhs._baseLevel }
+{
+	rhs._id = 0;
+}
+
+/**
+ * @brief Destructor for Texture, deletes the OpenGL texture while a context is still current
+ */
+Texture::~Texture()
+{
+	destroy();
+}
+
+/**
+ * @brief Move assignment operator for Texture
+ */
+Texture &Texture::operator=(Texture &&rhs)
+{
+	std::swap(_id, rhs._id);
+	_target = rhs._target;
+	_width = rhs._width;
+	_height = rhs._height;
+	_nrChannels = rhs._nrChannels;
+	_baseLevel = rhs._baseLevel;
+
+	return *this;
+}
+
+/**
+ * @brief Binds the texture as active
+ */
+void Texture::bind()
+{
+	bind(_target);
+}
+
+/**
+ * @brief Binds the texture to a given texture unit with the default sampler
+ * 
+ * Useful for shared textures, which are sampled from different units by different materials.
+ * 
+ * @param target The texture unit to bind to, e.g. GL_TEXTURE0
+ */
+void Texture::bind(GLenum target)
+{
+	bind(target, SamplerState {});
+}
+
+/**
+ * @brief Binds the texture to a given texture unit, sampled with the shared sampler for a state
+ * 
+ * @param target The texture unit to bind to, e.g. GL_TEXTURE0
+ * @param sampler Wrap, filter and anisotropy parameters, e.g. from SamplerState::fromGltf()
+ */
+void Texture::bind(GLenum target, const SamplerState &sampler)
+{
+	glActiveTexture(target);
+	glBindTexture(GL_TEXTURE_2D, _id);
+	SamplerCache::shared().bind(target, sampler);
+}
+
+/**
+ * @brief Getter for the OpenGL texture name
+ * 
+ * @returns The texture's id
+ */
+GLuint Texture::getId()
+{
+	return _id;
+}
+
+/**
+ * @brief Getter for texture width
+ * 
+ * @returns Width of the base level in pixels
+ */
+int Texture::getWidth()
+{
+	return _width;
+}
+
+/**
+ * @brief Getter for texture height
+ * 
+ * @returns Height of the base level in pixels
+ */
+int Texture::getHeight()
+{
+	return _height;
+}
+
+/**
+ * @brief Gets the staging ring shared by all texture uploads, creating it on first use
+ * 
+ * @returns The shared PixelBufferRing
+ */
+PixelBufferRing &Texture::stagingRing()
+{
+	static PixelBufferRing ring { PixelBufferRing::defaultCapacity };
+	return ring;
+}
+
+/**
+ * @brief Reads a whole image file into memory
+ * 
+ * @param path The path to an image file
+ * 
+ * @returns The encoded bytes of the file
+ * 
+ * @throws TextureLoadingException if the file could not be read
+ */
+std::vector<unsigned char> Texture::readFile(const std::string &path)
+{
+	std::ifstream is { path, std::ios::binary };
+	if (!is)
 	{
 		std::stringstream error {};
 		error << "Failed to load texture: " << path << std::endl;
 		throw TextureLoadingException(error.str());
 	}
-	stbi_image_free(data);
+	return std::vector<unsigned char>(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
 }
 
 /**
- * @brief Binds the texture as active
+ * @brief Maps a whole image file into memory
+ * 
+ * Decoding and uploading straight from the mapping avoids reading the file into a heap buffer first.
+ * 
+ * @param path The path to an image file
+ * 
+ * @returns The mapped file
+ * 
+ * @throws TextureLoadingException if the file could not be mapped
  */
-void Texture::bind()
+MappedFile Texture::mapFile(const std::string &path)
+{
+	try
+	{
+		return MappedFile { path };
+	}
+	catch (const MappedFile::MappingException &)
+	{
+		std::stringstream error {};
+		error << "Failed to load texture: " << path << std::endl;
+		throw TextureLoadingException(error.str());
+	}
+}
+
+/**
+ * @brief Generates the OpenGL texture and binds it
+ * 
+ * Wrap and filter parameters are not set on the texture, they come from the sampler bound with it.
+ */
+void Texture::create()
 {
+	glGenTextures(1, &_id);
+
 	glActiveTexture(_target);
 	glBindTexture(GL_TEXTURE_2D, _id);
+}
+
+/**
+ * @brief Deletes the OpenGL texture while a context is still current
+ * 
+ * Called by the destructor and by constructors which throw, as the destructor does not run for those.
+ */
+void Texture::destroy()
+{
+	if (_id && glfwGetCurrentContext())
+		glDeleteTextures(1, &_id);
+	_id = 0;
+}
+
+/**
+ * @brief Decodes an encoded image and uploads it as the texture's storage
+ * 
+ * The image is decoded into mapped memory of the shared pixel buffer ring and uploaded from there, so the upload
+ * does not stall on client memory. JPEGs are decoded straight into the mapping if core was built with libjpeg,
+ * other images are decoded on the heap and copied in once. KTX2 containers are
+ * recognised by their identifier and uploaded without decoding, ignoring the formats, orientation and mip options.
+ * If the shared ImageCache is enabled, a cached payload is uploaded instead of decoding, and a miss goes through
+ * the heap mip chain path so its payload can be stored. So do images larger than options.maxDimension and normal
+ * maps, which are stored as two channels. HDR images are kept in floating point if options.hdrFormat asks for it.
+ * 
+ * @param encoded Pointer to the encoded image
+ * @param size Size of the encoded image in bytes
+ * @param name Name used in error messages
+ * @param options Formats, orientation and how mipmaps should be generated
+ * 
+ * @throws TextureLoadingException if texture failed to load
+ */
+void Texture::upload(const unsigned char *encoded, std::size_t size, const std::string &name, const TextureLoadOptions &options)
+{
+	create();
+
+	if (Ktx2::isKtx2(encoded, size))
+	{
+		try
+		{
+			Ktx2 container { encoded, size };
+			uploadKtx2(container, name);
+		}
+		catch (const Ktx2::InvalidFileException &e)
+		{
+			throw TextureLoadingException(failureMessage(name, e));
+		}
+		catch (const Ktx2::UnsupportedFormatException &e)
+		{
+			throw TextureLoadingException(failureMessage(name, e));
+		}
+		return;
+	}
+
+	ImageCache &cache { ImageCache::shared() };
+	const std::uint64_t cacheKey { cache.isEnabled() ? ImageCache::keyOf(encoded, size, options, isCompressible(options)) : 0 };
+	if (cache.isEnabled())
+	{
+		std::unique_ptr<ImageCache::Entry> entry { cache.find(cacheKey) };
+		if (entry && uploadCached(*entry, name, options))
+			return;
+	}
+
+	stbi_set_flip_vertically_on_load_thread(options.flipVertically);
+
+	if (!stbi_info_from_memory(encoded, static_cast<int>(size), &_width, &_height, &_nrChannels))
+		throw TextureLoadingException(failureMessage(name));
+
+	if (options.hdrFormat != TextureLoadOptions::HdrFormat::None && stbi_is_hdr_from_memory(encoded, static_cast<int>(size)))
+	{
+		uploadHdr(encoded, size, name, options, cacheKey);
+		return;
+	}
+
+	if (options.normalMap)
+	{
+		_nrChannels = 3;
+		uploadMipChain(encoded, size, name, normalMapOptions(options), cacheKey);
+		return;
+	}
+
+	const bool downscale { options.maxDimension > 0 && std::max(_width, _height) > options.maxDimension };
+	if (downscale || cache.isEnabled() || options.mipmaps == TextureLoadOptions::Mipmaps::Cpu || options.compression != TextureLoadOptions::Compression::None)
+	{
+		uploadMipChain(encoded, size, name, options, cacheKey);
+		return;
+	}
+
+	PixelBufferRing &ring { stagingRing() };
+	GLsizeiptr imageSize { static_cast<GLsizeiptr>(_width) * _height * _nrChannels };
+	PixelBufferRing::Segment segment { ring.acquire(imageSize) };
+
+	if (!decodeInto(encoded, size, _width, _height, _nrChannels, options.flipVertically, static_cast<unsigned char *>(segment.data)))
+	{
+		ring.unpack(segment);
+		ring.release(segment);
+		throw TextureLoadingException(failureMessage(name));
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, options.internalFormat, _width, _height, 0, options.format, options.type, ring.unpack(segment));
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	if (options.mipmaps == TextureLoadOptions::Mipmaps::Gpu)
+		glGenerateMipmap(GL_TEXTURE_2D);
+	else
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	ring.release(segment);
+}
+
+/**
+ * @brief Decodes an image, filters its mip chain on the CPU and uploads every level
+ * 
+ * The image is decoded into level 0 of a MipChain, downscaled if it exceeds options.maxDimension, and uploaded
+ * with uploadChain(). Normal maps are reduced to their X and Y channels first.
+ * 
+ * @param encoded Pointer to the encoded image
+ * @param size Size of the encoded image in bytes
+ * @param name Name used in error messages
+ * @param options Formats, orientation, mip filter and compression options
+ * @param cacheKey Key of the image in the shared ImageCache, 0 to not cache it
+ * 
+ * @throws TextureLoadingException if texture failed to load
+ */
+void Texture::uploadMipChain(const unsigned char *encoded, std::size_t size, const std::string &name, const TextureLoadOptions &options, std::uint64_t cacheKey)
+{
+	MipChain chain { decodeMipChain(encoded, size, name, options) };
+	if (options.normalMap)
+	{
+		chain = keepXY(chain);
+		_nrChannels = 2;
+	}
+	uploadChain(chain, name, options, cacheKey);
+}
+
+/**
+ * @brief Filters the mip chain of decoded pixels on the CPU and uploads every level
+ * 
+ * The rest of the chain is generated from level 0 on the worker pool and the whole chain is uploaded from one
+ * staging segment. The calling thread waits for the pool, so a large chain still stalls the thread loading it.
+ * Levels are filtered in linear light if options.mipOptions.srgb is set or the internal format is sRGB. If block
+ * compression was requested and the context supports the format, the levels are compressed on the worker pool
+ * straight into the staging segment instead. With GPU mipmaps only level 0 is uploaded and the rest generated by
+ * OpenGL, which is how cache misses and downscaled loads of such images are loaded. The uploaded payload is
+ * stored in the shared ImageCache if it is enabled and a key is given.
+ * 
+ * @param chain Mip chain with level 0 filled in
+ * @param name Name used in log messages
+ * @param options Formats, mip filter and compression options
+ * @param cacheKey Key of the image in the shared ImageCache, 0 to not cache it
+ */
+void Texture::uploadChain(MipChain &chain, const std::string &name, const TextureLoadOptions &options, std::uint64_t cacheKey)
+{
+	const bool gpuMipmaps { options.mipmaps == TextureLoadOptions::Mipmaps::Gpu && options.compression == TextureLoadOptions::Compression::None };
+	const std::size_t levelCount { options.mipmaps == TextureLoadOptions::Mipmaps::None || gpuMipmaps ? 1 : chain.getLevelCount() };
+	if (levelCount > 1)
+	{
+		chain.generate(mipOptionsFor(options));
+		spdlog::debug("Generated {} mip levels for {} on the CPU", levelCount, name);
+	}
+
+	if (options.compression != TextureLoadOptions::Compression::None)
+	{
+		const BlockCompression::Format format { blockFormat(options.compression) };
+		const bool srgb { isSrgbFormat(options.internalFormat) };
+		if (BlockCompression::isSupported(format, srgb))
+		{
+			uploadCompressed(chain, levelCount, format, srgb, cacheKey);
+			return;
+		}
+		spdlog::debug("Block compression not supported for {}, uploading uncompressed", name);
+	}
+
+	PixelBufferRing &ring { stagingRing() };
+	const std::size_t chainSize { chain.getLevel(levelCount - 1).offset + chain.getLevel(levelCount - 1).size };
+	PixelBufferRing::Segment segment { ring.acquire(chainSize) };
+	std::memcpy(segment.data, chain.getData(), chainSize);
+	const char *pixels { static_cast<const char *>(ring.unpack(segment)) };
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (std::size_t i = 0; i < levelCount; i++)
+	{
+		const MipChain::Level &level { chain.getLevel(i) };
+		glTexImage2D(GL_TEXTURE_2D, i, options.internalFormat, level.width, level.height, 0, options.format, options.type, pixels + level.offset);
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	if (gpuMipmaps)
+		glGenerateMipmap(GL_TEXTURE_2D);
+	else
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+	ring.release(segment);
+
+	if (cacheKey != 0 && ImageCache::shared().isEnabled())
+	{
+		std::vector<ImageCache::Level> levels {};
+		for (std::size_t i = 0; i < levelCount; i++)
+		{
+			const MipChain::Level &level { chain.getLevel(i) };
+			levels.push_back({ chain.getLevelData(i), level.size, level.width, level.height });
+		}
+		ImageCache::shared().store(cacheKey, { options.internalFormat, options.format, options.type, false }, _nrChannels, levels);
+	}
+}
+
+/**
+ * @brief Decodes an image into level 0 of a new mip chain, downscaled to fit options.maxDimension
+ * 
+ * Images within the limit are decoded straight into the chain. Larger ones are resampled to fit with the chain's
+ * filter on the worker pool, JPEGs are first decoded at the smallest DCT scale still at least the target size
+ * if core was built with libjpeg, so they are never fully decoded only to be shrunk. The texture's size is set
+ * to the size of level 0.
+ * 
+ * @param encoded Pointer to the encoded image
+ * @param size Size of the encoded image in bytes
+ * @param name Name used in error messages
+ * @param options Orientation, resolution limit and the filter to downscale with
+ * 
+ * @returns The chain with level 0 filled in
+ * 
+ * @throws TextureLoadingException if texture failed to load
+ */
+MipChain Texture::decodeMipChain(const unsigned char *encoded, std::size_t size, const std::string &name, const TextureLoadOptions &options)
+{
+	const int largest { std::max(_width, _height) };
+	if (options.maxDimension <= 0 || largest <= options.maxDimension)
+	{
+		MipChain chain { _width, _height, _nrChannels };
+		if (!decodeInto(encoded, size, _width, _height, _nrChannels, options.flipVertically, chain.getData()))
+			throw TextureLoadingException(failureMessage(name));
+		return chain;
+	}
+
+	const double scale { static_cast<double>(options.maxDimension) / largest };
+	const int width { std::max(static_cast<int>(_width * scale + 0.5), 1) };
+	const int height { std::max(static_cast<int>(_height * scale + 0.5), 1) };
+	MipChain chain { width, height, _nrChannels };
+
+	std::vector<unsigned char> pixels {};
+	int decodedWidth {}, decodedHeight {};
+	const unsigned char *decoded { nullptr };
+	StbiPixels data {};
+	if (JpegDecoder::decode(encoded, size, _nrChannels, width, height, options.flipVertically, pixels, decodedWidth, decodedHeight))
+		decoded = pixels.data();
+	else
+	{
+		int fileChannels {};
+		data.reset(stbi_load_from_memory(encoded, static_cast<int>(size), &decodedWidth, &decodedHeight, &fileChannels, _nrChannels));
+		if (!data)
+			throw TextureLoadingException(failureMessage(name));
+		decoded = data.get();
+	}
+
+	if (decodedWidth == width && decodedHeight == height)
+		std::memcpy(chain.getData(), decoded, chain.getLevel(0).size);
+	else
+		MipChain::resample(decoded, decodedWidth, decodedHeight, _nrChannels, chain.getData(), width, height, mipOptionsFor(options));
+
+	spdlog::debug("Downscaled {} from {}x{} to {}x{} (decoded at {}x{})", name, _width, _height, width, height, decodedWidth, decodedHeight);
+	_width = width;
+	_height = height;
+	return chain;
+}
+
+/**
+ * @brief Block compresses the first levels of a mip chain and uploads them with glCompressedTexImage2D
+ * 
+ * @param chain The decoded and filtered mip chain
+ * @param levelCount Number of levels to upload
+ * @param format The block format to compress to
+ * @param srgb Whether color formats should be sampled as sRGB
+ * @param cacheKey Key of the image in the shared ImageCache, 0 to not cache it
+ */
+void Texture::uploadCompressed(MipChain &chain, std::size_t levelCount, BlockCompression::Format format, bool srgb, std::uint64_t cacheKey)
+{
+	std::vector<std::size_t> offsets(levelCount);
+	std::size_t total { 0 };
+	for (std::size_t i = 0; i < levelCount; i++)
+	{
+		offsets[i] = total;
+		total += BlockCompression::getCompressedSize(format, chain.getLevel(i).width, chain.getLevel(i).height);
+	}
+
+	// The staging memory is write only, blocks which go into the cache as well are encoded on the heap first
+	const bool caching { cacheKey != 0 && ImageCache::shared().isEnabled() };
+	std::vector<unsigned char> encoded(caching ? total : 0);
+	PixelBufferRing &ring { stagingRing() };
+	PixelBufferRing::Segment segment { ring.acquire(total) };
+	unsigned char *staging { caching ? encoded.data() : static_cast<unsigned char *>(segment.data) };
+	for (std::size_t i = 0; i < levelCount; i++)
+	{
+		const MipChain::Level &level { chain.getLevel(i) };
+		BlockCompression::encode(format, chain.getLevelData(i), level.width, level.height, chain.getChannels(), staging + offsets[i]);
+	}
+	if (caching)
+		std::memcpy(segment.data, encoded.data(), total);
+	const char *blocks { static_cast<const char *>(ring.unpack(segment)) };
+
+	const GLenum internalFormat { BlockCompression::getInternalFormat(format, srgb) };
+	for (std::size_t i = 0; i < levelCount; i++)
+	{
+		const MipChain::Level &level { chain.getLevel(i) };
+		const GLsizei levelSize { static_cast<GLsizei>(BlockCompression::getCompressedSize(format, level.width, level.height)) };
+		glCompressedTexImage2D(GL_TEXTURE_2D, i, internalFormat, level.width, level.height, 0, levelSize, blocks + offsets[i]);
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+	ring.release(segment);
+	spdlog::debug("Uploaded {} block compressed levels, {} bytes", levelCount, total);
+
+	if (caching)
+	{
+		std::vector<ImageCache::Level> levels {};
+		for (std::size_t i = 0; i < levelCount; i++)
+		{
+			const MipChain::Level &level { chain.getLevel(i) };
+			levels.push_back({ encoded.data() + offsets[i], BlockCompression::getCompressedSize(format, level.width, level.height), level.width, level.height });
+		}
+		ImageCache::shared().store(cacheKey, { static_cast<GLint>(internalFormat), GL_NONE, GL_NONE, true }, chain.getChannels(), levels);
+	}
+}
+
+/**
+ * @brief Decodes an HDR image as floats and uploads it in a compact HDR format
+ * 
+ * Images larger than options.maxDimension are first downscaled to fit with an area filter. The mip chain is box
+ * filtered in floating point on the worker pool. Every level is then packed to RGB9_E5 or
+ * R11F_G11F_B10F with HdrPacker, or encoded to BC6H if that was requested and is supported, RGB9_E5 otherwise.
+ * Neither packed format is color renderable, so GPU mipmaps are generated on the CPU as well.
+ * 
+ * @param encoded Pointer to the encoded image
+ * @param size Size of the encoded image in bytes
+ * @param name Name used in error messages
+ * @param options Orientation, HDR format, resolution limit and whether mipmaps should be generated
+ * @param cacheKey Key of the image in the shared ImageCache, 0 to not cache it
+ * 
+ * @throws TextureLoadingException if texture failed to load
+ */
+void Texture::uploadHdr(const unsigned char *encoded, std::size_t size, const std::string &name, const TextureLoadOptions &options, std::uint64_t cacheKey)
+{
+	int fileChannels {};
+	StbiFloats data { stbi_loadf_from_memory(encoded, static_cast<int>(size), &_width, &_height, &fileChannels, 3) };
+	if (!data)
+		throw TextureLoadingException(failureMessage(name));
+	_nrChannels = 3;
+	std::vector<float> level(data.get(), data.get() + static_cast<std::size_t>(_width) * _height * 3);
+	data.reset();
+
+	const int largest { std::max(_width, _height) };
+	if (options.maxDimension > 0 && largest > options.maxDimension)
+	{
+		const double scale { static_cast<double>(options.maxDimension) / largest };
+		const int width { std::max(static_cast<int>(_width * scale + 0.5), 1) };
+		const int height { std::max(static_cast<int>(_height * scale + 0.5), 1) };
+		level = HdrPacker::resample(level, _width, _height, width, height);
+		spdlog::debug("Downscaled {} from {}x{} to {}x{}", name, _width, _height, width, height);
+		_width = width;
+		_height = height;
+	}
+
+	TextureLoadOptions::HdrFormat hdrFormat { options.hdrFormat };
+	if (hdrFormat == TextureLoadOptions::HdrFormat::BC6H && !BlockCompression::isSupported(BlockCompression::Format::BC6H, false))
+	{
+		spdlog::debug("BC6H not supported for {}, uploading RGB9_E5", name);
+		hdrFormat = TextureLoadOptions::HdrFormat::RGB9E5;
+	}
+	const bool compressed { hdrFormat == TextureLoadOptions::HdrFormat::BC6H };
+	const bool sharedExponent { hdrFormat == TextureLoadOptions::HdrFormat::RGB9E5 };
+	const GLenum internalFormat { compressed ? BlockCompression::getInternalFormat(BlockCompression::Format::BC6H, false) : sharedExponent ? GL_RGB9_E5 : GL_R11F_G11F_B10F };
+	const GLenum type { static_cast<GLenum>(sharedExponent ? GL_UNSIGNED_INT_5_9_9_9_REV : GL_UNSIGNED_INT_10F_11F_11F_REV) };
+
+	const std::size_t levelCount { options.mipmaps == TextureLoadOptions::Mipmaps::None ? 1 : MipChain::levelCountFor(_width, _height) };
+	std::vector<ImageCache::Level> levels(levelCount);
+	std::vector<std::size_t> offsets(levelCount);
+	std::size_t total { 0 };
+	for (std::size_t i = 0; i < levelCount; i++)
+	{
+		levels[i].width = std::max(_width >> i, 1);
+		levels[i].height = std::max(_height >> i, 1);
+		levels[i].size = compressed ? BlockCompression::getCompressedSize(BlockCompression::Format::BC6H, levels[i].width, levels[i].height)
+			: static_cast<std::size_t>(levels[i].width) * levels[i].height * sizeof(std::uint32_t);
+		offsets[i] = total;
+		total += levels[i].size;
+	}
+
+	// The staging memory is write only, levels which go into the cache as well are packed on the heap first
+	const bool caching { cacheKey != 0 && ImageCache::shared().isEnabled() };
+	std::vector<unsigned char> packed(caching ? total : 0);
+	PixelBufferRing &ring { stagingRing() };
+	PixelBufferRing::Segment segment { ring.acquire(total) };
+	unsigned char *staging { caching ? packed.data() : static_cast<unsigned char *>(segment.data) };
+
+	for (std::size_t i = 0; i < levelCount; i++)
+	{
+		if (i > 0)
+			level = HdrPacker::halve(level, levels[i - 1].width, levels[i - 1].height);
+		const std::size_t pixels { static_cast<std::size_t>(levels[i].width) * levels[i].height };
+		if (compressed)
+			BlockCompression::encodeHdr(level.data(), levels[i].width, levels[i].height, 3, staging + offsets[i]);
+		else if (sharedExponent)
+			HdrPacker::packRgb9E5(level.data(), pixels, reinterpret_cast<std::uint32_t *>(staging + offsets[i]));
+		else
+			HdrPacker::packR11G11B10F(level.data(), pixels, reinterpret_cast<std::uint32_t *>(staging + offsets[i]));
+		if (caching)
+			levels[i].data = packed.data() + offsets[i];
+	}
+	if (caching)
+		std::memcpy(segment.data, packed.data(), total);
+	const char *texels { static_cast<const char *>(ring.unpack(segment)) };
+
+	for (std::size_t i = 0; i < levelCount; i++)
+	{
+		if (compressed)
+			glCompressedTexImage2D(GL_TEXTURE_2D, i, internalFormat, levels[i].width, levels[i].height, 0, static_cast<GLsizei>(levels[i].size), texels + offsets[i]);
+		else
+			glTexImage2D(GL_TEXTURE_2D, i, internalFormat, levels[i].width, levels[i].height, 0, GL_RGB, type, texels + offsets[i]);
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+	ring.release(segment);
+	spdlog::debug("Uploaded {} as HDR, {} levels, {} bytes", name, levelCount, total);
+
+	if (caching)
+		ImageCache::shared().store(cacheKey, { static_cast<GLint>(internalFormat), static_cast<GLenum>(compressed ? GL_NONE : GL_RGB), compressed ? GL_NONE : type, compressed }, _nrChannels, levels);
+}
+
+/**
+ * @brief Uploads a payload from the decoded image cache
+ * 
+ * The levels are uploaded straight from the entry's mapping. Entries of images with GPU mipmaps only hold level 0,
+ * the rest is generated again.
+ * 
+ * @param entry The mapped cache entry
+ * @param name Name used in log messages
+ * @param options The options the image was loaded with
+ * 
+ * @returns false without uploading anything if the context cannot sample the entry's format, otherwise true
+ */
+bool Texture::uploadCached(ImageCache::Entry &entry, const std::string &name, const TextureLoadOptions &options)
+{
+	const ImageCache::Format &format { entry.format };
+	if (!isSampleable(format))
+	{
+		spdlog::debug("Cached payload of {} has a format this context cannot sample, decoding it", name);
+		return false;
+	}
+	_width = entry.levels.front().width;
+	_height = entry.levels.front().height;
+	_nrChannels = entry.channels;
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (std::size_t i = 0; i < entry.levels.size(); i++)
+	{
+		const ImageCache::Level &level { entry.levels[i] };
+		if (format.compressed)
+			glCompressedTexImage2D(GL_TEXTURE_2D, i, format.internalFormat, level.width, level.height, 0, static_cast<GLsizei>(level.size), level.data);
+		else
+			glTexImage2D(GL_TEXTURE_2D, i, format.internalFormat, level.width, level.height, 0, format.format, format.type, level.data);
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	if (!format.compressed && entry.levels.size() == 1 && options.mipmaps == TextureLoadOptions::Mipmaps::Gpu)
+		glGenerateMipmap(GL_TEXTURE_2D);
+	else
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, entry.levels.size() - 1);
+	spdlog::debug("Uploaded {} from the image cache ({} levels)", name, entry.levels.size());
+	return true;
+}
+
+/**
+ * @brief Uploads the mip levels of a KTX2 container as they are
+ * 
+ * Only levels from firstLevel down are uploaded and GL_TEXTURE_BASE_LEVEL is clamped to it, so the texture is
+ * complete while the larger levels are not resident.
+ * 
+ * @param container The parsed container
+ * @param name Name used in error messages
+ * @param firstLevel The largest level to upload
+ * 
+ * @throws TextureLoadingException if the context cannot sample the container's format
+ * @throws Ktx2::UnsupportedFormatException if the format is unknown
+ * @throws Ktx2::InvalidFileException if a supercompressed level is corrupt
+ */
+void Texture::uploadKtx2(Ktx2 &container, const std::string &name, std::size_t firstLevel)
+{
+	const Ktx2::GLFormat format { container.getGLFormat() };
+	if (!container.isSupported())
+	{
+		std::stringstream error {};
+		error << "Failed to load texture: " << name << ": vkFormat " << container.getVkFormat() << " is not supported by this context" << std::endl;
+		throw TextureLoadingException(error.str());
+	}
+	_width = container.getWidth();
+	_height = container.getHeight();
+	_nrChannels = format.format == GL_RED ? 1 : format.format == GL_RG ? 2 : format.format == GL_RGB ? 3 : 4;
+
+	const std::size_t levelCount { container.getLevelCount() };
+	_baseLevel = std::min(firstLevel, levelCount - 1);
+	uploadKtx2Levels(container, format, _baseLevel, levelCount);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, _baseLevel);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+	spdlog::debug("Uploaded levels {} to {} of {}", _baseLevel, levelCount - 1, name);
+}
+
+/**
+ * @brief Uploads a range of KTX2 levels into the bound texture
+ * 
+ * The levels need no decoding, so they are handed to glCompressedTexImage2D (or glTexImage2D for uncompressed
+ * formats) straight from the container's memory, usually a file mapping. zstd supercompressed levels are
+ * decompressed on the worker pool, one level per task, directly into a staging segment.
+ * 
+ * @param container The parsed container
+ * @param format The OpenGL formats of the container
+ * @param first The largest level to upload
+ * @param end One past the smallest level to upload
+ * 
+ * @throws Ktx2::InvalidFileException if a supercompressed level is corrupt
+ */
+void Texture::uploadKtx2Levels(Ktx2 &container, const Ktx2::GLFormat &format, std::size_t first, std::size_t end)
+{
+	std::vector<const unsigned char *> levels(end);
+	std::vector<std::size_t> sizes(end);
+	for (std::size_t i = first; i < end; i++)
+	{
+		levels[i] = container.getLevel(i).data;
+		sizes[i] = container.getLevel(i).size;
+	}
+
+	PixelBufferRing &ring { stagingRing() };
+	PixelBufferRing::Segment segment {};
+	const bool supercompressed { container.getSupercompression() != Ktx2::supercompressionNone };
+	if (supercompressed)
+	{
+		std::vector<std::size_t> offsets(end);
+		std::size_t total { 0 };
+		for (std::size_t i = first; i < end; i++)
+		{
+			offsets[i] = total;
+			sizes[i] = container.getLevel(i).uncompressedSize;
+			total += sizes[i];
+		}
+
+		segment = ring.acquire(total);
+		unsigned char *staging { static_cast<unsigned char *>(segment.data) };
+		try
+		{
+			ThreadPool::shared().parallelFor(first, end, [&](std::size_t begin, std::size_t last)
+			{
+				for (std::size_t i = begin; i < last; i++)
+					container.decompressLevel(i, staging + offsets[i]);
+			});
+		}
+		catch (...)
+		{
+			ring.unpack(segment);
+			ring.release(segment);
+			throw;
+		}
+
+		// With the staging buffer bound the level pointers are offsets into it
+		const unsigned char *base { static_cast<const unsigned char *>(ring.unpack(segment)) };
+		for (std::size_t i = first; i < end; i++)
+			levels[i] = base + offsets[i];
+	}
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (std::size_t i = first; i < end; i++)
+	{
+		const Ktx2::Level &level { container.getLevel(i) };
+		if (format.compressed)
+			glCompressedTexImage2D(GL_TEXTURE_2D, i, format.internalFormat, level.width, level.height, 0, static_cast<GLsizei>(sizes[i]), levels[i]);
+		else
+			glTexImage2D(GL_TEXTURE_2D, i, format.internalFormat, level.width, level.height, 0, format.format, format.type, levels[i]);
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	if (supercompressed)
+		ring.release(segment);
+}
+
+/**
+ * @brief Streams levels of a texture created from a KTX2 container in or out
+ * 
+ * Moving the base level down uploads the missing larger levels from the container. Moving it up clamps
+ * GL_TEXTURE_BASE_LEVEL first and then respecifies the dropped levels as empty images, which lets the driver
+ * release their memory. The texture stays complete throughout, so this works on plain OpenGL 3.3.
+ * 
+ * @param container The container the texture was created from
+ * @param baseLevel The largest level which should be resident
+ * 
+ * @throws Ktx2::InvalidFileException if a supercompressed level is corrupt
+ */
+void Texture::setResidentBaseLevel(Ktx2 &container, std::size_t baseLevel)
+{
+	baseLevel = std::min(baseLevel, container.getLevelCount() - 1);
+	if (baseLevel == _baseLevel)
+		return;
+
+	const Ktx2::GLFormat format { container.getGLFormat() };
+	this->bind();
+	if (baseLevel < _baseLevel)
+	{
+		uploadKtx2Levels(container, format, baseLevel, _baseLevel);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, baseLevel);
+	}
+	else
+	{
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, baseLevel);
+		for (std::size_t i = _baseLevel; i < baseLevel; i++)
+		{
+			if (format.compressed)
+				glCompressedTexImage2D(GL_TEXTURE_2D, i, format.internalFormat, 0, 0, 0, 0, nullptr);
+			else
+				glTexImage2D(GL_TEXTURE_2D, i, format.internalFormat, 0, 0, 0, format.format, format.type, nullptr);
+		}
+	}
+	_baseLevel = baseLevel;
+}
+
+/**
+ * @brief Getter for the largest resident level
+ * 
+ * @returns The texture's GL_TEXTURE_BASE_LEVEL, 0 unless it was streamed
+ */
+std::size_t Texture::getResidentBaseLevel()
+{
+	return _baseLevel;
+}
+
+/**
+ * @brief Sets which channels of the texture the shader reads as red, green, blue and alpha
+ * 
+ * Lets textures stored with fewer channels keep the channel layout shaders expect, e.g. roughness and metallic
+ * stored as GL_RG8 but read from green and blue like in a glTF metallicRoughness image.
+ * 
+ * @param red Source of red, one of GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA, GL_ZERO and GL_ONE
+ * @param green Source of green
+ * @param blue Source of blue
+ * @param alpha Source of alpha
+ */
+void Texture::setSwizzle(GLint red, GLint green, GLint blue, GLint alpha)
+{
+	const GLint swizzle[] { red, green, blue, alpha };
+	this->bind();
+	glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
 }
\ No newline at end of file
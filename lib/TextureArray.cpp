@@ -0,0 +1,298 @@
+#include <stb_image.h>
+#include "TextureArray.hpp"
+#include "Ktx2.hpp"
+#include "SamplerCache.hpp"
+#include "Texture.hpp"
+#include "JpegDecoder.hpp"
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <tuple>
+#include <utility>
+#include <spdlog/spdlog.h>
+
+namespace
+{
+	// Images can share an array if they decode to the same size and channels and load with the same options
+	using GroupKey = std::tuple<int, int, int, GLint, GLenum, GLenum, bool, TextureLoadOptions::Mipmaps, MipChain::Filter, bool, bool>;
+
+	GroupKey keyOf(int width, int height, int channels, const TextureLoadOptions &options)
+	{
+		return GroupKey { width, height, channels, options.internalFormat, options.format, options.type, options.flipVertically,
+			options.mipmaps, options.mipOptions.filter, options.mipOptions.srgb, options.mipOptions.premultipliedAlpha };
+	}
+
+	void decode(const TextureArray::Image &image, MipChain &chain)
+	{
+		const MipChain::Level &base { chain.getLevel(0) };
+		int width {}, height {}, fileChannels {};
+		const bool decoded { JpegDecoder::decode(image.encoded, image.size, chain.getChannels(), image.options.flipVertically, chain.getData(), base.size, width, height) };
+		if (!decoded || width != base.width || height != base.height)
+		{
+			stbi_set_flip_vertically_on_load_thread(image.options.flipVertically);
+			unsigned char *data { stbi_load_from_memory(image.encoded, static_cast<int>(image.size), &width, &height, &fileChannels, chain.getChannels()) };
+			if (!data)
+			{
+				std::stringstream error {};
+				error << "Failed to load texture array layer: " << stbi_failure_reason() << std::endl;
+				throw Texture::TextureLoadingException(error.str());
+			}
+			if (width != base.width || height != base.height)
+			{
+				stbi_image_free(data);
+				throw Texture::TextureLoadingException("Failed to load texture array layer: decoded size differs from the header\n");
+			}
+			std::memcpy(chain.getData(), data, base.size);
+			stbi_image_free(data);
+		}
+
+		if (image.options.mipmaps == TextureLoadOptions::Mipmaps::Cpu)
+			chain.generate(mipOptionsFor(image.options));
+	}
+}
+
+constexpr int TextureArray::defaultMaxDimension;
+
+/**
+ * @brief Constructor for TextureArray allocating storage for every layer and level
+ * 
+ * @param width Width of level 0 of every layer
+ * @param height Height of level 0 of every layer
+ * @param layerCount Number of layers
+ * @param levelCount Number of mip levels
+ * @param internalFormat The internal format of the array
+ */
+TextureArray::TextureArray(int width, int height, std::size_t layerCount, std::size_t levelCount, GLint internalFormat)
+	: _width { width }, _height { height }, _layerCount { layerCount }, _levelCount { levelCount }
+{
+	glGenTextures(1, &_id);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, _id);
+	for (std::size_t i = 0; i < levelCount; i++)
+	{
+		// The format and type only matter for the (absent) initial data
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, static_cast<GLint>(i), internalFormat, std::max(width >> i, 1), std::max(height >> i, 1),
+			static_cast<GLsizei>(layerCount), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	}
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(levelCount - 1));
+}
+
+/**
+ * @brief Move constructor for TextureArray
+ */
+TextureArray::TextureArray(TextureArray &&rhs)
+	: _id { rhs._id }, _width { rhs._width }, _height { rhs._height }, _layerCount { rhs._layerCount }, _levelCount { rhs._levelCount }
+{
+	rhs._id = 0;
+}
+
+/**
+ * @brief Destructor for TextureArray, deletes the OpenGL texture while a context is still current
+ */
+TextureArray::~TextureArray()
+{
+	if (_id && glfwGetCurrentContext())
+		glDeleteTextures(1, &_id);
+}
+
+/**
+ * @brief Move assignment operator for TextureArray
+ */
+TextureArray &TextureArray::operator=(TextureArray &&rhs)
+{
+	std::swap(_id, rhs._id);
+	_width = rhs._width;
+	_height = rhs._height;
+	_layerCount = rhs._layerCount;
+	_levelCount = rhs._levelCount;
+
+	return *this;
+}
+
+/**
+ * @brief Uploads the levels of a mip chain into a layer
+ * 
+ * @param layer The layer to fill
+ * @param chain A chain of the array's size
+ * @param levelCount Number of levels of the chain to upload, at most the array's level count
+ * @param format Pixel format of the chain, e.g. GL_RGBA
+ * @param type Component type of the chain, GL_UNSIGNED_BYTE
+ */
+void TextureArray::setLayer(std::size_t layer, MipChain &chain, std::size_t levelCount, GLenum format, GLenum type)
+{
+	glBindTexture(GL_TEXTURE_2D_ARRAY, _id);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (std::size_t i = 0; i < std::min(levelCount, _levelCount); i++)
+	{
+		const MipChain::Level &level { chain.getLevel(i) };
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, static_cast<GLint>(i), 0, 0, static_cast<GLint>(layer), level.width, level.height, 1, format, type, chain.getLevelData(i));
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+/**
+ * @brief Generates the mip levels of every layer from level 0 on the GPU
+ */
+void TextureArray::generateMipmaps()
+{
+	glBindTexture(GL_TEXTURE_2D_ARRAY, _id);
+	glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+}
+
+/**
+ * @brief Binds the array to a given texture unit with the default sampler
+ * 
+ * @param target The texture unit to bind to, e.g. GL_TEXTURE0
+ */
+void TextureArray::bind(GLenum target)
+{
+	bind(target, SamplerState {});
+}
+
+/**
+ * @brief Binds the array to a given texture unit, sampled with the shared sampler for a state
+ * 
+ * @param target The texture unit to bind to, e.g. GL_TEXTURE0
+ * @param sampler Wrap, filter and anisotropy parameters
+ */
+void TextureArray::bind(GLenum target, const SamplerState &sampler)
+{
+	glActiveTexture(target);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, _id);
+	SamplerCache::shared().bind(target, sampler);
+}
+
+/**
+ * @brief Getter for the OpenGL texture name
+ * 
+ * @returns The array's id
+ */
+GLuint TextureArray::getId()
+{
+	return _id;
+}
+
+/**
+ * @brief Getter for the width of the layers
+ * 
+ * @returns Width in texels
+ */
+int TextureArray::getWidth()
+{
+	return _width;
+}
+
+/**
+ * @brief Getter for the height of the layers
+ * 
+ * @returns Height in texels
+ */
+int TextureArray::getHeight()
+{
+	return _height;
+}
+
+/**
+ * @brief Getter for the number of layers
+ * 
+ * @returns Number of layers
+ */
+std::size_t TextureArray::getLayerCount()
+{
+	return _layerCount;
+}
+
+/**
+ * @brief Packs the small images of a model into texture arrays
+ * 
+ * Images no larger than maxDimension are grouped by size, channel count and load options, every group of at least
+ * two images becomes one or more arrays (split at GL_MAX_ARRAY_TEXTURE_LAYERS). The images of a group are decoded
+ * in parallel. Block compressed and KTX2 images are left alone, as are images that can't be decoded, so the
+ * caller loads them as a regular Texture and gets the usual error.
+ * 
+ * @param images The images of the model, with the options they would be loaded as a Texture with
+ * @param arrays The arrays are appended to this
+ * @param maxDimension Images with a larger width or height are left alone
+ * @param pool The pool to decode and filter on. Defaults to the shared pool
+ * 
+ * @returns For every image the array (index into arrays) and layer, or -1 if it wasn't packed
+ * 
+ * @throws Texture::TextureLoadingException if an image passed the header check but failed to decode
+ */
+std::vector<TextureArray::Placement> TextureArray::pack(const std::vector<Image> &images, std::vector<TextureArray> &arrays, int maxDimension, ThreadPool &pool)
+{
+	std::vector<Placement> placements(images.size());
+	std::map<GroupKey, std::vector<std::size_t>> groups {};
+	for (std::size_t i = 0; i < images.size(); i++)
+	{
+		const Image &image { images[i] };
+		int width {}, height {}, channels {};
+		if (image.options.compression != TextureLoadOptions::Compression::None || image.options.normalMap || Ktx2::isKtx2(image.encoded, image.size))
+			continue;
+		if (image.options.hdrFormat != TextureLoadOptions::HdrFormat::None && stbi_is_hdr_from_memory(image.encoded, static_cast<int>(image.size)))
+			continue;
+		if (!stbi_info_from_memory(image.encoded, static_cast<int>(image.size), &width, &height, &channels) || std::max(width, height) > maxDimension)
+			continue;
+		// Images which are downscaled at load are left to Texture
+		if (image.options.maxDimension > 0 && std::max(width, height) > image.options.maxDimension)
+			continue;
+		groups[keyOf(width, height, channels, image.options)].push_back(i);
+	}
+
+	GLint maxLayers {};
+	glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+	for (const auto &group : groups)
+	{
+		const std::vector<std::size_t> &members { group.second };
+		if (members.size() < 2)
+			continue;
+
+		const int width { std::get<0>(group.first) };
+		const int height { std::get<1>(group.first) };
+		const int channels { std::get<2>(group.first) };
+		const TextureLoadOptions &options { images[members.front()].options };
+		for (std::size_t first = 0; first < members.size(); first += static_cast<std::size_t>(maxLayers))
+		{
+			const std::size_t count { std::min(members.size() - first, static_cast<std::size_t>(maxLayers)) };
+			std::vector<MipChain> chains(count, MipChain { width, height, channels });
+			pool.parallelFor(0, count, [&](std::size_t begin, std::size_t end)
+			{
+				for (std::size_t i = begin; i < end; i++)
+					decode(images[members[first + i]], chains[i]);
+			});
+
+			const std::size_t levelCount { options.mipmaps == TextureLoadOptions::Mipmaps::None ? 1 : chains.front().getLevelCount() };
+			TextureArray array { width, height, count, levelCount, options.internalFormat };
+			const std::size_t uploadedLevels { options.mipmaps == TextureLoadOptions::Mipmaps::Cpu ? levelCount : 1 };
+			for (std::size_t i = 0; i < count; i++)
+			{
+				array.setLayer(i, chains[i], uploadedLevels, options.format, options.type);
+				placements[members[first + i]] = { static_cast<int>(arrays.size()), static_cast<int>(i) };
+			}
+			if (options.mipmaps == TextureLoadOptions::Mipmaps::Gpu)
+				array.generateMipmaps();
+			arrays.push_back(std::move(array));
+			spdlog::debug("Packed {} textures of {}x{} into a texture array", count, width, height);
+		}
+	}
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	return placements;
+}
+
+/**
+ * @brief Points the texture references of materials at the layers their images were packed into
+ * 
+ * @param materials Materials referencing images by index
+ * @param placements The result of pack() for the same images
+ */
+void TextureArray::remap(std::vector<Material> &materials, const std::vector<Placement> &placements)
+{
+	for (Material &material : materials)
+		for (Material::TextureRef *ref : { &material.baseColor, &material.metallicRoughness, &material.normal, &material.occlusion, &material.emissive })
+		{
+			const bool packed { ref->image >= 0 && static_cast<std::size_t>(ref->image) < placements.size() && placements[ref->image].array >= 0 };
+			ref->array = packed ? placements[ref->image].array : -1;
+			ref->layer = packed ? placements[ref->image].layer : -1;
+		}
+}
\ No newline at end of file
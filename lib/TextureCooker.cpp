@@ -0,0 +1,194 @@
+#include <stb_image.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <sstream>
+#include <spdlog/spdlog.h>
+#include "TextureCooker.hpp"
+#include "BlockCompression.hpp"
+#include "HdrPacker.hpp"
+#include "JpegDecoder.hpp"
+#include "Ktx2.hpp"
+#include "Texture.hpp"
+
+namespace
+{
+	constexpr int hdrChannels { 3 };
+
+	std::string failureMessage()
+	{
+		std::stringstream error {};
+		error << "Failed to cook texture: " << stbi_failure_reason() << std::endl;
+		return error.str();
+	}
+
+	std::vector<unsigned char> cookHdr(const unsigned char *encoded, std::size_t size, ThreadPool &pool)
+	{
+		int width {}, height {}, fileChannels {};
+		float *data { stbi_loadf_from_memory(encoded, static_cast<int>(size), &width, &height, &fileChannels, hdrChannels) };
+		if (!data)
+			throw TextureCooker::CookingException(failureMessage());
+		std::vector<float> level(data, data + static_cast<std::size_t>(width) * height * hdrChannels);
+		stbi_image_free(data);
+
+		std::vector<std::vector<unsigned char>> levels {};
+		int levelWidth { width }, levelHeight { height };
+		for (std::size_t i = 0; i < MipChain::levelCountFor(width, height); i++)
+		{
+			if (i > 0)
+			{
+				level = HdrPacker::halve(level, levelWidth, levelHeight, pool);
+				levelWidth = std::max(levelWidth / 2, 1);
+				levelHeight = std::max(levelHeight / 2, 1);
+			}
+			std::vector<unsigned char> blocks(BlockCompression::getCompressedSize(BlockCompression::Format::BC6H, levelWidth, levelHeight));
+			BlockCompression::encodeHdr(level.data(), levelWidth, levelHeight, hdrChannels, blocks.data(), pool);
+			levels.push_back(std::move(blocks));
+		}
+		return Ktx2::encode(Ktx2::formatBC6HUfloat, width, height, levels);
+	}
+
+	std::vector<unsigned char> cookLdr(const unsigned char *encoded, std::size_t size, const TextureCooker::Options &options, ThreadPool &pool)
+	{
+		int width {}, height {}, fileChannels {};
+		if (!stbi_info_from_memory(encoded, static_cast<int>(size), &width, &height, &fileChannels))
+			throw TextureCooker::CookingException(failureMessage());
+
+		MipChain chain { width, height, 4 };
+		const std::size_t baseSize { chain.getLevel(0).size };
+		int decodedWidth {}, decodedHeight {};
+		const bool decoded { JpegDecoder::decode(encoded, size, 4, options.flipVertically, chain.getData(), baseSize, decodedWidth, decodedHeight) };
+		if (!decoded || decodedWidth != width || decodedHeight != height)
+		{
+			unsigned char *data { stbi_load_from_memory(encoded, static_cast<int>(size), &decodedWidth, &decodedHeight, &fileChannels, 4) };
+			if (!data)
+				throw TextureCooker::CookingException(failureMessage());
+			if (decodedWidth != width || decodedHeight != height)
+			{
+				stbi_image_free(data);
+				throw TextureCooker::CookingException("Failed to cook texture: decoded size differs from the header\n");
+			}
+			std::memcpy(chain.getData(), data, baseSize);
+			stbi_image_free(data);
+		}
+
+		MipChain::Options mipOptions {};
+		mipOptions.filter = options.filter;
+		mipOptions.srgb = options.srgb;
+		chain.generate(mipOptions, pool);
+
+		std::vector<std::vector<unsigned char>> levels {};
+		for (std::size_t i = 0; i < chain.getLevelCount(); i++)
+		{
+			const MipChain::Level &level { chain.getLevel(i) };
+			std::vector<unsigned char> blocks(BlockCompression::getCompressedSize(BlockCompression::Format::BC7, level.width, level.height));
+			BlockCompression::encode(BlockCompression::Format::BC7, chain.getLevelData(i), level.width, level.height, 4, blocks.data(), pool);
+			levels.push_back(std::move(blocks));
+		}
+		return Ktx2::encode(options.srgb ? Ktx2::formatBC7Srgb : Ktx2::formatBC7, width, height, levels);
+	}
+}
+
+/**
+ * @brief Cooks an encoded image in memory into a KTX2 container
+ * 
+ * @param encoded Pointer to the encoded image file (PNG, JPEG, HDR, ...)
+ * @param size Size of the encoded image in bytes
+ * @param options Color space, orientation and mip filter. HDR images are always linear and box filtered
+ * @param pool The pool to filter and encode on. Defaults to the shared pool
+ * 
+ * @returns The KTX2 container with a full mip chain, BC6H for HDR images and BC7 otherwise
+ * 
+ * @throws CookingException if the image could not be decoded
+ */
+std::vector<unsigned char> TextureCooker::cook(const unsigned char *encoded, std::size_t size, const Options &options, ThreadPool &pool)
+{
+	// Flip per thread, cookAll() runs several images with different options at once
+	stbi_set_flip_vertically_on_load_thread(options.flipVertically);
+
+	if (stbi_is_hdr_from_memory(encoded, static_cast<int>(size)))
+		return cookHdr(encoded, size, pool);
+	return cookLdr(encoded, size, options, pool);
+}
+
+/**
+ * @brief Cooks an image file into a KTX2 file
+ * 
+ * @param source Path to the image file
+ * @param destination Path of the KTX2 file to write
+ * @param options Color space, orientation and mip filter
+ * @param pool The pool to filter and encode on. Defaults to the shared pool
+ * 
+ * @throws CookingException if the image could not be read or decoded, or the output could not be written
+ */
+void TextureCooker::cookFile(const std::string &source, const std::string &destination, const Options &options, ThreadPool &pool)
+{
+	std::vector<unsigned char> encoded {};
+	try
+	{
+		encoded = Texture::readFile(source);
+	}
+	catch (const Texture::TextureLoadingException &)
+	{
+		std::stringstream error {};
+		error << "Failed to read texture: " << source << std::endl;
+		throw CookingException(error.str());
+	}
+
+	std::vector<unsigned char> cooked {};
+	try
+	{
+		cooked = cook(encoded.data(), encoded.size(), options, pool);
+	}
+	catch (const CookingException &e)
+	{
+		std::stringstream error {};
+		error << source << ": " << e.what();
+		throw CookingException(error.str());
+	}
+
+	std::ofstream os { destination, std::ios::binary };
+	os.write(reinterpret_cast<const char *>(cooked.data()), static_cast<std::streamsize>(cooked.size()));
+	if (!os)
+	{
+		std::stringstream error {};
+		error << "Failed to write cooked texture: " << destination << std::endl;
+		throw CookingException(error.str());
+	}
+	spdlog::debug("Cooked {} into {} ({} bytes)", source, destination, cooked.size());
+}
+
+/**
+ * @brief Cooks several images in parallel
+ * 
+ * Every image runs as its own task on the pool while its levels are encoded with parallelFor, so small images
+ * don't leave workers idle and large ones are still split up.
+ * 
+ * @param jobs Source, destination and options of every image
+ * @param pool The pool to cook on. Defaults to the shared pool
+ * 
+ * @throws CookingException for the first image which failed, after all images have finished
+ */
+void TextureCooker::cookAll(const std::vector<Job> &jobs, ThreadPool &pool)
+{
+	std::vector<std::future<void>> results {};
+	for (const Job &job : jobs)
+		results.push_back(pool.submit([&job, &pool]() { cookFile(job.source, job.destination, job.options, pool); }));
+
+	std::exception_ptr error {};
+	for (std::future<void> &result : results)
+	{
+		try
+		{
+			result.get();
+		}
+		catch (...)
+		{
+			if (!error)
+				error = std::current_exception();
+		}
+	}
+	if (error)
+		std::rethrow_exception(error);
+}
\ No newline at end of file
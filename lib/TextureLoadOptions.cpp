@@ -0,0 +1,56 @@
+#include "TextureLoadOptions.hpp"
+#include "Hash.hpp"
+
+/**
+ * @brief Hashes every option influencing the decoded and uploaded texture
+ * 
+ * Shared by TextureManager and ImageCache, so a new option only has to be added here to keep both apart.
+ * 
+ * @param options The options
+ * @param seed Hash to combine the options with, e.g. of the encoded bytes
+ * 
+ * @returns The combined hash
+ */
+std::uint64_t hashOptions(const TextureLoadOptions &options, std::uint64_t seed)
+{
+	std::uint64_t key { hashCombine(seed, static_cast<std::uint64_t>(options.internalFormat)) };
+	key = hashCombine(key, options.format);
+	key = hashCombine(key, options.type);
+	key = hashCombine(key, options.flipVertically);
+	key = hashCombine(key, static_cast<std::uint64_t>(options.mipmaps));
+	key = hashCombine(key, static_cast<std::uint64_t>(options.mipOptions.filter));
+	key = hashCombine(key, options.mipOptions.srgb);
+	key = hashCombine(key, options.mipOptions.premultipliedAlpha);
+	key = hashCombine(key, static_cast<std::uint64_t>(options.compression));
+	key = hashCombine(key, static_cast<std::uint64_t>(options.maxDimension));
+	key = hashCombine(key, options.normalMap);
+	return hashCombine(key, static_cast<std::uint64_t>(options.hdrFormat));
+}
+
+/**
+ * @brief Checks whether an uncompressed internal format stores sRGB encoded color
+ * 
+ * @param internalFormat The internal format
+ * 
+ * @returns True for the sRGB formats
+ */
+bool isSrgbFormat(GLint internalFormat)
+{
+	return internalFormat == GL_SRGB || internalFormat == GL_SRGB8 || internalFormat == GL_SRGB_ALPHA || internalFormat == GL_SRGB8_ALPHA8;
+}
+
+/**
+ * @brief Gets the options to filter the mip chain of a texture loaded with some options with
+ * 
+ * sRGB textures are always filtered in linear light, everything else only if options.mipOptions.srgb is set.
+ * 
+ * @param options The load options
+ * 
+ * @returns The mip filter options
+ */
+MipChain::Options mipOptionsFor(const TextureLoadOptions &options)
+{
+	MipChain::Options resolved { options.mipOptions };
+	resolved.srgb = resolved.srgb || isSrgbFormat(options.internalFormat);
+	return resolved;
+}
\ No newline at end of file
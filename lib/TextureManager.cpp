@@ -0,0 +1,126 @@
+#include "TextureManager.hpp"
+#include "Hash.hpp"
+#include <sstream>
+#include <utility>
+#include <spdlog/spdlog.h>
+
+namespace
+{
+	std::string uriKey(const std::string &uri, std::uint64_t options)
+	{
+		std::stringstream ss {};
+		ss << uri << '#' << std::hex << options;
+		return ss.str();
+	}
+}
+
+/**
+ * @brief Constructor for TextureManager uploading textures with Texture's options constructor
+ */
+TextureManager::TextureManager()
+	: _loader { [](const unsigned char *encoded, std::size_t size, const TextureLoadOptions &options)
+	{
+		return std::make_shared<Texture>(encoded, size, GL_TEXTURE0, options);
+	} }
+{
+}
+
+/**
+ * @brief Constructor for TextureManager creating textures with a custom loader, e.g. to count loads in tests
+ * 
+ * @param loader Called with the encoded image and options whenever no live texture matches
+ */
+TextureManager::TextureManager(Loader loader) : _loader { std::move(loader) }
+{
+}
+
+/**
+ * @brief Gets a texture for an image file, loading it only if no live texture has the same URI or content
+ * 
+ * @param uri Path of the image file
+ * @param options Decode and upload options. Defaults to TextureLoadOptions {}
+ * 
+ * @returns Shared handle to the texture
+ * 
+ * @throws Texture::TextureLoadingException if texture failed to load
+ */
+TextureManager::Handle TextureManager::load(const std::string &uri, const TextureLoadOptions &options)
+{
+	std::string key { uriKey(uri, hashOptions(options)) };
+	auto found { _byUri.find(key) };
+	if (found != _byUri.end())
+	{
+		if (Handle texture = found->second.lock())
+			return texture;
+	}
+
+	MappedFile file { Texture::mapFile(uri) };
+	std::uint64_t contentKey { hashOptions(options, hashBytes(file.getData(), file.getSize())) };
+	Handle texture { findOrCreate(contentKey, file.getData(), file.getSize(), options) };
+	_byUri[key] = texture;
+
+	return texture;
+}
+
+/**
+ * @brief Gets a texture for an encoded image in memory, e.g. a glTF buffer view, loading it only if no live
+ * texture has the same content
+ * 
+ * @param encoded Pointer to the encoded image
+ * @param size Size of the encoded image in bytes
+ * @param options Decode and upload options. Defaults to TextureLoadOptions {}
+ * 
+ * @returns Shared handle to the texture
+ * 
+ * @throws Texture::TextureLoadingException if texture failed to load
+ */
+TextureManager::Handle TextureManager::load(const unsigned char *encoded, std::size_t size, const TextureLoadOptions &options)
+{
+	std::uint64_t contentKey { hashOptions(options, hashBytes(encoded, size)) };
+	return findOrCreate(contentKey, encoded, size, options);
+}
+
+/**
+ * @brief Counts the textures which are still referenced by at least one handle
+ * 
+ * @returns Number of live textures
+ */
+std::size_t TextureManager::getLiveCount()
+{
+	purge();
+	return _byContent.size();
+}
+
+/**
+ * @brief Forgets entries whose textures have been released
+ */
+void TextureManager::purge()
+{
+	for (auto it = _byUri.begin(); it != _byUri.end();)
+		it = it->second.expired() ? _byUri.erase(it) : std::next(it);
+	for (auto it = _byContent.begin(); it != _byContent.end();)
+		it = it->second.expired() ? _byContent.erase(it) : std::next(it);
+}
+
+/**
+ * @brief Looks up a texture by content key, decoding and uploading it on a miss
+ */
+TextureManager::Handle TextureManager::findOrCreate(std::uint64_t contentKey, const unsigned char *encoded, std::size_t size, const TextureLoadOptions &options)
+{
+	auto found { _byContent.find(contentKey) };
+	if (found != _byContent.end())
+	{
+		if (Handle texture = found->second.lock())
+		{
+			spdlog::debug("Reusing texture {:016x} for identical image content", contentKey);
+			return texture;
+		}
+	}
+
+	Handle texture { _loader(encoded, size, options) };
+	_byContent[contentKey] = texture;
+	if (_byContent.size() % 64 == 0)
+		purge();
+
+	return texture;
+}
\ No newline at end of file
@@ -0,0 +1,288 @@
+#include "TextureStreamer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <spdlog/spdlog.h>
+
+namespace
+{
+	constexpr float minDistance { 0.01f };
+
+	// The first level which fits within tailDimension, everything from it down is always resident
+	std::size_t tailLevelOf(Ktx2 &container)
+	{
+		std::size_t level { 0 };
+		while (level + 1 < container.getLevelCount() && std::max(container.getLevel(level).width, container.getLevel(level).height) > TextureStreamer::tailDimension)
+			level++;
+		return level;
+	}
+}
+
+constexpr int TextureStreamer::tailDimension;
+constexpr std::size_t TextureStreamer::defaultUploadBudget;
+
+TextureStreamer::Entry::Entry(MappedFile &&mapped, GLenum target)
+	: file { std::move(mapped) }, container { file.getData(), file.getSize() }, texture { container, target, tailLevelOf(container) },
+	tailLevel { tailLevelOf(container) }, desiredLevel { tailLevel }
+{
+}
+
+/**
+ * @brief Constructor for TextureStreamer
+ * 
+ * @param budget Number of bytes the resident levels of all textures may take up
+ */
+TextureStreamer::TextureStreamer(std::size_t budget) : _budget { budget }
+{
+}
+
+/**
+ * @brief Adds a KTX2 texture, uploading only its mip tail
+ * 
+ * The file stays mapped so levels can be streamed in later without touching the rest of the file.
+ * 
+ * @param path Path of the KTX2 file
+ * @param target The texture unit the texture binds to by default
+ * 
+ * @returns Id of the texture within this streamer
+ * 
+ * @throws Texture::TextureLoadingException if the file could not be mapped or is not a supported KTX2 texture
+ */
+TextureStreamer::Id TextureStreamer::add(const std::string &path, GLenum target)
+{
+	std::unique_ptr<Entry> entry {};
+	try
+	{
+		entry.reset(new Entry(Texture::mapFile(path), target));
+	}
+	catch (const std::runtime_error &e)
+	{
+		std::stringstream error {};
+		error << "Failed to stream texture: " << path << ": " << e.what();
+		throw Texture::TextureLoadingException(error.str());
+	}
+
+	for (std::size_t i = entry->tailLevel; i < entry->container.getLevelCount(); i++)
+		_residentBytes += levelBytes(*entry, i);
+	_entries.push_back(std::move(entry));
+	makeRoom(0, _entries.back().get());
+
+	return _entries.size() - 1;
+}
+
+/**
+ * @brief Records that a texture is drawn this frame
+ * 
+ * May be called once per draw, the use needing the most detail wins.
+ * 
+ * @param id Id returned by add()
+ * @param center World space center of the mesh's bounding sphere
+ * @param radius Radius of the mesh's bounding sphere
+ * @param uvDensity UV units per world unit of the mesh, see computeUvDensity()
+ */
+void TextureStreamer::request(Id id, const glm::vec3 &center, float radius, float uvDensity)
+{
+	_entries.at(id)->uses.push_back({ center, radius, uvDensity });
+}
+
+/**
+ * @brief Turns this frame's requests into desired levels and streams levels in or out
+ * 
+ * Textures missing the most levels are served first, one level per texture per round, so every visible texture
+ * sharpens gradually instead of one texture taking the whole upload budget. Room is made by dropping the finest
+ * levels of the least recently used textures; textures used this frame only give up levels they don't need.
+ * 
+ * @param camera The camera the frame is rendered with
+ * @param viewportHeight Height of the viewport in pixels
+ * @param uploadBudget Number of bytes which may be uploaded this frame
+ */
+void TextureStreamer::update(Camera &camera, int viewportHeight, std::size_t uploadBudget)
+{
+	std::vector<Entry *> wanting {};
+	for (std::unique_ptr<Entry> &entry : _entries)
+	{
+		if (entry->uses.empty())
+			continue;
+
+		entry->desiredLevel = entry->tailLevel;
+		for (const Use &use : entry->uses)
+		{
+			const float distance { glm::length(use.center - camera.getPosition()) - use.radius };
+			const std::size_t level { computeDesiredLevel(distance, camera.getFov(), viewportHeight, use.uvDensity, entry->container.getWidth(), entry->container.getLevelCount()) };
+			entry->desiredLevel = std::min(entry->desiredLevel, level);
+		}
+		entry->uses.clear();
+		entry->lastUsed = _frame;
+		if (entry->desiredLevel < entry->texture.getResidentBaseLevel())
+			wanting.push_back(entry.get());
+	}
+
+	std::sort(wanting.begin(), wanting.end(), [](Entry *a, Entry *b)
+	{
+		return a->texture.getResidentBaseLevel() - a->desiredLevel > b->texture.getResidentBaseLevel() - b->desiredLevel;
+	});
+
+	std::size_t uploaded { 0 };
+	bool progress { true };
+	while (progress)
+	{
+		progress = false;
+		for (Entry *entry : wanting)
+		{
+			const std::size_t base { entry->texture.getResidentBaseLevel() };
+			if (base <= entry->desiredLevel)
+				continue;
+			const std::size_t bytes { levelBytes(*entry, base - 1) };
+			if (uploaded + bytes > uploadBudget)
+				continue;
+			if (!makeRoom(bytes, entry))
+				continue;
+
+			setBaseLevel(*entry, base - 1);
+			uploaded += bytes;
+			progress = true;
+		}
+	}
+
+	if (uploaded > 0)
+		spdlog::debug("Streamed {} bytes of texture levels, {} of {} bytes resident", uploaded, _residentBytes, _budget);
+	_frame++;
+}
+
+/**
+ * @brief Gets a streamed texture for binding
+ * 
+ * @param id Id returned by add()
+ * 
+ * @returns The texture
+ */
+Texture &TextureStreamer::getTexture(Id id)
+{
+	return _entries.at(id)->texture;
+}
+
+/**
+ * @brief Getter for the memory taken up by resident levels
+ * 
+ * @returns Bytes of all resident levels
+ */
+std::size_t TextureStreamer::getResidentBytes()
+{
+	return _residentBytes;
+}
+
+/**
+ * @brief Getter for the memory budget
+ * 
+ * @returns Number of bytes resident levels may take up
+ */
+std::size_t TextureStreamer::getBudget()
+{
+	return _budget;
+}
+
+/**
+ * @brief Changes the memory budget, evicting levels right away if it shrank
+ * 
+ * @param budget Number of bytes resident levels may take up
+ */
+void TextureStreamer::setBudget(std::size_t budget)
+{
+	_budget = budget;
+	makeRoom(0, nullptr);
+}
+
+/**
+ * @brief Computes how many UV units a mesh maps onto one world unit
+ * 
+ * Uses the ratio of total UV area to total world space area, which is what matters for the average texel
+ * density of the mesh on screen.
+ * 
+ * @param positions World (or model) space vertex positions
+ * @param uvs Texture coordinates of the vertices
+ * @param indices Triangle list indices
+ * 
+ * @returns UV units per world unit, 0 for degenerate meshes
+ */
+float TextureStreamer::computeUvDensity(const std::vector<glm::vec3> &positions, const std::vector<glm::vec2> &uvs, const std::vector<unsigned int> &indices)
+{
+	float worldArea { 0.0f };
+	float uvArea { 0.0f };
+	for (std::size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		const glm::vec3 &a { positions[indices[i]] }, &b { positions[indices[i + 1]] }, &c { positions[indices[i + 2]] };
+		const glm::vec2 &ta { uvs[indices[i]] }, &tb { uvs[indices[i + 1]] }, &tc { uvs[indices[i + 2]] };
+		worldArea += 0.5f * glm::length(glm::cross(b - a, c - a));
+		uvArea += 0.5f * std::fabs((tb.x - ta.x) * (tc.y - ta.y) - (tc.x - ta.x) * (tb.y - ta.y));
+	}
+	return worldArea > 0.0f ? std::sqrt(uvArea / worldArea) : 0.0f;
+}
+
+/**
+ * @brief Computes the mip level whose texels map to about one pixel on screen
+ * 
+ * @param distance Distance from the eye to the nearest point of the mesh
+ * @param fov Vertical field of view in degrees
+ * @param viewportHeight Height of the viewport in pixels
+ * @param uvDensity UV units per world unit of the mesh
+ * @param width Width of level 0 of the texture in texels
+ * @param levelCount Number of levels of the texture
+ * 
+ * @returns The largest level needed, 0 being the largest
+ */
+std::size_t TextureStreamer::computeDesiredLevel(float distance, float fov, int viewportHeight, float uvDensity, int width, std::size_t levelCount)
+{
+	const float pixelsPerUnit { viewportHeight / (2.0f * std::max(distance, minDistance) * std::tan(glm::radians(fov) * 0.5f)) };
+	const float texelsPerPixel { uvDensity * width / pixelsPerUnit };
+	if (texelsPerPixel <= 1.0f)
+		return 0;
+	return std::min(static_cast<std::size_t>(std::log2(texelsPerPixel)), levelCount - 1);
+}
+
+std::size_t TextureStreamer::levelBytes(Entry &entry, std::size_t level)
+{
+	return entry.container.getLevel(level).uncompressedSize;
+}
+
+/**
+ * @brief Evicts levels until the given number of bytes fits into the budget
+ * 
+ * Victims are textures not used this frame, least recently used first, then textures holding more levels than
+ * they want. The mip tail is never evicted.
+ * 
+ * @returns false if not enough levels could be evicted
+ */
+bool TextureStreamer::makeRoom(std::size_t bytes, Entry *keep)
+{
+	while (_residentBytes + bytes > _budget)
+	{
+		Entry *victim { nullptr };
+		for (std::unique_ptr<Entry> &entry : _entries)
+		{
+			const std::size_t base { entry->texture.getResidentBaseLevel() };
+			if (entry.get() == keep || base >= entry->tailLevel)
+				continue;
+			if (entry->lastUsed == _frame && base >= entry->desiredLevel)
+				continue;
+			if (!victim || entry->lastUsed < victim->lastUsed)
+				victim = entry.get();
+		}
+		if (!victim)
+			return false;
+		setBaseLevel(*victim, victim->texture.getResidentBaseLevel() + 1);
+	}
+	return true;
+}
+
+void TextureStreamer::setBaseLevel(Entry &entry, std::size_t level)
+{
+	const std::size_t base { entry.texture.getResidentBaseLevel() };
+	for (std::size_t i = std::min(base, level); i < std::max(base, level); i++)
+	{
+		if (level < base)
+			_residentBytes += levelBytes(entry, i);
+		else
+			_residentBytes -= levelBytes(entry, i);
+	}
+	entry.texture.setResidentBaseLevel(entry.container, level);
+}
\ No newline at end of file
@@ -0,0 +1,160 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <spdlog/spdlog.h>
+
+namespace
+{
+	struct ParallelForState
+	{
+		std::size_t begin {};
+		std::size_t end {};
+		std::size_t grain {};
+		std::size_t chunkCount {};
+		std::function<void(std::size_t, std::size_t)> body {};
+		std::atomic<std::size_t> next { 0 };
+		std::atomic<std::size_t> done { 0 };
+		std::mutex mutex {};
+		std::condition_variable finished {};
+		std::exception_ptr error {};
+	};
+
+	void runChunks(ParallelForState &state)
+	{
+		std::size_t chunk {};
+		while ((chunk = state.next.fetch_add(1)) < state.chunkCount)
+		{
+			std::size_t chunkBegin { state.begin + chunk * state.grain };
+			std::size_t chunkEnd { std::min(chunkBegin + state.grain, state.end) };
+			try
+			{
+				state.body(chunkBegin, chunkEnd);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock { state.mutex };
+				if (!state.error)
+					state.error = std::current_exception();
+			}
+			if (state.done.fetch_add(1) + 1 == state.chunkCount)
+			{
+				std::lock_guard<std::mutex> lock { state.mutex };
+				state.finished.notify_all();
+			}
+		}
+	}
+}
+
+/**
+ * @brief Constructor for ThreadPool starting a number of worker threads
+ * 
+ * @param threadCount Number of workers, at least one is always started
+ */
+ThreadPool::ThreadPool(unsigned threadCount)
+{
+	threadCount = std::max(threadCount, 1u);
+	for (unsigned i = 0; i < threadCount; i++)
+		_workers.emplace_back([this]() { work(); });
+	spdlog::debug("Started thread pool with {} workers", threadCount);
+}
+
+/**
+ * @brief Destructor for ThreadPool, finishes queued jobs and joins the workers
+ */
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock { _mutex };
+		_stopping = true;
+	}
+	_condition.notify_all();
+	for (std::thread &worker : _workers)
+		worker.join();
+}
+
+/**
+ * @brief Calls body over [begin, end) split into chunks, in parallel, and waits for all of them
+ * 
+ * @param begin First index
+ * @param end One past the last index
+ * @param body Called with the bounds of each chunk
+ * @param grain Number of indices per chunk. Defaults to 1
+ * 
+ * @throws Rethrows the first exception thrown by body
+ */
+void ThreadPool::parallelFor(std::size_t begin, std::size_t end, const std::function<void(std::size_t, std::size_t)> &body, std::size_t grain)
+{
+	if (begin >= end)
+		return;
+
+	auto state { std::make_shared<ParallelForState>() };
+	state->begin = begin;
+	state->end = end;
+	state->grain = std::max<std::size_t>(grain, 1);
+	state->chunkCount = (end - begin + state->grain - 1) / state->grain;
+	state->body = body;
+
+	std::size_t helpers { std::min<std::size_t>(_workers.size(), state->chunkCount - 1) };
+	for (std::size_t i = 0; i < helpers; i++)
+		enqueue([state]() { runChunks(*state); });
+	runChunks(*state);
+
+	std::unique_lock<std::mutex> lock { state->mutex };
+	state->finished.wait(lock, [&state]() { return state->done.load() == state->chunkCount; });
+	if (state->error)
+		std::rethrow_exception(state->error);
+}
+
+/**
+ * @brief Getter for the number of worker threads
+ * 
+ * @returns Number of workers
+ */
+unsigned ThreadPool::getThreadCount()
+{
+	return static_cast<unsigned>(_workers.size());
+}
+
+/**
+ * @brief Gets the pool shared by the loaders, sized to the machine, creating it on first use
+ * 
+ * @returns The shared ThreadPool
+ */
+ThreadPool &ThreadPool::shared()
+{
+	static ThreadPool pool { std::max(std::thread::hardware_concurrency(), 2u) - 1 };
+	return pool;
+}
+
+/**
+ * @brief Queues a job and wakes a worker
+ */
+void ThreadPool::enqueue(std::function<void()> job)
+{
+	{
+		std::lock_guard<std::mutex> lock { _mutex };
+		_jobs.push(std::move(job));
+	}
+	_condition.notify_one();
+}
+
+/**
+ * @brief Worker loop, runs jobs until the pool is stopped and drained
+ */
+void ThreadPool::work()
+{
+	while (true)
+	{
+		std::function<void()> job {};
+		{
+			std::unique_lock<std::mutex> lock { _mutex };
+			_condition.wait(lock, [this]() { return _stopping || !_jobs.empty(); });
+			if (_jobs.empty())
+				return;
+			job = std::move(_jobs.front());
+			_jobs.pop();
+		}
+		job();
+	}
+}
\ No newline at end of file
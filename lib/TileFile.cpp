@@ -0,0 +1,283 @@
+#include "TileFile.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <spdlog/spdlog.h>
+
+namespace
+{
+	constexpr unsigned char identifier[8] { 0xAB, 'V', 'T', 'F', 0xBB, 0x0D, 0x0A, 0x1A };
+	constexpr std::uint32_t version { 1 };
+	constexpr std::size_t headerSize { 64 };
+	constexpr std::uint32_t flagSrgb { 1 };
+	constexpr int channels { 4 };
+
+	std::uint32_t read32(const unsigned char *p)
+	{
+		return static_cast<std::uint32_t>(p[0]) | (static_cast<std::uint32_t>(p[1]) << 8) | (static_cast<std::uint32_t>(p[2]) << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+	}
+
+	void write32(unsigned char *p, std::uint32_t value)
+	{
+		for (int i = 0; i < 4; i++)
+			p[i] = static_cast<unsigned char>(value >> (i * 8));
+	}
+
+	bool isPowerOfTwo(std::uint32_t value)
+	{
+		return value > 0 && (value & (value - 1)) == 0;
+	}
+
+	int tilesAt(int size, int tileSize, std::size_t level)
+	{
+		return std::max((size >> level) / tileSize, 1);
+	}
+
+	// Levels until the whole image fits into a single tile
+	std::size_t levelCountFor(int width, int height, int tileSize)
+	{
+		std::size_t levels { 1 };
+		while (tilesAt(width, tileSize, levels - 1) > 1 || tilesAt(height, tileSize, levels - 1) > 1)
+			levels++;
+		return levels;
+	}
+
+	std::string invalidMessage(const std::string &path, const std::string &reason)
+	{
+		std::stringstream error {};
+		error << "Invalid tile file: " << path << ": " << reason << std::endl;
+		return error.str();
+	}
+}
+
+constexpr int TileFile::defaultTileSize;
+constexpr int TileFile::defaultBorder;
+
+/**
+ * @brief Constructor for TileFile mapping and validating a tile file
+ * 
+ * @param path The path to the tile file
+ * 
+ * @throws MappedFile::MappingException if the file could not be mapped
+ * @throws InvalidFileException if the file is not a tile file or is truncated
+ */
+TileFile::TileFile(const std::string &path) : _file { path }
+{
+	const unsigned char *data { _file.getData() };
+	if (_file.getSize() < headerSize || !std::equal(std::begin(identifier), std::end(identifier), data))
+		throw InvalidFileException(invalidMessage(path, "bad identifier"));
+	if (read32(data + 8) != version)
+		throw InvalidFileException(invalidMessage(path, "unsupported version"));
+
+	const std::uint32_t width { read32(data + 12) };
+	const std::uint32_t height { read32(data + 16) };
+	const std::uint32_t tileSize { read32(data + 20) };
+	const std::uint32_t border { read32(data + 24) };
+	if (!isPowerOfTwo(width) || !isPowerOfTwo(height) || !isPowerOfTwo(tileSize) || width > 1u << 24 || height > 1u << 24 || border >= tileSize)
+		throw InvalidFileException(invalidMessage(path, "bad dimensions"));
+	_width = static_cast<int>(width);
+	_height = static_cast<int>(height);
+	_tileSize = static_cast<int>(tileSize);
+	_border = static_cast<int>(border);
+	_srgb = (read32(data + 32) & flagSrgb) != 0;
+	_levelCount = levelCountFor(_width, _height, _tileSize);
+	if (read32(data + 28) != _levelCount)
+		throw InvalidFileException(invalidMessage(path, "bad level count"));
+
+	const std::size_t pages { pageIndex(_levelCount - 1, 0, 0) + 1 };
+	if ((_file.getSize() - headerSize) / getPageBytes() < pages)
+		throw InvalidFileException(invalidMessage(path, "truncated"));
+
+	spdlog::debug("Opened tile file {} ({}x{}, {} levels of {}px tiles)", path, _width, _height, _levelCount, _tileSize);
+}
+
+/**
+ * @brief Getter for the width of level 0
+ * 
+ * @returns Width in texels
+ */
+int TileFile::getWidth()
+{
+	return _width;
+}
+
+/**
+ * @brief Getter for the height of level 0
+ * 
+ * @returns Height in texels
+ */
+int TileFile::getHeight()
+{
+	return _height;
+}
+
+/**
+ * @brief Getter for the tile size
+ * 
+ * @returns Width and height of a tile in texels, not counting the border
+ */
+int TileFile::getTileSize()
+{
+	return _tileSize;
+}
+
+/**
+ * @brief Getter for the border around every tile
+ * 
+ * @returns Border in texels on each side
+ */
+int TileFile::getBorder()
+{
+	return _border;
+}
+
+/**
+ * @brief Getter for the size of a stored page
+ * 
+ * @returns Width and height of a page in texels, tile plus border
+ */
+int TileFile::getPageSize()
+{
+	return _tileSize + 2 * _border;
+}
+
+/**
+ * @brief Getter for the size of a stored page in bytes
+ * 
+ * @returns Bytes of one RGBA8 page
+ */
+std::size_t TileFile::getPageBytes()
+{
+	return static_cast<std::size_t>(getPageSize()) * getPageSize() * channels;
+}
+
+/**
+ * @brief Getter for the color space of the texels
+ * 
+ * @returns true if the texels are sRGB encoded
+ */
+bool TileFile::isSrgb()
+{
+	return _srgb;
+}
+
+/**
+ * @brief Getter for the number of levels, the last one fits into a single tile
+ * 
+ * @returns Number of levels
+ */
+std::size_t TileFile::getLevelCount()
+{
+	return _levelCount;
+}
+
+/**
+ * @brief Getter for the number of tile columns of a level
+ * 
+ * @param level The level
+ * 
+ * @returns Tiles per row
+ */
+int TileFile::getTilesX(std::size_t level)
+{
+	return tilesAt(_width, _tileSize, level);
+}
+
+/**
+ * @brief Getter for the number of tile rows of a level
+ * 
+ * @param level The level
+ * 
+ * @returns Tiles per column
+ */
+int TileFile::getTilesY(std::size_t level)
+{
+	return tilesAt(_height, _tileSize, level);
+}
+
+/**
+ * @brief Gets the page of a tile, ready to be uploaded
+ * 
+ * @param level The level of the tile
+ * @param x The column of the tile
+ * @param y The row of the tile
+ * 
+ * @returns Pointer to getPageBytes() bytes of RGBA8 texels within the mapping
+ * 
+ * @throws std::out_of_range if the tile does not exist
+ */
+const unsigned char *TileFile::getPage(std::size_t level, int x, int y)
+{
+	if (level >= _levelCount || x < 0 || y < 0 || x >= getTilesX(level) || y >= getTilesY(level))
+		throw std::out_of_range("Tile out of range");
+	return _file.getData() + headerSize + pageIndex(level, x, y) * getPageBytes();
+}
+
+/**
+ * @brief Splits a mip chain into a tile file
+ * 
+ * Levels whose image is smaller than a tile are stored in a single tile, the unused part repeating the edge.
+ * 
+ * @param path Path of the tile file to write
+ * @param chain An RGBA chain with power of two dimensions and its levels generated
+ * @param srgb Whether the texels are sRGB encoded
+ * @param tileSize Tile size in texels, a power of two
+ * @param border Border in texels on each side of a tile, less than the tile size
+ * 
+ * @throws InvalidFileException if the chain can't be tiled or the file could not be written
+ */
+void TileFile::write(const std::string &path, MipChain &chain, bool srgb, int tileSize, int border)
+{
+	const int width { chain.getLevel(0).width };
+	const int height { chain.getLevel(0).height };
+	if (chain.getChannels() != channels || !isPowerOfTwo(width) || !isPowerOfTwo(height) || !isPowerOfTwo(tileSize) || border < 0 || border >= tileSize)
+		throw InvalidFileException(invalidMessage(path, "needs an RGBA chain and tile size with power of two dimensions"));
+	const std::size_t levelCount { levelCountFor(width, height, tileSize) };
+
+	std::ofstream os { path, std::ios::binary };
+	unsigned char header[headerSize] {};
+	std::copy(std::begin(identifier), std::end(identifier), header);
+	write32(header + 8, version);
+	write32(header + 12, static_cast<std::uint32_t>(width));
+	write32(header + 16, static_cast<std::uint32_t>(height));
+	write32(header + 20, static_cast<std::uint32_t>(tileSize));
+	write32(header + 24, static_cast<std::uint32_t>(border));
+	write32(header + 28, static_cast<std::uint32_t>(levelCount));
+	write32(header + 32, srgb ? flagSrgb : 0);
+	os.write(reinterpret_cast<const char *>(header), headerSize);
+
+	const int pageSize { tileSize + 2 * border };
+	std::vector<unsigned char> page(static_cast<std::size_t>(pageSize) * pageSize * channels);
+	for (std::size_t level = 0; level < levelCount; level++)
+	{
+		const MipChain::Level &info { chain.getLevel(level) };
+		const unsigned char *texels { chain.getLevelData(level) };
+		for (int ty = 0; ty < tilesAt(height, tileSize, level); ty++)
+			for (int tx = 0; tx < tilesAt(width, tileSize, level); tx++)
+			{
+				for (int y = 0; y < pageSize; y++)
+				{
+					const int sy { std::min(std::max(ty * tileSize + y - border, 0), info.height - 1) };
+					for (int x = 0; x < pageSize; x++)
+					{
+						const int sx { std::min(std::max(tx * tileSize + x - border, 0), info.width - 1) };
+						std::copy_n(texels + (static_cast<std::size_t>(sy) * info.width + sx) * channels, channels, page.data() + (static_cast<std::size_t>(y) * pageSize + x) * channels);
+					}
+				}
+				os.write(reinterpret_cast<const char *>(page.data()), static_cast<std::streamsize>(page.size()));
+			}
+	}
+
+	if (!os)
+		throw InvalidFileException(invalidMessage(path, "failed to write"));
+}
+
+std::size_t TileFile::pageIndex(std::size_t level, int x, int y)
+{
+	std::size_t index { 0 };
+	for (std::size_t i = 0; i < level; i++)
+		index += static_cast<std::size_t>(getTilesX(i)) * getTilesY(i);
+	return index + static_cast<std::size_t>(y) * getTilesX(level) + x;
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "UniformBlocks.hpp"
+#include <sstream>
+#include <utility>
+#include <spdlog/spdlog.h>
+
+#define UNIFORM_BLOCK_GLSL(type, member) glsl << "\t" << Std140<type>::glsl() << " " #member ";\n";
+#define UNIFORM_BLOCK_DECLARATION(Block, MEMBERS) \
+	std::string Block::declaration() \
+	{ \
+		std::stringstream glsl {}; \
+		glsl << "layout(std140) uniform " << name << "\n{\n"; \
+		MEMBERS(UNIFORM_BLOCK_GLSL) \
+		glsl << "} " << instance << ";\n"; \
+		return glsl.str(); \
+	}
+
+constexpr GLuint FrameBlock::binding;
+constexpr const char *FrameBlock::name;
+constexpr const char *FrameBlock::instance;
+constexpr GLuint MaterialBlock::binding;
+constexpr const char *MaterialBlock::name;
+constexpr const char *MaterialBlock::instance;
+constexpr GLuint ObjectBlock::binding;
+constexpr const char *ObjectBlock::name;
+constexpr const char *ObjectBlock::instance;
+
+/**
+ * @brief Generates the GLSL declaration of the per frame block
+ * 
+ * @returns A std140 uniform block with the instance name "frame"
+ */
+UNIFORM_BLOCK_DECLARATION(FrameBlock, FRAME_BLOCK_MEMBERS)
+
+/**
+ * @brief Generates the GLSL declaration of the per material block
+ * 
+ * @returns A std140 uniform block with the instance name "material"
+ */
+UNIFORM_BLOCK_DECLARATION(MaterialBlock, MATERIAL_BLOCK_MEMBERS)
+
+/**
+ * @brief Generates the GLSL declaration of the per object block
+ * 
+ * @returns A std140 uniform block with the instance name "object"
+ */
+UNIFORM_BLOCK_DECLARATION(ObjectBlock, OBJECT_BLOCK_MEMBERS)
+
+#undef UNIFORM_BLOCK_DECLARATION
+#undef UNIFORM_BLOCK_GLSL
+
+/**
+ * @brief Generates the GLSL declarations of all blocks
+ * 
+ * Blocks a shader does not reference are inactive and cost nothing, so every shader can get all of them.
+ * 
+ * @returns The declarations, to be placed after the #version line
+ */
+std::string UniformBlocks::declarations()
+{
+	return FrameBlock::declaration() + MaterialBlock::declaration() + ObjectBlock::declaration();
+}
+
+/**
+ * @brief Assigns the blocks a linked program uses to their binding points
+ * 
+ * @param program A linked program
+ */
+void UniformBlocks::bind(GLuint program)
+{
+	const std::pair<const char *, GLuint> blocks[] {
+		{ FrameBlock::name, FrameBlock::binding },
+		{ MaterialBlock::name, MaterialBlock::binding },
+		{ ObjectBlock::name, ObjectBlock::binding }
+	};
+	for (const std::pair<const char *, GLuint> &block : blocks)
+	{
+		const GLuint index { glGetUniformBlockIndex(program, block.first) };
+		if (index == GL_INVALID_INDEX)
+			continue;
+		glUniformBlockBinding(program, index, block.second);
+		spdlog::debug("Bound uniform block {} to binding {}", block.first, block.second);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include "UniformBuffer.hpp"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <spdlog/spdlog.h>
+
+/**
+ * @brief Move constructor for UniformBuffer
+ */
+UniformBuffer::UniformBuffer(UniformBuffer &&rhs) : _buffer { rhs._buffer }, _binding { rhs._binding }, _size { rhs._size }, _stride { rhs._stride }, _count { rhs._count }, _contents { std::move(rhs._contents) }
+{
+	rhs._buffer = 0;
+}
+
+/**
+ * @brief Constructor for UniformBuffer
+ * 
+ * @param binding The uniform buffer binding point the buffer is bound to
+ * @param size Size of one instance in bytes
+ * @param count Number of instances. Defaults to 1
+ */
+UniformBuffer::UniformBuffer(GLuint binding, GLsizeiptr size, GLsizei count) : _binding { binding }, _size { size }, _count { std::max(count, 1) }
+{
+	GLint alignment {};
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	alignment = std::max(alignment, 1);
+	_stride = (_size + alignment - 1) / alignment * alignment;
+
+	// Starts out zeroed on both sides, so the copy always matches the buffer
+	_contents.resize(static_cast<std::size_t>(_stride * _count));
+	glGenBuffers(1, &_buffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, _buffer);
+	glBufferData(GL_UNIFORM_BUFFER, _stride * _count, _contents.data(), GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	spdlog::debug("Created uniform buffer: binding={}, size={}, count={}, stride={}", _binding, _size, _count, _stride);
+}
+
+/**
+ * @brief Destructor for UniformBuffer, deletes the buffer while a context is still current
+ */
+UniformBuffer::~UniformBuffer()
+{
+	if (_buffer && glfwGetCurrentContext())
+		glDeleteBuffers(1, &_buffer);
+}
+
+/**
+ * @brief Move assignment operator for UniformBuffer
+ */
+UniformBuffer &UniformBuffer::operator=(UniformBuffer &&rhs)
+{
+	std::swap(_buffer, rhs._buffer);
+	_binding = rhs._binding;
+	_size = rhs._size;
+	_stride = rhs._stride;
+	_count = rhs._count;
+	_contents = std::move(rhs._contents);
+
+	return *this;
+}
+
+/**
+ * @brief Uploads the contents of an instance if they changed
+ * 
+ * @param data The new contents
+ * @param size Size of data in bytes, at most the instance size
+ * @param index The instance to update
+ */
+void UniformBuffer::update(const void *data, GLsizeiptr size, GLsizei index)
+{
+	if (index < 0 || index >= _count || size > _size)
+		return;
+
+	const std::size_t offset { static_cast<std::size_t>(_stride * index) };
+	if (std::memcmp(_contents.data() + offset, data, static_cast<std::size_t>(size)) == 0)
+		return;
+
+	std::memcpy(_contents.data() + offset, data, static_cast<std::size_t>(size));
+	glBindBuffer(GL_UNIFORM_BUFFER, _buffer);
+	glBufferSubData(GL_UNIFORM_BUFFER, static_cast<GLintptr>(offset), size, data);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+/**
+ * @brief Binds an instance to the buffer's binding point
+ * 
+ * @param index The instance to bind
+ */
+void UniformBuffer::bind(GLsizei index)
+{
+	glBindBufferRange(GL_UNIFORM_BUFFER, _binding, _buffer, _stride * std::min(std::max(index, 0), _count - 1), _size);
+}
+
+/**
+ * @brief Gets the number of instances
+ * 
+ * @returns The instance count
+ */
+GLsizei UniformBuffer::getCount()
+{
+	return _count;
+}
\ No newline at end of file
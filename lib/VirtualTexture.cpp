@@ -0,0 +1,302 @@
+#include "VirtualTexture.hpp"
+#include "SamplerCache.hpp"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <unordered_set>
+#include <spdlog/spdlog.h>
+
+namespace
+{
+	std::uint64_t keyOf(const VirtualTexture::TileId &tile)
+	{
+		return (static_cast<std::uint64_t>(tile.level) << 48) | (static_cast<std::uint64_t>(tile.y) << 24) | tile.x;
+	}
+}
+
+constexpr int VirtualTexture::defaultAtlasPages;
+constexpr int VirtualTexture::maxAtlasPages;
+constexpr std::size_t VirtualTexture::defaultUploadsPerFrame;
+
+/**
+ * @brief Constructor for VirtualTexture opening a tile file and creating its atlas
+ * 
+ * The tiles of the coarsest level are uploaded and pinned right away.
+ * 
+ * @param path The path to the tile file
+ * @param atlasPages Number of pages per row (and column) of the atlas, at most maxAtlasPages
+ * 
+ * @throws MappedFile::MappingException if the tile file could not be mapped
+ * @throws TileFile::InvalidFileException if the tile file is invalid
+ * @throws VirtualTextureException if the atlas would exceed GL_MAX_TEXTURE_SIZE or hold too few pages
+ */
+VirtualTexture::VirtualTexture(const std::string &path, int atlasPages) : _tiles { path }, _atlasPages { atlasPages }
+{
+	const std::size_t levels { _tiles.getLevelCount() };
+	const std::size_t coarsestTiles { static_cast<std::size_t>(_tiles.getTilesX(levels - 1)) * _tiles.getTilesY(levels - 1) };
+	GLint maxSize {};
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+	if (atlasPages < 1 || atlasPages > maxAtlasPages || atlasPages * _tiles.getPageSize() > maxSize || static_cast<std::size_t>(atlasPages) * atlasPages <= coarsestTiles)
+	{
+		std::stringstream error {};
+		error << "Invalid virtual texture atlas of " << atlasPages << "x" << atlasPages << " pages for " << path << std::endl;
+		throw VirtualTextureException(error.str());
+	}
+
+	const GLsizei atlasSize { atlasPages * _tiles.getPageSize() };
+	glGenTextures(1, &_atlas);
+	glBindTexture(GL_TEXTURE_2D, _atlas);
+	glTexImage2D(GL_TEXTURE_2D, 0, _tiles.isSrgb() ? GL_SRGB8_ALPHA8 : GL_RGBA8, atlasSize, atlasSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	// One texel per tile and level, sampled with textureLod at the level the fragment needs
+	glGenTextures(1, &_indirection);
+	glBindTexture(GL_TEXTURE_2D, _indirection);
+	for (std::size_t level = 0; level < levels; level++)
+	{
+		glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), GL_RGBA8, _tiles.getTilesX(level), _tiles.getTilesY(level), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+		_pageTable.emplace_back(static_cast<std::size_t>(_tiles.getTilesX(level)) * _tiles.getTilesY(level), -1);
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(levels - 1));
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	_slots.resize(static_cast<std::size_t>(atlasPages) * atlasPages);
+	for (int slot = static_cast<int>(_slots.size()) - 1; slot >= 0; slot--)
+		_freeSlots.push_back(slot);
+
+	for (int y = 0; y < _tiles.getTilesY(levels - 1); y++)
+		for (int x = 0; x < _tiles.getTilesX(levels - 1); x++)
+		{
+			const int slot { allocateSlot() };
+			_slots[slot].pinned = true;
+			upload({ static_cast<std::uint32_t>(levels - 1), static_cast<std::uint32_t>(x), static_cast<std::uint32_t>(y) }, slot);
+		}
+	updateIndirection();
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	spdlog::debug("Created virtual texture {}: atlas={}x{} pages of {}px", path, atlasPages, atlasPages, _tiles.getPageSize());
+}
+
+/**
+ * @brief Destructor for VirtualTexture deleting the atlas and indirection texture
+ */
+VirtualTexture::~VirtualTexture()
+{
+	if (!glfwGetCurrentContext())
+		return;
+
+	glDeleteTextures(1, &_atlas);
+	glDeleteTextures(1, &_indirection);
+}
+
+/**
+ * @brief Pages in the tiles visible last frame
+ * 
+ * Every visible tile and all its ancestors are marked as used. Missing tiles are uploaded coarse to fine, so a
+ * tile's parent is always resident before the tile itself, replacing the least recently used pages once the
+ * atlas is full. Pages used this frame are never replaced, if the atlas is too small for the view the remaining
+ * tiles keep falling back to coarser levels.
+ * 
+ * @param visible The tiles requested by the feedback pass, duplicates and out of range tiles are ignored
+ * @param maxUploads Upper bound of tiles uploaded this frame
+ */
+void VirtualTexture::update(const std::vector<TileId> &visible, std::size_t maxUploads)
+{
+	_frame++;
+
+	const std::size_t levels { _tiles.getLevelCount() };
+	std::unordered_set<std::uint64_t> seen {};
+	std::vector<TileId> missing {};
+	for (TileId tile : visible)
+	{
+		if (tile.level >= levels || tile.x >= static_cast<std::uint32_t>(_tiles.getTilesX(tile.level)) || tile.y >= static_cast<std::uint32_t>(_tiles.getTilesY(tile.level)))
+			continue;
+
+		// Once a tile has been seen its ancestors have been handled as well
+		while (seen.insert(keyOf(tile)).second)
+		{
+			const int slot { pageEntry(tile) };
+			if (slot >= 0)
+				_slots[slot].lastUsed = _frame;
+			else
+				missing.push_back(tile);
+
+			if (tile.level + 1 >= levels)
+				break;
+			tile = { tile.level + 1, tile.x / 2, tile.y / 2 };
+		}
+	}
+
+	std::stable_sort(missing.begin(), missing.end(), [](const TileId &a, const TileId &b) { return a.level > b.level; });
+	std::size_t uploads { 0 };
+	for (const TileId &tile : missing)
+	{
+		if (uploads == maxUploads)
+			break;
+		const int slot { allocateSlot() };
+		if (slot < 0)
+			break;
+		upload(tile, slot);
+		uploads++;
+	}
+
+	if (uploads > 0)
+	{
+		updateIndirection();
+		glBindTexture(GL_TEXTURE_2D, 0);
+		spdlog::debug("Paged in {} of {} missing virtual texture tiles, {} resident", uploads, missing.size(), _residentTiles);
+	}
+}
+
+/**
+ * @brief Binds the indirection texture and atlas and sets the uniforms of the lookup
+ * 
+ * The shader program has to be in use.
+ * 
+ * @param shader The shader using res/shaders/virtual_texture.frag or virtual_feedback.frag
+ * @param indirectionUnit The texture unit for the indirection texture
+ * @param atlasUnit The texture unit for the atlas
+ * @param lodBias Added to the computed level, see VirtualTextureFeedback::getLodBias()
+ */
+void VirtualTexture::bind(Shader &shader, GLenum indirectionUnit, GLenum atlasUnit, float lodBias)
+{
+	// Both textures rely on their own filtering, nearest for the indirection and bilinear without mips for the atlas
+	glActiveTexture(indirectionUnit);
+	glBindTexture(GL_TEXTURE_2D, _indirection);
+	SamplerCache::shared().unbind(indirectionUnit);
+	glActiveTexture(atlasUnit);
+	glBindTexture(GL_TEXTURE_2D, _atlas);
+	SamplerCache::shared().unbind(atlasUnit);
+
+	glm::vec4 params { static_cast<float>(_tiles.getWidth()), static_cast<float>(_tiles.getHeight()), static_cast<float>(_tiles.getTileSize()), static_cast<float>(_tiles.getBorder()) };
+	glm::vec4 atlasParams { static_cast<float>(_atlasPages), static_cast<float>(_tiles.getPageSize()), static_cast<float>(_tiles.getLevelCount() - 1), lodBias };
+	shader.setUniform("vtIndirection", static_cast<GLint>(indirectionUnit - GL_TEXTURE0));
+	shader.setUniform("vtAtlas", static_cast<GLint>(atlasUnit - GL_TEXTURE0));
+	shader.setUniform("vtParams", params);
+	shader.setUniform("vtAtlasParams", atlasParams);
+}
+
+/**
+ * @brief Getter for the backing tile file
+ * 
+ * @returns The tile file
+ */
+TileFile &VirtualTexture::getTileFile()
+{
+	return _tiles;
+}
+
+/**
+ * @brief Getter for the number of tiles in the atlas
+ * 
+ * @returns Resident tiles
+ */
+std::size_t VirtualTexture::getResidentTileCount()
+{
+	return _residentTiles;
+}
+
+/**
+ * @brief Getter for the size of the atlas
+ * 
+ * @returns Pages per row and column
+ */
+int VirtualTexture::getAtlasPages()
+{
+	return _atlasPages;
+}
+
+int &VirtualTexture::pageEntry(const TileId &tile)
+{
+	return _pageTable[tile.level][static_cast<std::size_t>(tile.y) * _tiles.getTilesX(tile.level) + tile.x];
+}
+
+/**
+ * @brief Finds a free page, evicting the least recently used tile not used this frame if necessary
+ * 
+ * @returns The slot, or -1 if every page is pinned or used this frame
+ */
+int VirtualTexture::allocateSlot()
+{
+	if (!_freeSlots.empty())
+	{
+		const int slot { _freeSlots.back() };
+		_freeSlots.pop_back();
+		return slot;
+	}
+
+	int victim { -1 };
+	for (std::size_t i = 0; i < _slots.size(); i++)
+	{
+		const Slot &slot { _slots[i] };
+		if (slot.pinned || slot.lastUsed == _frame)
+			continue;
+		if (victim < 0 || slot.lastUsed < _slots[victim].lastUsed)
+			victim = static_cast<int>(i);
+	}
+	if (victim >= 0)
+	{
+		pageEntry(_slots[victim].tile) = -1;
+		_residentTiles--;
+	}
+	return victim;
+}
+
+void VirtualTexture::upload(const TileId &tile, int slot)
+{
+	const int pageSize { _tiles.getPageSize() };
+	glBindTexture(GL_TEXTURE_2D, _atlas);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, (slot % _atlasPages) * pageSize, (slot / _atlasPages) * pageSize, pageSize, pageSize,
+		GL_RGBA, GL_UNSIGNED_BYTE, _tiles.getPage(tile.level, static_cast<int>(tile.x), static_cast<int>(tile.y)));
+
+	_slots[slot].tile = tile;
+	_slots[slot].lastUsed = _frame;
+	pageEntry(tile) = slot;
+	_residentTiles++;
+}
+
+/**
+ * @brief Rebuilds the indirection texture from the page table
+ * 
+ * Walks the levels coarse to fine, tiles which aren't resident inherit the entry of their parent. An entry holds
+ * the page column and row and the level of the tile actually stored there.
+ */
+void VirtualTexture::updateIndirection()
+{
+	const std::size_t levels { _tiles.getLevelCount() };
+	std::vector<unsigned char> parent {};
+	std::vector<unsigned char> entries {};
+	glBindTexture(GL_TEXTURE_2D, _indirection);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	for (std::size_t level = levels; level-- > 0;)
+	{
+		const int tilesX { _tiles.getTilesX(level) };
+		const int tilesY { _tiles.getTilesY(level) };
+		const int parentTilesX { level + 1 < levels ? _tiles.getTilesX(level + 1) : 0 };
+		entries.assign(static_cast<std::size_t>(tilesX) * tilesY * 4, 0);
+		for (int y = 0; y < tilesY; y++)
+			for (int x = 0; x < tilesX; x++)
+			{
+				unsigned char *entry { &entries[(static_cast<std::size_t>(y) * tilesX + x) * 4] };
+				const int slot { _pageTable[level][static_cast<std::size_t>(y) * tilesX + x] };
+				if (slot >= 0)
+				{
+					entry[0] = static_cast<unsigned char>(slot % _atlasPages);
+					entry[1] = static_cast<unsigned char>(slot / _atlasPages);
+					entry[2] = static_cast<unsigned char>(level);
+					entry[3] = 255;
+				}
+				else if (!parent.empty())
+					std::copy_n(&parent[(static_cast<std::size_t>(y / 2) * parentTilesX + x / 2) * 4], 4, entry);
+			}
+		glTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), 0, 0, tilesX, tilesY, GL_RGBA, GL_UNSIGNED_BYTE, entries.data());
+		parent.swap(entries);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,216 @@
+#include "VirtualTextureFeedback.hpp"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <unordered_set>
+#include <spdlog/spdlog.h>
+
+namespace
+{
+	// Texels are tile x, tile y, level and texture id + 1, a zero id marks fragments without a virtual texture
+	constexpr int texelComponents { 4 };
+
+	int scaled(int size, int scale)
+	{
+		return std::max((size + scale - 1) / scale, 1);
+	}
+
+	GLsizeiptr bufferSize(int width, int height)
+	{
+		return static_cast<GLsizeiptr>(width) * height * texelComponents * static_cast<GLsizeiptr>(sizeof(GLushort));
+	}
+}
+
+constexpr int VirtualTextureFeedback::defaultScale;
+
+/**
+ * @brief Constructor for VirtualTextureFeedback
+ * 
+ * @param width Width of the viewport the scene is rendered to
+ * @param height Height of the viewport the scene is rendered to
+ * @param scale Factor the feedback target is smaller than the viewport by
+ * 
+ * @throws FramebufferException if the framebuffer is incomplete
+ */
+VirtualTextureFeedback::VirtualTextureFeedback(int width, int height, int scale) : _width { scaled(width, scale) }, _height { scaled(height, scale) }, _scale { scale }
+{
+	create();
+}
+
+/**
+ * @brief Destructor for VirtualTextureFeedback
+ */
+VirtualTextureFeedback::~VirtualTextureFeedback()
+{
+	if (glfwGetCurrentContext())
+		destroy();
+}
+
+/**
+ * @brief Recreates the feedback target for a new viewport size
+ * 
+ * @param width Width of the viewport the scene is rendered to
+ * @param height Height of the viewport the scene is rendered to
+ * 
+ * @throws FramebufferException if the framebuffer is incomplete
+ */
+void VirtualTextureFeedback::resize(int width, int height)
+{
+	destroy();
+	_width = scaled(width, _scale);
+	_height = scaled(height, _scale);
+	create();
+}
+
+/**
+ * @brief Binds and clears the feedback target, draw the scene with the feedback shader afterwards
+ */
+void VirtualTextureFeedback::begin()
+{
+	glGetIntegerv(GL_VIEWPORT, _viewport);
+	glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+	glViewport(0, 0, _width, _height);
+	const GLuint clear[texelComponents] {};
+	glClearBufferuiv(GL_COLOR, 0, clear);
+	glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+/**
+ * @brief Starts the readback of this frame's feedback and decodes the previous frame's
+ * 
+ * Restores the default framebuffer and the viewport. If the previous readback hasn't finished yet, the requests
+ * of the last decoded frame are kept.
+ */
+void VirtualTextureFeedback::end()
+{
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, _buffers[_current]);
+	glReadPixels(0, 0, _width, _height, GL_RGBA_INTEGER, GL_UNSIGNED_SHORT, nullptr);
+	if (_fences[_current])
+		glDeleteSync(_fences[_current]);
+	_fences[_current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(_viewport[0], _viewport[1], _viewport[2], _viewport[3]);
+
+	_current = 1 - _current;
+	collect(_current);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+/**
+ * @brief Gets the tiles one virtual texture needs
+ * 
+ * @param textureId The id the texture was drawn with in the feedback shader
+ * 
+ * @returns The visible tiles, for VirtualTexture::update()
+ */
+std::vector<VirtualTexture::TileId> VirtualTextureFeedback::getTiles(std::uint32_t textureId)
+{
+	std::vector<VirtualTexture::TileId> tiles {};
+	for (const Request &request : _requests)
+		if (request.textureId == textureId)
+			tiles.push_back(request.tile);
+	return tiles;
+}
+
+/**
+ * @brief Getter for the decoded requests of all virtual textures
+ * 
+ * @returns Unique requests of the last decoded frame
+ */
+const std::vector<VirtualTextureFeedback::Request> &VirtualTextureFeedback::getRequests()
+{
+	return _requests;
+}
+
+/**
+ * @brief Getter for the level bias the feedback shader needs
+ * 
+ * Derivatives in the smaller target are scale times larger, which the bias cancels.
+ * 
+ * @returns Bias to pass to VirtualTexture::bind() for the feedback pass
+ */
+float VirtualTextureFeedback::getLodBias()
+{
+	return -std::log2(static_cast<float>(_scale));
+}
+
+void VirtualTextureFeedback::create()
+{
+	glGenTextures(1, &_color);
+	glBindTexture(GL_TEXTURE_2D, _color);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16UI, _width, _height, 0, GL_RGBA_INTEGER, GL_UNSIGNED_SHORT, nullptr);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	glGenRenderbuffers(1, &_depth);
+	glBindRenderbuffer(GL_RENDERBUFFER, _depth);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, _width, _height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &_framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _color, 0);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, _depth);
+	const GLenum status { glCheckFramebufferStatus(GL_FRAMEBUFFER) };
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::stringstream error {};
+		error << "Virtual texture feedback framebuffer incomplete: " << status << std::endl;
+		throw FramebufferException(error.str());
+	}
+
+	glGenBuffers(2, _buffers);
+	for (GLuint buffer : _buffers)
+	{
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+		glBufferData(GL_PIXEL_PACK_BUFFER, bufferSize(_width, _height), nullptr, GL_STREAM_READ);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	spdlog::debug("Created virtual texture feedback target: width={}, height={}", _width, _height);
+}
+
+void VirtualTextureFeedback::destroy()
+{
+	for (GLsync &fence : _fences)
+	{
+		if (fence)
+			glDeleteSync(fence);
+		fence = nullptr;
+	}
+	glDeleteBuffers(2, _buffers);
+	glDeleteFramebuffers(1, &_framebuffer);
+	glDeleteRenderbuffers(1, &_depth);
+	glDeleteTextures(1, &_color);
+	_requests.clear();
+}
+
+/**
+ * @brief Decodes a finished readback into unique requests
+ */
+void VirtualTextureFeedback::collect(int index)
+{
+	if (!_fences[index] || glClientWaitSync(_fences[index], 0, 0) == GL_TIMEOUT_EXPIRED)
+		return;
+	glDeleteSync(_fences[index]);
+	_fences[index] = nullptr;
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, _buffers[index]);
+	const GLushort *texels { static_cast<const GLushort *>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bufferSize(_width, _height), GL_MAP_READ_BIT)) };
+	if (!texels)
+		return;
+
+	_requests.clear();
+	std::unordered_set<std::uint64_t> seen {};
+	for (std::size_t i = 0; i < static_cast<std::size_t>(_width) * _height; i++)
+	{
+		const GLushort *texel { texels + i * texelComponents };
+		if (texel[3] == 0)
+			continue;
+		const std::uint64_t key { static_cast<std::uint64_t>(texel[0]) | (static_cast<std::uint64_t>(texel[1]) << 16) | (static_cast<std::uint64_t>(texel[2]) << 32) | (static_cast<std::uint64_t>(texel[3]) << 48) };
+		if (seen.insert(key).second)
+			_requests.push_back({ static_cast<std::uint32_t>(texel[3] - 1), { texel[2], texel[0], texel[1] } });
+	}
+	glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+}
\ No newline at end of file
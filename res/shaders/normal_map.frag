@@ -0,0 +1,20 @@
+#version 330 core
+in vec2 texCoords;
+in vec3 normal;
+in vec4 tangent;
+
+out vec4 FragColor;
+
+uniform sampler2D baseColorTexture;
+uniform vec3 lightDirection;
+
+#include "normal_map.glsl"
+
+void main()
+{
+	vec3 shadingNormal = perturbNormal(normal, tangent, texCoords);
+
+	vec4 baseColor = texture(baseColorTexture, texCoords);
+	float diffuse = max(dot(shadingNormal, -normalize(lightDirection)), 0.0);
+	FragColor = vec4(baseColor.rgb * (0.1 + 0.9 * diffuse), baseColor.a);
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+// Shared by every shader sampling two channel normal maps, include after #version
+
+uniform sampler2D normalTexture; // GL_RG8 or BC5, loaded with TextureLoadOptions::normalMap
+uniform float normalScale;
+
+// Only X and Y are stored, Z is positive in tangent space and follows from the unit length. The scale applies
+// to X and Y of the unit vector like in glTF
+vec3 sampleNormal(vec2 uv)
+{
+	vec2 xy = texture(normalTexture, uv).rg * 2.0 - 1.0;
+	float z = sqrt(max(1.0 - dot(xy, xy), 0.0));
+	return normalize(vec3(xy * normalScale, z));
+}
+
+// Transforms the sampled normal from tangent space with a glTF tangent, whose w is the bitangent sign
+vec3 perturbNormal(vec3 normal, vec4 tangent, vec2 uv)
+{
+	vec3 n = normalize(normal);
+	vec3 t = normalize(tangent.xyz - n * dot(n, tangent.xyz));
+	vec3 b = cross(n, t) * tangent.w;
+	return normalize(mat3(t, b, n) * sampleNormal(uv));
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoords;
+layout (location = 2) in vec3 aNormal;
+layout (location = 3) in vec4 aTangent; // xyz tangent, w handedness of the bitangent
+
+out vec2 texCoords;
+out vec3 normal;
+out vec4 tangent;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+	mat3 normalMatrix = transpose(inverse(mat3(model)));
+	gl_Position = projection * view * model * vec4(aPos, 1.0);
+	texCoords = aTexCoords;
+	normal = normalMatrix * aNormal;
+	tangent = vec4(mat3(model) * aTangent.xyz, aTangent.w);
+}
\ No newline at end of file
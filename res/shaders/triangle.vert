@@ -4,12 +4,10 @@ layout (location = 1) in vec2 aTexCoords;
 
 out vec2 texCoords;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// FrameBlock and ObjectBlock are injected, see UniformBlocks.hpp
 
 void main()
 {
-	gl_Position = projection * view * model * vec4(aPos, 1.0);
+	gl_Position = frame.projection * frame.view * object.model * vec4(aPos, 1.0);
 	texCoords = aTexCoords;
 }
\ No newline at end of file
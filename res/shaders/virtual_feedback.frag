@@ -0,0 +1,25 @@
+#version 330 core
+in vec2 texCoords;
+
+layout (location = 0) out uvec4 feedback;
+
+uniform vec4 vtParams; // virtual width, virtual height, tile size, border
+uniform vec4 vtAtlasParams; // pages per row, page size, coarsest level, level bias
+uniform int vtId;
+
+float vtLevel(vec2 uv)
+{
+	vec2 texels = uv * vtParams.xy;
+	vec2 dx = dFdx(texels);
+	vec2 dy = dFdy(texels);
+	return clamp(0.5 * log2(max(dot(dx, dx), dot(dy, dy))) + vtAtlasParams.w, 0.0, vtAtlasParams.z);
+}
+
+void main()
+{
+	float level = floor(vtLevel(texCoords));
+	vec2 levelSize = max(floor(vtParams.xy / exp2(level)), vec2(1.0));
+	vec2 tiles = max(floor(levelSize / vtParams.z), vec2(1.0));
+	vec2 tile = min(floor(fract(texCoords) * tiles), tiles - 1.0);
+	feedback = uvec4(uvec2(tile), uint(level), uint(vtId + 1));
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#version 330 core
+in vec2 texCoords;
+
+out vec4 FragColor;
+
+uniform sampler2D vtIndirection;
+uniform sampler2D vtAtlas;
+uniform vec4 vtParams; // virtual width, virtual height, tile size, border
+uniform vec4 vtAtlasParams; // pages per row, page size, coarsest level, level bias
+
+float vtLevel(vec2 uv)
+{
+	vec2 texels = uv * vtParams.xy;
+	vec2 dx = dFdx(texels);
+	vec2 dy = dFdy(texels);
+	return clamp(0.5 * log2(max(dot(dx, dx), dot(dy, dy))) + vtAtlasParams.w, 0.0, vtAtlasParams.z);
+}
+
+vec4 vtSample(vec2 uv)
+{
+	vec2 wrapped = fract(uv);
+	// The entry points at the page of the finest resident tile covering uv at the wanted level
+	vec4 entry = floor(textureLod(vtIndirection, wrapped, floor(vtLevel(uv))) * 255.0 + 0.5);
+	vec2 levelSize = max(floor(vtParams.xy / exp2(entry.z)), vec2(1.0));
+	vec2 inTile = mod(wrapped * levelSize, vtParams.z);
+	vec2 atlasTexel = entry.xy * vtAtlasParams.y + vtParams.w + inTile;
+	return texture(vtAtlas, atlasTexel / (vtAtlasParams.x * vtAtlasParams.y));
+}
+
+void main()
+{
+	FragColor = vtSample(texCoords);
+}
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <regex>
+#include <string>
+#include <vector>
+#include <spdlog/spdlog.h>
+#include "TextureCooker.hpp"
+
+namespace
+{
+	const char *usage { "Usage: gltf-cook [-o <directory>] [--srgb | --linear] [--no-flip] <model.gltf | image>..." };
+
+	std::string directoryOf(const std::string &path)
+	{
+		const std::size_t slash { path.find_last_of("/\\") };
+		return slash == std::string::npos ? std::string {} : path.substr(0, slash + 1);
+	}
+
+	std::string stemOf(const std::string &path)
+	{
+		const std::string name { path.substr(directoryOf(path).size()) };
+		const std::size_t dot { name.find_last_of('.') };
+		return dot == std::string::npos ? name : name.substr(0, dot);
+	}
+
+	std::string extensionOf(const std::string &path)
+	{
+		const std::size_t dot { path.find_last_of('.') };
+		std::string extension { dot == std::string::npos ? std::string {} : path.substr(dot + 1) };
+		std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+		return extension;
+	}
+
+	bool isImage(const std::string &path)
+	{
+		static const std::vector<std::string> extensions { "png", "jpg", "jpeg", "tga", "bmp", "hdr", "psd", "gif", "ppm", "pgm" };
+		return std::find(extensions.begin(), extensions.end(), extensionOf(path)) != extensions.end();
+	}
+
+	/**
+	 * Collects the external image URIs of a .gltf file. This is a plain scan for "uri" members rather than a
+	 * full JSON parse, embedded data URIs and buffers are skipped.
+	 */
+	std::vector<std::string> imagesOf(const std::string &gltfPath)
+	{
+		std::ifstream is { gltfPath };
+		const std::string json { std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>() };
+		const std::regex uriPattern { "\"uri\"\\s*:\\s*\"([^\"]+)\"" };
+
+		std::vector<std::string> images {};
+		for (std::sregex_iterator it { json.begin(), json.end(), uriPattern }; it != std::sregex_iterator {}; ++it)
+		{
+			const std::string uri { (*it)[1].str() };
+			const std::string path { directoryOf(gltfPath) + uri };
+			if (uri.compare(0, 5, "data:") != 0 && isImage(uri) && std::find(images.begin(), images.end(), path) == images.end())
+				images.push_back(path);
+		}
+		return images;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	std::string outputDirectory {};
+	TextureCooker::Options options {};
+	std::vector<TextureCooker::Job> jobs {};
+
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string arg { argv[i] };
+		if (arg == "-o" && i + 1 < argc)
+		{
+			outputDirectory = argv[++i];
+			if (!outputDirectory.empty() && outputDirectory.back() != '/')
+				outputDirectory += '/';
+		}
+		else if (arg == "--srgb")
+			options.srgb = true;
+		else if (arg == "--linear")
+			options.srgb = false;
+		else if (arg == "--no-flip")
+			options.flipVertically = false;
+		else if (arg[0] == '-')
+		{
+			spdlog::error(usage);
+			return 1;
+		}
+		else
+		{
+			const std::vector<std::string> sources { extensionOf(arg) == "gltf" ? imagesOf(arg) : std::vector<std::string> { arg } };
+			for (const std::string &source : sources)
+			{
+				const std::string directory { outputDirectory.empty() ? directoryOf(source) : outputDirectory };
+				const std::string output { directory + stemOf(source) + ".ktx2" };
+				// Jobs run concurrently, two of them must never write the same file
+				auto it { std::find_if(jobs.begin(), jobs.end(), [&output](const TextureCooker::Job &job) { return job.destination == output; }) };
+				if (it != jobs.end())
+				{
+					spdlog::warn("Skipping {}, {} is already cooked from another image", source, output);
+					continue;
+				}
+				jobs.push_back({ source, output, options });
+			}
+		}
+	}
+
+	if (jobs.empty())
+	{
+		spdlog::error(usage);
+		return 1;
+	}
+
+	try
+	{
+		TextureCooker::cookAll(jobs);
+	}
+	catch (const TextureCooker::CookingException &e)
+	{
+		spdlog::error(e.what());
+		return 1;
+	}
+	spdlog::info("Cooked {} textures", jobs.size());
+	return 0;
+}
\ No newline at end of file
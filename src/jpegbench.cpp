@@ -0,0 +1,137 @@
+#include <stb_image.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <spdlog/spdlog.h>
+#include "JpegDecoder.hpp"
+#include "Texture.hpp"
+
+namespace
+{
+	const char *usage { "Usage: gltf-jpeg-bench [-n <iterations>] [-c <channels>] <image.jpg>..." };
+
+	using Clock = std::chrono::steady_clock;
+
+	double millisecondsSince(Clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+
+	// Parses a whole argument as an integer in [min, max], returns false for anything else
+	bool parseInt(const char *arg, int min, int max, int &value)
+	{
+		char *end {};
+		const long parsed { std::strtol(arg, &end, 10) };
+		if (end == arg || *end != '\0' || parsed < min || parsed > max)
+			return false;
+		value = static_cast<int>(parsed);
+		return true;
+	}
+
+	/**
+	 * Decodes an image repeatedly and returns the fastest time in milliseconds, or a negative value if the
+	 * decoder rejected it.
+	 */
+	template <typename Decode>
+	double fastest(int iterations, Decode decode)
+	{
+		double best { -1.0 };
+		for (int i = 0; i < iterations; i++)
+		{
+			const Clock::time_point start { Clock::now() };
+			if (!decode())
+				return -1.0;
+			const double elapsed { millisecondsSince(start) };
+			if (best < 0.0 || elapsed < best)
+				best = elapsed;
+		}
+		return best;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int iterations { 5 };
+	int channels { 4 };
+	std::vector<std::string> paths {};
+
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string arg { argv[i] };
+		if (arg == "-n" && i + 1 < argc && parseInt(argv[i + 1], 1, 1000000, iterations))
+			i++;
+		else if (arg == "-c" && i + 1 < argc && parseInt(argv[i + 1], 1, 4, channels))
+			i++;
+		else if (arg[0] == '-')
+		{
+			spdlog::error(usage);
+			return 1;
+		}
+		else
+			paths.push_back(arg);
+	}
+
+	if (paths.empty())
+	{
+		spdlog::error(usage);
+		return 1;
+	}
+	if (!JpegDecoder::isAvailable())
+		spdlog::warn("Built without libjpeg, only stb_image is measured");
+
+	double stbTotal {}, jpegTotal {};
+	double pixelBytes {};
+	for (const std::string &path : paths)
+	{
+		std::vector<unsigned char> encoded {};
+		try
+		{
+			encoded = Texture::readFile(path);
+		}
+		catch (const Texture::TextureLoadingException &e)
+		{
+			spdlog::error(e.what());
+			return 1;
+		}
+
+		int width {}, height {}, fileChannels {};
+		if (!JpegDecoder::isJpeg(encoded.data(), encoded.size()) || !stbi_info_from_memory(encoded.data(), static_cast<int>(encoded.size()), &width, &height, &fileChannels))
+		{
+			spdlog::warn("Skipping {}, not a JPEG", path);
+			continue;
+		}
+		std::vector<unsigned char> pixels(static_cast<std::size_t>(width) * height * channels);
+
+		const double stb { fastest(iterations, [&]()
+		{
+			int w {}, h {}, c {};
+			unsigned char *data { stbi_load_from_memory(encoded.data(), static_cast<int>(encoded.size()), &w, &h, &c, channels) };
+			stbi_image_free(data);
+			return data != nullptr;
+		}) };
+		const double jpeg { fastest(iterations, [&]()
+		{
+			int w {}, h {};
+			return JpegDecoder::decode(encoded.data(), encoded.size(), channels, true, pixels.data(), pixels.size(), w, h);
+		}) };
+
+		if (jpeg < 0.0)
+		{
+			spdlog::info("{} ({}x{}): stb {:.2f} ms, libjpeg rejected it", path, width, height, stb);
+			continue;
+		}
+		spdlog::info("{} ({}x{}): stb {:.2f} ms, libjpeg {:.2f} ms, {:.2f}x", path, width, height, stb, jpeg, stb / jpeg);
+		stbTotal += stb;
+		jpegTotal += jpeg;
+		pixelBytes += static_cast<double>(pixels.size());
+	}
+
+	if (jpegTotal > 0.0)
+	{
+		const double megabytes { pixelBytes / (1024.0 * 1024.0) };
+		spdlog::info("Total: stb {:.1f} MB/s, libjpeg {:.1f} MB/s, {:.2f}x", megabytes * 1000.0 / stbTotal, megabytes * 1000.0 / jpegTotal, stbTotal / jpegTotal);
+	}
+	return 0;
+}
\ No newline at end of file
@@ -9,8 +9,13 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include "Window.hpp"
 #include "Shader.hpp"
+#include "ShaderPreprocessor.hpp"
+#include "ShaderWatcher.hpp"
 #include "Texture.hpp"
 #include "Camera.hpp"
+#include "UniformBlocks.hpp"
+#include "UniformBuffer.hpp"
+#include "VertexLayout.hpp"
 
 #define WINDOW_WIDTH 800
 #define WINDOW_HEIGHT 600
@@ -151,7 +156,11 @@ int main()
 		glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
 		glEnable(GL_DEPTH_TEST);
 		
-		Shader shader { "res/shaders/triangle.vert", "res/shaders/triangle.frag" };
+		Shader shader { "res/shaders/triangle.vert", "res/shaders/triangle.frag", UniformBlocks::declarations() };
+		ShaderWatcher shaderWatcher { "res/shaders" };
+		shaderWatcher.watch(shader);
+		UniformBuffer frameBuffer { UniformBuffer::create<FrameBlock>() };
+		UniformBuffer objectBuffer { UniformBuffer::create<ObjectBlock>() };
 		
 		Texture woodTexture { "res/textures/container.jpg", GL_TEXTURE0, GL_RGBA, GL_RGB };
 		
@@ -219,28 +228,10 @@ int main()
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
 		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
 
-		glVertexAttribPointer(
-			0,
-			3,
-			GL_FLOAT,
-			GL_FALSE,
-			5 * sizeof(float),
-			nullptr
-		);
-		glEnableVertexAttribArray(0);
-		glVertexAttribPointer(
-			1,
-			2,
-			GL_FLOAT,
-			GL_FALSE,
-			5 * sizeof(float),
-			(void*)(3 * sizeof(float))
-		);
-		glEnableVertexAttribArray(1);
-
-		shader.useProgram();
-		shader.setUniform("woodTexture", 0);
-		shader.setUniform("faceTexture", 1);
+		VertexLayout layout {};
+		layout.attributes.push_back({ "aPos", 3, GL_FLOAT, false, 5 * sizeof(float), 0, vbo });
+		layout.attributes.push_back({ "aTexCoords", 2, GL_FLOAT, false, 5 * sizeof(float), 3 * sizeof(float), vbo });
+		shader.getReflection().bindVertexLayout(layout);
 
 		while (!window.shouldClose())
 		{
@@ -249,23 +240,30 @@ int main()
 			deltaTime = currentFrame - lastFrame;
 			lastFrame = currentFrame;
 			processMovementInput(window);
+			shaderWatcher.poll();
 
 			// rendering
 			glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
 			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 			shader.useProgram();
+			// Only uploaded after the program was (re)loaded
+			shader.setUniform("woodTexture", 0);
+			shader.setUniform("faceTexture", 1);
 			woodTexture.bind();
 			faceTexture.bind();
 			glBindVertexArray(vao);
-			glm::mat4 model { 1.0f };
-			model = glm::rotate(model, (float)glfwGetTime() * glm::radians(50.0f), glm::vec3(0.5f, 1.0f, 0.0f));
-			glm::mat4 view {
-				camera.getViewMatrix()
-			};
-			glm::mat4 projection { glm::perspective(glm::radians(camera.getFov()), static_cast<float>(WINDOW_WIDTH)/static_cast<float>(WINDOW_HEIGHT), 0.1f, 100.0f) };
-			shader.setUniform("model", model);
-			shader.setUniform("view", view);
-			shader.setUniform("projection", projection);
+			FrameBlock frame {};
+			frame.view = camera.getViewMatrix();
+			frame.projection = glm::perspective(glm::radians(camera.getFov()), static_cast<float>(WINDOW_WIDTH)/static_cast<float>(WINDOW_HEIGHT), 0.1f, 100.0f);
+			frame.cameraPosition = camera.getPosition();
+			frame.time = currentFrame;
+			frameBuffer.update(frame);
+			frameBuffer.bind();
+			ObjectBlock object {};
+			object.model = glm::rotate(glm::mat4 { 1.0f }, (float)glfwGetTime() * glm::radians(50.0f), glm::vec3(0.5f, 1.0f, 0.0f));
+			object.normalMatrix = glm::transpose(glm::inverse(object.model));
+			objectBuffer.update(object);
+			objectBuffer.bind();
 			// glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 			glDrawArrays(GL_TRIANGLES, 0, 36);
 			glBindVertexArray(0);
@@ -302,6 +300,16 @@ int main()
 		spdlog::critical("Exception thrown: {}", e.what());
 		exit(-1);
 	}
+	catch (ShaderReflection::VertexLayoutException &e)
+	{
+		spdlog::critical("Exception thrown: {}", e.what());
+		exit(-1);
+	}
+	catch (ShaderPreprocessor::PreprocessingException &e)
+	{
+		spdlog::critical("Exception thrown: {}", e.what());
+		exit(-1);
+	}
 	catch (Texture::TextureLoadingException &e)
 	{
 		spdlog::critical("Exception thrown: {}", e.what());
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <vector>
+#include "BlockCompression.hpp"
+
+TEST(BlockCompressionTest, shouldComputeSizeOfPartialBlocks)
+{
+	ASSERT_EQ(4u * 8u, BlockCompression::getCompressedSize(BlockCompression::Format::BC1, 5, 5));
+	ASSERT_EQ(16u, BlockCompression::getCompressedSize(BlockCompression::Format::BC5, 1, 1));
+}
+
+TEST(BlockCompressionTest, shouldEncodeFlatBC1BlockExactlyWhenRepresentable)
+{
+	std::vector<unsigned char> rgba(64);
+	for (int i = 0; i < 16; i++)
+	{
+		rgba[i * 4] = 255;
+		rgba[i * 4 + 1] = 0;
+		rgba[i * 4 + 2] = 255;
+		rgba[i * 4 + 3] = 255;
+	}
+	unsigned char block[8] {};
+	BlockCompression::encodeBC1Block(rgba.data(), block);
+
+	std::vector<unsigned char> decoded(64);
+	BlockCompression::decodeBC1Block(block, decoded.data());
+	ASSERT_EQ(rgba, decoded);
+}
+
+TEST(BlockCompressionTest, shouldKeepBC1GradientErrorSmall)
+{
+	std::vector<unsigned char> rgba(64);
+	for (int i = 0; i < 16; i++)
+	{
+		rgba[i * 4] = static_cast<unsigned char>(i * 16);
+		rgba[i * 4 + 1] = static_cast<unsigned char>(255 - i * 16);
+		rgba[i * 4 + 2] = 64;
+		rgba[i * 4 + 3] = 255;
+	}
+	unsigned char block[8] {};
+	BlockCompression::encodeBC1Block(rgba.data(), block);
+
+	std::vector<unsigned char> decoded(64);
+	BlockCompression::decodeBC1Block(block, decoded.data());
+	// A 16 step ramp spans four palette entries, so no pixel can be off by more than half their spacing
+	for (int i = 0; i < 64; i++)
+		ASSERT_LE(std::abs(rgba[i] - decoded[i]), 40);
+}
+
+TEST(BlockCompressionTest, shouldEncodeTwoValueBC4BlockExactly)
+{
+	unsigned char values[16] {};
+	for (int i = 0; i < 16; i++)
+		values[i] = i % 2 ? 200 : 10;
+	unsigned char block[8] {};
+	BlockCompression::encodeBC4Block(values, block);
+
+	unsigned char decoded[16] {};
+	BlockCompression::decodeBC4Block(block, decoded);
+	for (int i = 0; i < 16; i++)
+		ASSERT_EQ(values[i], decoded[i]);
+}
+
+TEST(BlockCompressionTest, shouldEncodeBothChannelsOfBC5Image)
+{
+	std::vector<unsigned char> pixels(6 * 6 * 2);
+	for (std::size_t i = 0; i < pixels.size(); i += 2)
+	{
+		pixels[i] = 30;
+		pixels[i + 1] = 220;
+	}
+	std::vector<unsigned char> blocks(BlockCompression::getCompressedSize(BlockCompression::Format::BC5, 6, 6));
+	BlockCompression::encode(BlockCompression::Format::BC5, pixels.data(), 6, 6, 2, blocks.data());
+
+	for (std::size_t b = 0; b < blocks.size(); b += 16)
+	{
+		unsigned char red[16] {}, green[16] {};
+		BlockCompression::decodeBC4Block(&blocks[b], red);
+		BlockCompression::decodeBC4Block(&blocks[b + 8], green);
+		for (int i = 0; i < 16; i++)
+		{
+			ASSERT_EQ(30, red[i]);
+			ASSERT_EQ(220, green[i]);
+		}
+	}
+}
+
+TEST(BlockCompressionTest, shouldKeepBC7GradientWithAlphaClose)
+{
+	std::vector<unsigned char> rgba(64);
+	for (int i = 0; i < 16; i++)
+	{
+		rgba[i * 4] = static_cast<unsigned char>(i * 16);
+		rgba[i * 4 + 1] = static_cast<unsigned char>(255 - i * 16);
+		rgba[i * 4 + 2] = 64;
+		rgba[i * 4 + 3] = static_cast<unsigned char>(128 + i * 8);
+	}
+	unsigned char block[16] {};
+	BlockCompression::encodeBC7Block(rgba.data(), block);
+
+	std::vector<unsigned char> decoded(64);
+	BlockCompression::decodeBC7Block(block, decoded.data());
+	// Sixteen indices along a straight ramp leave little more than the 7-bit endpoint rounding
+	for (int i = 0; i < 64; i++)
+		ASSERT_LE(std::abs(rgba[i] - decoded[i]), 4);
+}
+
+TEST(BlockCompressionTest, shouldKeepBC6HRelativeErrorSmall)
+{
+	float rgb[48] {};
+	for (int i = 0; i < 16; i++)
+	{
+		rgb[i * 3] = 4.0f + i * 0.25f;
+		rgb[i * 3 + 1] = 1.0f + i * 0.0625f;
+		rgb[i * 3 + 2] = 16.0f;
+	}
+	unsigned char block[16] {};
+	BlockCompression::encodeBC6HBlock(rgb, block);
+
+	float decoded[48] {};
+	BlockCompression::decodeBC6HBlock(block, decoded);
+	// Interpolation happens on half float bits, so ramps within an octave stay nearly linear
+	for (int i = 0; i < 48; i++)
+		ASSERT_NEAR(rgb[i], decoded[i], rgb[i] * 0.02f);
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "ChannelPacker.hpp"
+
+TEST(ChannelPackerTest, shouldMergeOcclusionAndMetallicRoughness)
+{
+	std::vector<Material> materials(2);
+	materials[0].occlusion.image = 1;
+	materials[0].metallicRoughness.image = 2;
+	materials[1].occlusion.image = 1;
+	materials[1].metallicRoughness.image = 2;
+
+	const std::vector<ChannelPacker::Source> sources { ChannelPacker::plan(materials) };
+
+	ASSERT_EQ(1u, sources.size());
+	ASSERT_EQ(1, sources[0].occlusion);
+	ASSERT_EQ(2, sources[0].metallicRoughness);
+	for (const Material &material : materials)
+	{
+		ASSERT_EQ(0, material.occlusion.packed);
+		ASSERT_EQ(0, material.metallicRoughness.packed);
+	}
+}
+
+TEST(ChannelPackerTest, shouldPackSeparatelyIfTexCoordsDiffer)
+{
+	std::vector<Material> materials(1);
+	materials[0].occlusion.image = 0;
+	materials[0].occlusion.texCoord = 1;
+	materials[0].metallicRoughness.image = 3;
+
+	const std::vector<ChannelPacker::Source> sources { ChannelPacker::plan(materials) };
+
+	ASSERT_EQ(2u, sources.size());
+	ASSERT_EQ(0, sources[materials[0].occlusion.packed].occlusion);
+	ASSERT_EQ(-1, sources[materials[0].occlusion.packed].metallicRoughness);
+	ASSERT_EQ(-1, sources[materials[0].metallicRoughness.packed].occlusion);
+	ASSERT_EQ(3, sources[materials[0].metallicRoughness.packed].metallicRoughness);
+}
+
+TEST(ChannelPackerTest, shouldLeaveAlreadyPackedImagesAlone)
+{
+	std::vector<Material> materials(1);
+	materials[0].occlusion.image = 4;
+	materials[0].metallicRoughness.image = 4;
+
+	ASSERT_TRUE(ChannelPacker::plan(materials).empty());
+	ASSERT_EQ(-1, materials[0].occlusion.packed);
+	ASSERT_EQ(-1, materials[0].metallicRoughness.packed);
+}
+
+TEST(ChannelPackerTest, shouldLeaveOtherReferencesAlone)
+{
+	std::vector<Material> materials(1);
+	materials[0].baseColor.image = 0;
+	materials[0].normal.image = 1;
+
+	ASSERT_TRUE(ChannelPacker::plan(materials).empty());
+	ASSERT_EQ(-1, materials[0].baseColor.packed);
+	ASSERT_EQ(-1, materials[0].occlusion.packed);
+	ASSERT_EQ(-1, materials[0].metallicRoughness.packed);
+}
\ No newline at end of file
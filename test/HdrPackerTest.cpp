@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "HdrPacker.hpp"
+
+TEST(HdrPackerTest, shouldRoundTripRgb9E5WithinMantissaPrecision)
+{
+	const std::vector<float> rgb { 1.0f, 0.5f, 0.25f, 1000.0f, 3.0f, 0.001f, 0.0f, 0.0f, 0.0f, 65000.0f, 1.0f, 2.0f, 0.1f, 0.2f, 0.3f };
+	std::vector<std::uint32_t> packed(rgb.size() / 3);
+
+	HdrPacker::packRgb9E5(rgb.data(), packed.size(), packed.data());
+
+	for (std::size_t i = 0; i < packed.size(); i++)
+	{
+		float unpacked[3] {};
+		HdrPacker::unpackRgb9E5(packed[i], unpacked);
+		const float largest { std::max(std::max(rgb[i * 3], rgb[i * 3 + 1]), rgb[i * 3 + 2]) };
+		for (int c = 0; c < 3; c++)
+			ASSERT_NEAR(rgb[i * 3 + c], unpacked[c], largest / 256.0f);
+	}
+}
+
+TEST(HdrPackerTest, shouldRoundTripR11G11B10FWithinMantissaPrecision)
+{
+	const std::vector<float> rgb { 1.0f, 0.5f, 0.25f, 1000.0f, 3.0f, 0.001f, 0.0f, 0.0f, 0.0f, 60000.0f, 1e-5f, 2.0f, 0.1f, 0.2f, 0.3f };
+	std::vector<std::uint32_t> packed(rgb.size() / 3);
+
+	HdrPacker::packR11G11B10F(rgb.data(), packed.size(), packed.data());
+
+	for (std::size_t i = 0; i < packed.size(); i++)
+	{
+		float unpacked[3] {};
+		HdrPacker::unpackR11G11B10F(packed[i], unpacked);
+		for (int c = 0; c < 3; c++)
+			ASSERT_NEAR(rgb[i * 3 + c], unpacked[c], rgb[i * 3 + c] / (c == 2 ? 32.0f : 64.0f) + 1e-6f);
+	}
+}
+
+TEST(HdrPackerTest, shouldClampNegativeNanAndHugeValues)
+{
+	const float nan { std::numeric_limits<float>::quiet_NaN() };
+	const float inf { std::numeric_limits<float>::infinity() };
+	const std::vector<float> rgb { -1.0f, nan, inf, -1.0f, nan, inf, -1.0f, nan, inf, -1.0f, nan, inf };
+	std::vector<std::uint32_t> shared(4), separate(4);
+
+	HdrPacker::packRgb9E5(rgb.data(), shared.size(), shared.data());
+	HdrPacker::packR11G11B10F(rgb.data(), separate.size(), separate.data());
+
+	float unpacked[3] {};
+	HdrPacker::unpackRgb9E5(shared[0], unpacked);
+	ASSERT_EQ(0.0f, unpacked[0]);
+	ASSERT_EQ(0.0f, unpacked[1]);
+	ASSERT_EQ(65408.0f, unpacked[2]);
+	HdrPacker::unpackR11G11B10F(separate[3], unpacked);
+	ASSERT_EQ(0.0f, unpacked[0]);
+	ASSERT_EQ(0.0f, unpacked[1]);
+	ASSERT_EQ(64512.0f, unpacked[2]);
+}
+
+TEST(HdrPackerTest, shouldPackSimdAndRemainderPixelsAlike)
+{
+	std::vector<float> rgb(7 * 3);
+	for (std::size_t i = 0; i < rgb.size(); i++)
+		rgb[i] = std::pow(1.7f, static_cast<float>(i) - 10.0f);
+	std::vector<std::uint32_t> all(7), single(1);
+
+	HdrPacker::packRgb9E5(rgb.data(), all.size(), all.data());
+	for (std::size_t i = 0; i < all.size(); i++)
+	{
+		HdrPacker::packRgb9E5(rgb.data() + i * 3, 1, single.data());
+		ASSERT_EQ(single[0], all[i]);
+	}
+	HdrPacker::packR11G11B10F(rgb.data(), all.size(), all.data());
+	for (std::size_t i = 0; i < all.size(); i++)
+	{
+		HdrPacker::packR11G11B10F(rgb.data() + i * 3, 1, single.data());
+		ASSERT_EQ(single[0], all[i]);
+	}
+}
+
+TEST(HdrPackerTest, shouldPreserveFlatColorAndEnergyWhenResampling)
+{
+	std::vector<float> flat(1000 * 600 * 3, 12.5f);
+	const std::vector<float> resized { HdrPacker::resample(flat, 1000, 600, 256, 154) };
+	ASSERT_EQ(256u * 154u * 3u, resized.size());
+	for (float value : resized)
+		ASSERT_NEAR(12.5f, value, 1e-3f);
+
+	// A single bright pixel keeps its share of the total instead of ringing or vanishing
+	std::vector<float> spot(9 * 3, 0.0f);
+	spot[4 * 3] = 900.0f;
+	const std::vector<float> small { HdrPacker::resample(spot, 3, 3, 1, 1) };
+	ASSERT_NEAR(100.0f, small[0], 1e-3f);
+	ASSERT_EQ(0.0f, small[1]);
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "ImageCache.hpp"
+
+TEST(ImageCacheTest, shouldMapStoredLevels)
+{
+	ImageCache cache { "ImageCacheTest" };
+	ASSERT_TRUE(cache.isEnabled());
+
+	std::vector<unsigned char> level0(8 * 4 * 4), level1(4 * 2 * 4);
+	for (std::size_t i = 0; i < level0.size(); i++)
+		level0[i] = static_cast<unsigned char>(i);
+	for (std::size_t i = 0; i < level1.size(); i++)
+		level1[i] = static_cast<unsigned char>(255 - i);
+	cache.store(42, { GL_SRGB8_ALPHA8, GL_RGBA, GL_UNSIGNED_BYTE, false }, 4, { { level0.data(), level0.size(), 8, 4 }, { level1.data(), level1.size(), 4, 2 } });
+
+	std::unique_ptr<ImageCache::Entry> entry { cache.find(42) };
+	ASSERT_NE(entry, nullptr);
+	EXPECT_EQ(entry->format.internalFormat, GL_SRGB8_ALPHA8);
+	EXPECT_EQ(entry->format.format, static_cast<GLenum>(GL_RGBA));
+	EXPECT_FALSE(entry->format.compressed);
+	EXPECT_EQ(entry->channels, 4);
+	ASSERT_EQ(entry->levels.size(), 2u);
+	EXPECT_EQ(entry->levels[1].width, 4);
+	EXPECT_EQ(entry->levels[1].height, 2);
+	EXPECT_EQ(reinterpret_cast<std::uintptr_t>(entry->levels[1].data) % 16, 0u);
+	EXPECT_EQ(std::memcmp(entry->levels[0].data, level0.data(), level0.size()), 0);
+	EXPECT_EQ(std::memcmp(entry->levels[1].data, level1.data(), level1.size()), 0);
+
+	EXPECT_EQ(cache.find(43), nullptr);
+	entry.reset();
+	std::remove("ImageCacheTest/000000000000002a.img");
+	std::remove("ImageCacheTest");
+}
+
+TEST(ImageCacheTest, shouldMissOnLevelsSmallerThanTheirFormatImplies)
+{
+	ImageCache cache { "ImageCacheTest" };
+
+	// 8x4 RGBA8 needs 128 bytes, 8x4 BC4 needs 2 blocks of 8 bytes
+	std::vector<unsigned char> pixels(8 * 4 * 4 - 1), blocks(8);
+	cache.store(44, { GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, false }, 4, { { pixels.data(), pixels.size(), 8, 4 } });
+	cache.store(45, { GL_COMPRESSED_RED_RGTC1, GL_NONE, GL_NONE, true }, 1, { { blocks.data(), blocks.size(), 8, 4 } });
+	EXPECT_EQ(cache.find(44), nullptr);
+	EXPECT_EQ(cache.find(45), nullptr);
+
+	blocks.resize(16);
+	cache.store(45, { GL_COMPRESSED_RED_RGTC1, GL_NONE, GL_NONE, true }, 1, { { blocks.data(), blocks.size(), 8, 4 } });
+	EXPECT_NE(cache.find(45), nullptr);
+
+	std::remove("ImageCacheTest/000000000000002c.img");
+	std::remove("ImageCacheTest/000000000000002d.img");
+	std::remove("ImageCacheTest");
+}
+
+TEST(ImageCacheTest, shouldKeyByContentAndOptions)
+{
+	const unsigned char a[] { 1, 2, 3, 4 };
+	const unsigned char b[] { 1, 2, 3, 5 };
+	TextureLoadOptions options {};
+	const std::uint64_t key { ImageCache::keyOf(a, sizeof(a), options, true) };
+	EXPECT_EQ(key, ImageCache::keyOf(a, sizeof(a), options, true));
+	EXPECT_NE(key, ImageCache::keyOf(b, sizeof(b), options, true));
+
+	options.compression = TextureLoadOptions::Compression::BC1;
+	EXPECT_NE(key, ImageCache::keyOf(a, sizeof(a), options, true));
+	EXPECT_NE(ImageCache::keyOf(a, sizeof(a), options, true), ImageCache::keyOf(a, sizeof(a), options, false));
+	options = TextureLoadOptions {};
+	options.flipVertically = false;
+	EXPECT_NE(key, ImageCache::keyOf(a, sizeof(a), options, true));
+}
+
+TEST(ImageCacheTest, shouldMissOnDisabledCache)
+{
+	ImageCache cache {};
+	EXPECT_FALSE(cache.isEnabled());
+	EXPECT_EQ(cache.find(42), nullptr);
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <jpeglib.h>
+#include "JpegDecoder.hpp"
+
+namespace
+{
+	constexpr int width { 37 };
+	constexpr int height { 21 };
+
+	// A gray image darkest in the top row, encoded with libjpeg at full quality
+	std::vector<unsigned char> encodeJpeg()
+	{
+		jpeg_compress_struct info {};
+		jpeg_error_mgr errors {};
+		info.err = jpeg_std_error(&errors);
+		jpeg_create_compress(&info);
+
+		unsigned char *buffer { nullptr };
+		unsigned long size {};
+		jpeg_mem_dest(&info, &buffer, &size);
+		info.image_width = width;
+		info.image_height = height;
+		info.input_components = 1;
+		info.in_color_space = JCS_GRAYSCALE;
+		jpeg_set_defaults(&info);
+		jpeg_set_quality(&info, 100, TRUE);
+		jpeg_start_compress(&info, TRUE);
+
+		std::vector<unsigned char> row(width);
+		while (info.next_scanline < info.image_height)
+		{
+			for (int x = 0; x < width; x++)
+				row[x] = static_cast<unsigned char>(info.next_scanline * 10);
+			JSAMPROW rows[1] { row.data() };
+			jpeg_write_scanlines(&info, rows, 1);
+		}
+		jpeg_finish_compress(&info);
+		jpeg_destroy_compress(&info);
+
+		std::vector<unsigned char> encoded(buffer, buffer + size);
+		std::free(buffer);
+		return encoded;
+	}
+}
+
+TEST(JpegDecoderTest, shouldDecodeAtFullSizeIntoBuffer)
+{
+	const std::vector<unsigned char> encoded { encodeJpeg() };
+	ASSERT_TRUE(JpegDecoder::isJpeg(encoded.data(), encoded.size()));
+
+	std::vector<unsigned char> pixels(width * height * 4);
+	int decodedWidth {}, decodedHeight {};
+	ASSERT_TRUE(JpegDecoder::decode(encoded.data(), encoded.size(), 4, false, pixels.data(), pixels.size(), decodedWidth, decodedHeight));
+
+	ASSERT_EQ(width, decodedWidth);
+	ASSERT_EQ(height, decodedHeight);
+	EXPECT_NEAR(0, pixels[0], 4);
+	EXPECT_NEAR(200, pixels[(height - 1) * width * 4], 4);
+	EXPECT_EQ(255, pixels[3]);
+}
+
+TEST(JpegDecoderTest, shouldFlipVertically)
+{
+	const std::vector<unsigned char> encoded { encodeJpeg() };
+	std::vector<unsigned char> pixels(width * height);
+	int decodedWidth {}, decodedHeight {};
+	ASSERT_TRUE(JpegDecoder::decode(encoded.data(), encoded.size(), 1, true, pixels.data(), pixels.size(), decodedWidth, decodedHeight));
+
+	EXPECT_NEAR(200, pixels[0], 4);
+	EXPECT_NEAR(0, pixels[(height - 1) * width], 4);
+}
+
+TEST(JpegDecoderTest, shouldDecodeAtFullSizeWithoutMinimum)
+{
+	const std::vector<unsigned char> encoded { encodeJpeg() };
+	std::vector<unsigned char> pixels {};
+	int decodedWidth {}, decodedHeight {};
+	ASSERT_TRUE(JpegDecoder::decode(encoded.data(), encoded.size(), 3, 0, 0, false, pixels, decodedWidth, decodedHeight));
+
+	ASSERT_EQ(width, decodedWidth);
+	ASSERT_EQ(height, decodedHeight);
+	ASSERT_EQ(static_cast<std::size_t>(width * height * 3), pixels.size());
+}
+
+TEST(JpegDecoderTest, shouldScaleDownNoFurtherThanMinimum)
+{
+	const std::vector<unsigned char> encoded { encodeJpeg() };
+	std::vector<unsigned char> pixels {};
+	int decodedWidth {}, decodedHeight {};
+	ASSERT_TRUE(JpegDecoder::decode(encoded.data(), encoded.size(), 3, 10, 5, false, pixels, decodedWidth, decodedHeight));
+
+	ASSERT_EQ(10, decodedWidth);
+	ASSERT_EQ(6, decodedHeight);
+	ASSERT_EQ(static_cast<std::size_t>(decodedWidth * decodedHeight * 3), pixels.size());
+}
+
+TEST(JpegDecoderTest, shouldRejectTooSmallBuffer)
+{
+	const std::vector<unsigned char> encoded { encodeJpeg() };
+	std::vector<unsigned char> pixels(width * height * 3 - 1);
+	int decodedWidth {}, decodedHeight {};
+	ASSERT_FALSE(JpegDecoder::decode(encoded.data(), encoded.size(), 3, false, pixels.data(), pixels.size(), decodedWidth, decodedHeight));
+}
\ No newline at end of file
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Ktx2.hpp"
+#include "MappedFile.hpp"
+#include "BlockCompression.hpp"
+#include "TextureCooker.hpp"
+
+namespace
+{
+	std::vector<unsigned char> makePpm(int width, int height)
+	{
+		const std::string header { "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n" };
+		std::vector<unsigned char> ppm(header.begin(), header.end());
+		for (int y = 0; y < height; y++)
+			for (int x = 0; x < width; x++)
+			{
+				ppm.push_back(static_cast<unsigned char>(x * 255 / (width - 1)));
+				ppm.push_back(64);
+				ppm.push_back(128);
+			}
+		return ppm;
+	}
+}
+
+TEST(Ktx2Test, shouldReadBackEncodedLevels)
+{
+	std::vector<std::vector<unsigned char>> levels { std::vector<unsigned char>(4 * 4 * 4, 7), std::vector<unsigned char>(2 * 2 * 4, 9), std::vector<unsigned char>(4, 11) };
+	const std::vector<unsigned char> file { Ktx2::encode(Ktx2::formatRGBA8, 4, 4, levels) };
+
+	ASSERT_TRUE(Ktx2::isKtx2(file.data(), file.size()));
+	Ktx2 container { file.data(), file.size() };
+	ASSERT_EQ(Ktx2::formatRGBA8, container.getVkFormat());
+	ASSERT_EQ(3u, container.getLevelCount());
+	for (std::size_t i = 0; i < levels.size(); i++)
+	{
+		const Ktx2::Level &level { container.getLevel(i) };
+		ASSERT_EQ(4 >> i, level.width);
+		ASSERT_EQ(0u, (level.data - file.data()) % 16);
+		ASSERT_EQ(levels[i], std::vector<unsigned char>(level.data, level.data + level.size));
+	}
+}
+
+TEST(Ktx2Test, shouldRejectTruncatedContainer)
+{
+	std::vector<std::vector<unsigned char>> levels { std::vector<unsigned char>(64, 1) };
+	std::vector<unsigned char> file { Ktx2::encode(Ktx2::formatRGBA8, 4, 4, levels) };
+	file.resize(file.size() - 1);
+
+	ASSERT_THROW(Ktx2 container(file.data(), file.size()), Ktx2::InvalidFileException);
+}
+
+TEST(Ktx2Test, shouldRejectLevelsTooShortForTheirDimensions)
+{
+	std::vector<std::vector<unsigned char>> levels { std::vector<unsigned char>(4 * 4 * 4, 1), std::vector<unsigned char>(4, 2) };
+	const std::vector<unsigned char> file { Ktx2::encode(Ktx2::formatRGBA8, 4, 4, levels) };
+
+	ASSERT_THROW(Ktx2 container(file.data(), file.size()), Ktx2::InvalidFileException);
+}
+
+TEST(Ktx2Test, shouldRejectMoreLevelsThanDimensionsAllow)
+{
+	std::vector<std::vector<unsigned char>> levels { std::vector<unsigned char>(2 * 2 * 4, 1), std::vector<unsigned char>(4, 2), std::vector<unsigned char>(4, 3) };
+	const std::vector<unsigned char> file { Ktx2::encode(Ktx2::formatRGBA8, 2, 2, levels) };
+
+	ASSERT_THROW(Ktx2 container(file.data(), file.size()), Ktx2::InvalidFileException);
+}
+
+TEST(Ktx2Test, shouldParseContainerInPlaceFromMappedFile)
+{
+	std::vector<std::vector<unsigned char>> levels { std::vector<unsigned char>(2 * 2 * 4, 5), std::vector<unsigned char>(4, 6) };
+	const std::vector<unsigned char> file { Ktx2::encode(Ktx2::formatRGBA8Srgb, 2, 2, levels) };
+	const std::string path { "Ktx2Test.ktx2" };
+	{
+		std::ofstream os { path, std::ios::binary };
+		os.write(reinterpret_cast<const char *>(file.data()), file.size());
+	}
+
+	MappedFile mapped { path };
+	ASSERT_EQ(file.size(), mapped.getSize());
+	Ktx2 container { mapped.getData(), mapped.getSize() };
+	ASSERT_EQ(Ktx2::supercompressionNone, container.getSupercompression());
+	ASSERT_EQ(static_cast<GLenum>(GL_SRGB8_ALPHA8), container.getGLFormat().internalFormat);
+	ASSERT_TRUE(container.getLevel(1).data > mapped.getData());
+	ASSERT_TRUE(container.getLevel(1).data + 4 <= mapped.getData() + mapped.getSize());
+	ASSERT_EQ(levels[1], std::vector<unsigned char>(container.getLevel(1).data, container.getLevel(1).data + 4));
+	std::remove(path.c_str());
+}
+
+TEST(Ktx2Test, shouldCookFullBC7MipChain)
+{
+	const std::vector<unsigned char> ppm { makePpm(8, 8) };
+	TextureCooker::Options options {};
+	options.srgb = false;
+	options.flipVertically = false;
+	const std::vector<unsigned char> file { TextureCooker::cook(ppm.data(), ppm.size(), options) };
+
+	Ktx2 container { file.data(), file.size() };
+	ASSERT_EQ(Ktx2::formatBC7, container.getVkFormat());
+	ASSERT_EQ(4u, container.getLevelCount());
+	ASSERT_EQ(16u, container.getLevel(3).size);
+
+	unsigned char rgba[64] {};
+	BlockCompression::decodeBC7Block(container.getLevel(0).data, rgba);
+	for (int y = 0; y < 4; y++)
+		for (int x = 0; x < 4; x++)
+		{
+			ASSERT_NEAR(x * 255 / 7, rgba[(y * 4 + x) * 4], 4);
+			ASSERT_NEAR(64, rgba[(y * 4 + x) * 4 + 1], 4);
+			ASSERT_EQ(255, rgba[(y * 4 + x) * 4 + 3]);
+		}
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+#include "MipChain.hpp"
+
+TEST(MipChainTest, shouldLayOutFullChainForNonSquareImage)
+{
+	MipChain chain { 5, 3, 4 };
+
+	ASSERT_EQ(3u, chain.getLevelCount());
+	ASSERT_EQ(2, chain.getLevel(1).width);
+	ASSERT_EQ(1, chain.getLevel(1).height);
+	ASSERT_EQ(1, chain.getLevel(2).width);
+	ASSERT_EQ(1, chain.getLevel(2).height);
+	ASSERT_EQ(chain.getLevel(1).offset, chain.getLevel(0).size);
+	ASSERT_EQ((5u * 3u + 2u + 1u) * 4u, chain.getSize());
+}
+
+TEST(MipChainTest, shouldThrowForInvalidChannelCount)
+{
+	ASSERT_THROW(MipChain(4, 4, 5), MipChain::InvalidImageException);
+}
+
+TEST(MipChainTest, shouldBoxFilterLinearValues)
+{
+	MipChain chain { 2, 2, 1 };
+	const unsigned char pixels[] { 0, 100, 200, 100 };
+	std::memcpy(chain.getData(), pixels, sizeof(pixels));
+
+	MipChain::Options options {};
+	options.filter = MipChain::Filter::Box;
+	options.srgb = false;
+	chain.generate(options);
+
+	ASSERT_EQ(100, chain.getLevelData(1)[0]);
+}
+
+TEST(MipChainTest, shouldAverageSrgbValuesInLinearSpace)
+{
+	MipChain chain { 2, 1, 3 };
+	const unsigned char pixels[] { 0, 0, 0, 255, 255, 255 };
+	std::memcpy(chain.getData(), pixels, sizeof(pixels));
+
+	MipChain::Options options {};
+	options.filter = MipChain::Filter::Box;
+	options.srgb = true;
+	chain.generate(options);
+
+	// Half intensity in linear light is ~188 in sRGB, a naive average would give 128
+	ASSERT_NEAR(188, chain.getLevelData(1)[0], 1);
+}
+
+TEST(MipChainTest, shouldNotBleedColorOfTransparentPixels)
+{
+	MipChain chain { 2, 1, 4 };
+	const unsigned char pixels[] { 255, 0, 0, 0, 0, 255, 0, 255 };
+	std::memcpy(chain.getData(), pixels, sizeof(pixels));
+
+	MipChain::Options options {};
+	options.filter = MipChain::Filter::Box;
+	options.srgb = false;
+	chain.generate(options);
+
+	const unsigned char *result { chain.getLevelData(1) };
+	ASSERT_EQ(0, result[0]);
+	ASSERT_EQ(255, result[1]);
+	ASSERT_NEAR(128, result[3], 1);
+}
+
+TEST(MipChainTest, shouldPreserveFlatColorWithKaiserFilter)
+{
+	MipChain chain { 16, 16, 4 };
+	std::memset(chain.getData(), 77, chain.getLevel(0).size);
+
+	chain.generate(MipChain::Options {});
+
+	for (std::size_t level = 1; level < chain.getLevelCount(); level++)
+		for (std::size_t i = 0; i < chain.getLevel(level).size; i++)
+			ASSERT_NEAR(77, chain.getLevelData(level)[i], 1);
+}
+
+TEST(MipChainTest, shouldPreserveFlatColorWhenResampling)
+{
+	const std::vector<unsigned char> pixels(1000 * 600 * 3, 140);
+	std::vector<unsigned char> resized(256 * 154 * 3);
+
+	MipChain::resample(pixels.data(), 1000, 600, 3, resized.data(), 256, 154, MipChain::Options {});
+
+	for (unsigned char value : resized)
+		ASSERT_NEAR(140, value, 1);
+}
+
+TEST(MipChainTest, shouldKeepGradientOrderWhenResampling)
+{
+	std::vector<unsigned char> pixels(300);
+	for (std::size_t x = 0; x < pixels.size(); x++)
+		pixels[x] = static_cast<unsigned char>(x * 255 / (pixels.size() - 1));
+	std::vector<unsigned char> resized(7);
+
+	MipChain::Options options {};
+	options.srgb = false;
+	MipChain::resample(pixels.data(), 300, 1, 1, resized.data(), 7, 1, options);
+
+	for (std::size_t x = 1; x < resized.size(); x++)
+		ASSERT_LT(resized[x - 1], resized[x]);
+	ASSERT_NEAR(128, resized[3], 2);
+}
\ No newline at end of file
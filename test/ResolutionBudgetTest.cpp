@@ -0,0 +1,34 @@
+#include <gtest/gtest.h>
+#include "ResolutionBudget.hpp"
+
+TEST(ResolutionBudgetTest, shouldBeUnlimitedByDefault)
+{
+	ResolutionBudget budget {};
+
+	ASSERT_EQ(0, budget.getLimit(ResolutionBudget::Role::BaseColor));
+	ASSERT_EQ(0, budget.apply(TextureLoadOptions {}, ResolutionBudget::Role::Normal).maxDimension);
+}
+
+TEST(ResolutionBudgetTest, shouldUseTighterOfGlobalAndRoleLimit)
+{
+	ResolutionBudget budget { 1024 };
+	budget.setLimit(ResolutionBudget::Role::Normal, 512);
+	budget.setLimit(ResolutionBudget::Role::Emissive, 2048);
+
+	ASSERT_EQ(1024, budget.getLimit(ResolutionBudget::Role::BaseColor));
+	ASSERT_EQ(512, budget.getLimit(ResolutionBudget::Role::Normal));
+	ASSERT_EQ(1024, budget.getLimit(ResolutionBudget::Role::Emissive));
+}
+
+TEST(ResolutionBudgetTest, shouldKeepTighterLimitOfOptions)
+{
+	ResolutionBudget budget {};
+	budget.setLimit(ResolutionBudget::Role::Orm, 512);
+	TextureLoadOptions options {};
+	options.maxDimension = 256;
+
+	ASSERT_EQ(256, budget.apply(options, ResolutionBudget::Role::Orm).maxDimension);
+	ASSERT_EQ(256, budget.apply(options, ResolutionBudget::Role::Other).maxDimension);
+	options.maxDimension = 0;
+	ASSERT_EQ(512, budget.apply(options, ResolutionBudget::Role::Orm).maxDimension);
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+#include <gtest/gtest.h>
+#include "Sampler.hpp"
+
+TEST(SamplerTest, shouldDefaultUndefinedGltfValues)
+{
+	const SamplerState state { SamplerState::fromGltf(0, 0, 0, 0) };
+	EXPECT_EQ(state, SamplerState {});
+	EXPECT_EQ(state.wrapS, GL_REPEAT);
+	EXPECT_EQ(state.minFilter, GL_LINEAR_MIPMAP_LINEAR);
+	EXPECT_EQ(state.anisotropy, 1.0f);
+}
+
+TEST(SamplerTest, shouldTakeGltfEnumsAsIs)
+{
+	// glTF stores the OpenGL enum values, e.g. 9728 NEAREST and 33071 CLAMP_TO_EDGE
+	const SamplerState state { SamplerState::fromGltf(9728, 9984, 33071, 33648, 8.0f) };
+	EXPECT_EQ(state.magFilter, GL_NEAREST);
+	EXPECT_EQ(state.minFilter, GL_NEAREST_MIPMAP_NEAREST);
+	EXPECT_EQ(state.wrapS, GL_CLAMP_TO_EDGE);
+	EXPECT_EQ(state.wrapT, GL_MIRRORED_REPEAT);
+	EXPECT_EQ(state.anisotropy, 8.0f);
+	EXPECT_NE(state, SamplerState {});
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include "ShaderPreprocessor.hpp"
+
+namespace
+{
+	void writeFile(const std::string &path, const std::string &text)
+	{
+		std::ofstream os { path, std::ios::binary };
+		os << text;
+	}
+
+	std::size_t countOf(const std::string &text, const std::string &part)
+	{
+		std::size_t count {};
+		for (std::size_t i = text.find(part); i != std::string::npos; i = text.find(part, i + 1))
+			count++;
+		return count;
+	}
+}
+
+TEST(ShaderPreprocessorTest, shouldExpandIncludesOnce)
+{
+	writeFile("PreprocessorMain.frag", "#version 330 core\n#include \"PreprocessorOnce.glsl\"\n#include \"PreprocessorGuarded.glsl\"\n#include \"PreprocessorOnce.glsl\"\nvoid main() {}\n");
+	writeFile("PreprocessorOnce.glsl", "#pragma once\n#include \"PreprocessorGuarded.glsl\"\nfloat once;\n");
+	writeFile("PreprocessorGuarded.glsl", "// lighting\n#ifndef GUARDED\n#define GUARDED\nfloat guarded;\n#endif\n");
+	ShaderPreprocessor preprocessor {};
+
+	const std::string source { preprocessor.process("PreprocessorMain.frag") };
+
+	EXPECT_EQ(0u, source.find("#version 330 core\n#line 1 1\n"));
+	EXPECT_EQ(1u, countOf(source, "float once;"));
+	EXPECT_EQ(1u, countOf(source, "float guarded;"));
+	EXPECT_EQ(0u, countOf(source, "#include"));
+	EXPECT_NE(std::string::npos, source.find("#line 5 0\nvoid main() {}"));
+	EXPECT_EQ(3u, preprocessor.getDependencies("PreprocessorMain.frag").size());
+
+	std::remove("PreprocessorMain.frag");
+	std::remove("PreprocessorOnce.glsl");
+	std::remove("PreprocessorGuarded.glsl");
+}
+
+TEST(ShaderPreprocessorTest, shouldInjectPreludeAfterVersion)
+{
+	writeFile("PreprocessorPrelude.vert", "// comment\n#version 330 core\nvoid main() {}\n");
+	ShaderPreprocessor preprocessor {};
+
+	EXPECT_EQ("// comment\n#version 330 core\n#define SKINNED\n#line 3\nvoid main() {}\n", preprocessor.process("PreprocessorPrelude.vert", "#define SKINNED\n"));
+	EXPECT_EQ("// comment\n#version 330 core\nvoid main() {}\n", preprocessor.process("PreprocessorPrelude.vert"));
+
+	std::remove("PreprocessorPrelude.vert");
+}
+
+TEST(ShaderPreprocessorTest, shouldExpandAgainWhenIncludeChanges)
+{
+	writeFile("PreprocessorChanging.frag", "#include \"PreprocessorChanging.glsl\"\n");
+	writeFile("PreprocessorChanging.glsl", "float a;\n");
+	ShaderPreprocessor preprocessor {};
+	EXPECT_NE(std::string::npos, preprocessor.process("PreprocessorChanging.frag").find("float a;"));
+
+	writeFile("PreprocessorChanging.glsl", "float changed;\n");
+
+	EXPECT_NE(std::string::npos, preprocessor.process("PreprocessorChanging.frag").find("float changed;"));
+
+	std::remove("PreprocessorChanging.frag");
+	std::remove("PreprocessorChanging.glsl");
+}
+
+TEST(ShaderPreprocessorTest, shouldExpandEveryShaderAgainWhenSharedIncludeChanges)
+{
+	writeFile("PreprocessorSharingA.frag", "#include \"PreprocessorShared.glsl\"\nfloat a;\n");
+	writeFile("PreprocessorSharingB.frag", "#include \"PreprocessorShared.glsl\"\nfloat b;\n");
+	writeFile("PreprocessorShared.glsl", "float shared;\n");
+	ShaderPreprocessor preprocessor {};
+	EXPECT_NE(std::string::npos, preprocessor.process("PreprocessorSharingA.frag").find("float shared;"));
+	EXPECT_NE(std::string::npos, preprocessor.process("PreprocessorSharingB.frag").find("float shared;"));
+
+	writeFile("PreprocessorShared.glsl", "float sharedChanged;\n");
+
+	// Reloading the include for B must not make A's old expansion look current
+	EXPECT_NE(std::string::npos, preprocessor.process("PreprocessorSharingB.frag").find("float sharedChanged;"));
+	EXPECT_NE(std::string::npos, preprocessor.process("PreprocessorSharingA.frag").find("float sharedChanged;"));
+
+	std::remove("PreprocessorSharingA.frag");
+	std::remove("PreprocessorSharingB.frag");
+	std::remove("PreprocessorShared.glsl");
+}
+
+TEST(ShaderPreprocessorTest, shouldSearchIncludeDirectories)
+{
+	writeFile("PreprocessorSearch.frag", "#include \"PreprocessorSearch.glsl\"\n");
+	writeFile("res/PreprocessorSearch.glsl", "float found;\n");
+	ShaderPreprocessor preprocessor {};
+	preprocessor.addIncludeDirectory("res");
+
+	EXPECT_NE(std::string::npos, preprocessor.process("PreprocessorSearch.frag").find("float found;"));
+
+	std::remove("PreprocessorSearch.frag");
+	std::remove("res/PreprocessorSearch.glsl");
+}
+
+TEST(ShaderPreprocessorTest, shouldThrowOnMissingOrCircularIncludes)
+{
+	writeFile("PreprocessorMissing.frag", "#include \"PreprocessorNowhere.glsl\"\n");
+	writeFile("PreprocessorCircular.glsl", "#include \"PreprocessorCircular.glsl\"\n");
+	ShaderPreprocessor preprocessor {};
+
+	EXPECT_THROW(preprocessor.process("PreprocessorMissing.frag"), ShaderPreprocessor::PreprocessingException);
+	EXPECT_THROW(preprocessor.process("PreprocessorCircular.glsl"), ShaderPreprocessor::PreprocessingException);
+	EXPECT_THROW(preprocessor.process("PreprocessorNowhere.frag"), ShaderPreprocessor::PreprocessingException);
+
+	std::remove("PreprocessorMissing.frag");
+	std::remove("PreprocessorCircular.glsl");
+}
\ No newline at end of file
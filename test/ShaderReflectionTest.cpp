@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include "ShaderReflection.hpp"
+
+namespace
+{
+	ShaderReflection reflectionOf(const std::vector<ShaderReflection::Attribute> &attributes)
+	{
+		return ShaderReflection { attributes, {}, {} };
+	}
+}
+
+TEST(ShaderReflectionTest, shouldAcceptMatchingLayout)
+{
+	ShaderReflection reflection { reflectionOf({ { "aPos", 0, GL_FLOAT_VEC3, 1 }, { "aJoints", 1, GL_UNSIGNED_INT_VEC4, 1 }, { "gl_VertexID", -1, GL_INT, 1 } }) };
+	VertexLayout layout {};
+	layout.attributes.push_back({ "aPos", 3, GL_FLOAT, false, 20, 0, 0 });
+	layout.attributes.push_back({ "aJoints", 4, GL_UNSIGNED_BYTE, false, 4, 0, 0 });
+	layout.attributes.push_back({ "aUnused", 2, GL_FLOAT, false, 20, 12, 0 });
+
+	EXPECT_TRUE(reflection.validate(layout).empty());
+}
+
+TEST(ShaderReflectionTest, shouldReportMissingAttributes)
+{
+	ShaderReflection reflection { reflectionOf({ { "aPos", 0, GL_FLOAT_VEC3, 1 }, { "aNormal", 1, GL_FLOAT_VEC3, 1 } }) };
+	VertexLayout layout {};
+	layout.attributes.push_back({ "aPos", 3, GL_FLOAT, false, 12, 0, 0 });
+
+	const std::vector<std::string> problems { reflection.validate(layout) };
+
+	ASSERT_EQ(1u, problems.size());
+	EXPECT_NE(std::string::npos, problems[0].find("aNormal"));
+}
+
+TEST(ShaderReflectionTest, shouldReportIntegerInputsFedFloats)
+{
+	ShaderReflection reflection { reflectionOf({ { "aJoints", 0, GL_INT_VEC4, 1 }, { "aWeights", 1, GL_UNSIGNED_INT_VEC4, 1 } }) };
+	VertexLayout layout {};
+	layout.attributes.push_back({ "aJoints", 4, GL_FLOAT, false, 16, 0, 0 });
+	layout.attributes.push_back({ "aWeights", 4, GL_UNSIGNED_BYTE, true, 4, 0, 0 });
+
+	EXPECT_EQ(2u, reflection.validate(layout).size());
+	EXPECT_THROW(reflection.bindVertexLayout(layout), ShaderReflection::VertexLayoutException);
+}
+
+TEST(ShaderReflectionTest, shouldReportInvalidComponentCounts)
+{
+	ShaderReflection reflection { reflectionOf({ { "aColor", 0, GL_FLOAT_VEC4, 1 } }) };
+	VertexLayout layout {};
+	layout.attributes.push_back({ "aColor", 5, GL_FLOAT, false, 20, 0, 0 });
+
+	EXPECT_EQ(1u, reflection.validate(layout).size());
+}
+
+TEST(ShaderReflectionTest, shouldRequireStrideForMatrixInputs)
+{
+	ShaderReflection reflection { reflectionOf({ { "aModel", 0, GL_FLOAT_MAT4, 1 } }) };
+	VertexLayout layout {};
+	layout.attributes.push_back({ "aModel", 4, GL_FLOAT, false, 0, 0, 0 });
+
+	EXPECT_EQ(1u, reflection.validate(layout).size());
+	layout.attributes[0].stride = 64;
+	EXPECT_TRUE(reflection.validate(layout).empty());
+}
+
+TEST(ShaderReflectionTest, shouldDescribeAttributeTypes)
+{
+	EXPECT_EQ(3, ShaderReflection::componentsOf(GL_FLOAT_VEC3));
+	EXPECT_EQ(4, ShaderReflection::componentsOf(GL_FLOAT_MAT4));
+	EXPECT_EQ(0, ShaderReflection::componentsOf(GL_DOUBLE));
+	EXPECT_EQ(4, ShaderReflection::locationsOf(GL_FLOAT_MAT4));
+	EXPECT_EQ(3, ShaderReflection::locationsOf(GL_FLOAT_MAT3x2));
+	EXPECT_EQ(1, ShaderReflection::locationsOf(GL_FLOAT_VEC2));
+	EXPECT_TRUE(ShaderReflection::isInteger(GL_UNSIGNED_INT_VEC4));
+	EXPECT_FALSE(ShaderReflection::isInteger(GL_FLOAT));
+}
+
+TEST(ShaderReflectionTest, shouldFindAttributesAndBlocks)
+{
+	ShaderReflection reflection { { { "aPos", 2, GL_FLOAT_VEC3, 1 } }, {}, { { "FrameBlock", 0, 144, 0 } } };
+
+	ASSERT_NE(nullptr, reflection.findAttribute("aPos"));
+	EXPECT_EQ(2, reflection.findAttribute("aPos")->location);
+	EXPECT_EQ(nullptr, reflection.findAttribute("aNormal"));
+	ASSERT_NE(nullptr, reflection.findUniformBlock("FrameBlock"));
+	EXPECT_EQ(144, reflection.findUniformBlock("FrameBlock")->dataSize);
+}
\ No newline at end of file
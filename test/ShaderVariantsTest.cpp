@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+#include "ShaderVariants.hpp"
+
+TEST(ShaderVariantsTest, shouldDeriveFeaturesFromMaterial)
+{
+	Material material {};
+	material.baseColor.image = 0;
+	material.normal.image = 1;
+	material.emissive.image = 2;
+	material.emissive.texCoord = 1;
+	material.alphaMode = Material::AlphaMode::Mask;
+
+	const ShaderVariants::Features features { ShaderVariants::featuresOf(material) };
+
+	ASSERT_EQ(ShaderVariants::NormalMap | ShaderVariants::EmissiveMap | ShaderVariants::AlphaMask | ShaderVariants::TexCoord0 | ShaderVariants::TexCoord1, features);
+}
+
+TEST(ShaderVariantsTest, shouldHaveNoFeaturesWithoutTextures)
+{
+	ASSERT_EQ(0u, ShaderVariants::featuresOf(Material {}));
+}
+
+TEST(ShaderVariantsTest, shouldDefineEveryFeature)
+{
+	const std::string defines { ShaderVariants::definesFor(ShaderVariants::NormalMap | ShaderVariants::Skinned | ShaderVariants::Clearcoat | ShaderVariants::TexCoord0) };
+
+	ASSERT_NE(std::string::npos, defines.find("#define HAS_NORMAL_MAP\n"));
+	ASSERT_NE(std::string::npos, defines.find("#define SKINNED\n"));
+	ASSERT_NE(std::string::npos, defines.find("#define MATERIAL_CLEARCOAT\n"));
+	ASSERT_NE(std::string::npos, defines.find("#define TEXCOORD_COUNT 1\n"));
+	ASSERT_EQ(std::string::npos, defines.find("HAS_VERTEX_COLORS"));
+}
+
+TEST(ShaderVariantsTest, shouldDefineTexCoordCount)
+{
+	ASSERT_NE(std::string::npos, ShaderVariants::definesFor(0).find("#define TEXCOORD_COUNT 0\n"));
+	ASSERT_NE(std::string::npos, ShaderVariants::definesFor(ShaderVariants::TexCoord1).find("#define TEXCOORD_COUNT 2\n"));
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "TextureArray.hpp"
+
+TEST(TextureArrayTest, shouldRemapPackedReferences)
+{
+	std::vector<Material> materials(2);
+	materials[0].baseColor.image = 0;
+	materials[0].normal.image = 1;
+	materials[1].baseColor.image = 2;
+	materials[1].emissive.image = 7;
+
+	const std::vector<TextureArray::Placement> placements { { 0, 3 }, {}, { 1, 0 } };
+	TextureArray::remap(materials, placements);
+
+	EXPECT_EQ(materials[0].baseColor.array, 0);
+	EXPECT_EQ(materials[0].baseColor.layer, 3);
+	EXPECT_EQ(materials[0].normal.array, -1);
+	EXPECT_EQ(materials[0].normal.layer, -1);
+	EXPECT_EQ(materials[1].baseColor.array, 1);
+	EXPECT_EQ(materials[1].baseColor.layer, 0);
+	EXPECT_EQ(materials[1].emissive.array, -1);
+	EXPECT_EQ(materials[1].occlusion.array, -1);
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "TextureManager.hpp"
+
+namespace
+{
+	void writeFile(const std::string &path, const std::string &text)
+	{
+		std::ofstream os { path, std::ios::binary };
+		os << text;
+	}
+
+	/**
+	 * Creating a Texture needs a context, the loader hands out handles which own a dummy and are never
+	 * dereferenced by TextureManager. Counts how often it is called.
+	 */
+	TextureManager countingManager(int &loads)
+	{
+		return TextureManager { [&loads](const unsigned char *, std::size_t, const TextureLoadOptions &)
+		{
+			loads++;
+			std::shared_ptr<std::vector<unsigned char>> storage { std::make_shared<std::vector<unsigned char>>(sizeof(Texture)) };
+			return TextureManager::Handle { storage, reinterpret_cast<Texture *>(storage->data()) };
+		} };
+	}
+}
+
+TEST(TextureManagerTest, shouldReuseTextureOfSameUri)
+{
+	writeFile("TextureManagerUri.png", "not decoded");
+	int loads {};
+	TextureManager manager { countingManager(loads) };
+
+	TextureManager::Handle first { manager.load("TextureManagerUri.png") };
+	TextureManager::Handle second { manager.load("TextureManagerUri.png") };
+
+	EXPECT_EQ(1, loads);
+	EXPECT_EQ(first, second);
+	EXPECT_EQ(1u, manager.getLiveCount());
+
+	TextureLoadOptions options {};
+	options.flipVertically = false;
+	EXPECT_NE(first, manager.load("TextureManagerUri.png", options));
+	EXPECT_EQ(2, loads);
+
+	std::remove("TextureManagerUri.png");
+}
+
+TEST(TextureManagerTest, shouldReuseTextureOfSameContent)
+{
+	writeFile("TextureManagerContentA.png", "same bytes");
+	writeFile("TextureManagerContentB.png", "same bytes");
+	const std::string bytes { "same bytes" };
+	int loads {};
+	TextureManager manager { countingManager(loads) };
+
+	TextureManager::Handle first { manager.load("TextureManagerContentA.png") };
+	TextureManager::Handle second { manager.load("TextureManagerContentB.png") };
+	TextureManager::Handle third { manager.load(reinterpret_cast<const unsigned char *>(bytes.data()), bytes.size()) };
+
+	EXPECT_EQ(1, loads);
+	EXPECT_EQ(first, second);
+	EXPECT_EQ(first, third);
+
+	std::remove("TextureManagerContentA.png");
+	std::remove("TextureManagerContentB.png");
+}
+
+TEST(TextureManagerTest, shouldLoadAgainOnceReleased)
+{
+	const std::string bytes { "released" };
+	int loads {};
+	TextureManager manager { countingManager(loads) };
+
+	manager.load(reinterpret_cast<const unsigned char *>(bytes.data()), bytes.size());
+	EXPECT_EQ(0u, manager.getLiveCount());
+	manager.load(reinterpret_cast<const unsigned char *>(bytes.data()), bytes.size());
+
+	EXPECT_EQ(2, loads);
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "TextureStreamer.hpp"
+
+TEST(TextureStreamerTest, shouldComputeUvDensityOfQuad)
+{
+	// 2x2 world units mapped onto the full 0..1 UV range
+	const std::vector<glm::vec3> positions { { 0.0f, 0.0f, 0.0f }, { 2.0f, 0.0f, 0.0f }, { 2.0f, 2.0f, 0.0f }, { 0.0f, 2.0f, 0.0f } };
+	const std::vector<glm::vec2> uvs { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
+	const std::vector<unsigned int> indices { 0, 1, 2, 0, 2, 3 };
+
+	EXPECT_NEAR(TextureStreamer::computeUvDensity(positions, uvs, indices), 0.5f, 1e-5f);
+	EXPECT_EQ(TextureStreamer::computeUvDensity(positions, uvs, {}), 0.0f);
+}
+
+TEST(TextureStreamerTest, shouldPickCoarserLevelsWithDistance)
+{
+	// At distance 1 with a 90 degree fov, a 1000 pixel viewport shows 500 pixels per world unit
+	EXPECT_EQ(TextureStreamer::computeDesiredLevel(1.0f, 90.0f, 1000, 1.0f, 512, 10), 0u);
+	EXPECT_EQ(TextureStreamer::computeDesiredLevel(1.0f, 90.0f, 1000, 1.0f, 2048, 12), 2u);
+	EXPECT_EQ(TextureStreamer::computeDesiredLevel(4.0f, 90.0f, 1000, 1.0f, 2048, 12), 4u);
+	EXPECT_EQ(TextureStreamer::computeDesiredLevel(1e6f, 90.0f, 1000, 1.0f, 2048, 12), 11u);
+	EXPECT_EQ(TextureStreamer::computeDesiredLevel(-1.0f, 90.0f, 1000, 1.0f, 2048, 12), 0u);
+}
\ No newline at end of file
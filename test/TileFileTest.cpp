@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include "TileFile.hpp"
+
+namespace
+{
+	MipChain makeChain(int width, int height)
+	{
+		MipChain chain { width, height, 4 };
+		unsigned char *texels { chain.getData() };
+		for (int y = 0; y < height; y++)
+			for (int x = 0; x < width; x++)
+			{
+				unsigned char *texel { texels + (static_cast<std::size_t>(y) * width + x) * 4 };
+				texel[0] = static_cast<unsigned char>(x);
+				texel[1] = static_cast<unsigned char>(y);
+				texel[2] = static_cast<unsigned char>(x >> 8);
+				texel[3] = 255;
+			}
+		MipChain::Options options {};
+		options.filter = MipChain::Filter::Box;
+		options.srgb = false;
+		chain.generate(options);
+		return chain;
+	}
+}
+
+TEST(TileFileTest, shouldSplitLevelsIntoBorderedTiles)
+{
+	const std::string path { "TileFileTest.vtf" };
+	MipChain chain { makeChain(512, 256) };
+	TileFile::write(path, chain, true, 128, 4);
+
+	{
+		TileFile tiles { path };
+		EXPECT_EQ(tiles.getWidth(), 512);
+		EXPECT_EQ(tiles.getHeight(), 256);
+		EXPECT_EQ(tiles.getPageSize(), 136);
+		EXPECT_TRUE(tiles.isSrgb());
+		ASSERT_EQ(tiles.getLevelCount(), 3u);
+		EXPECT_EQ(tiles.getTilesX(0), 4);
+		EXPECT_EQ(tiles.getTilesY(0), 2);
+		EXPECT_EQ(tiles.getTilesX(1), 2);
+		EXPECT_EQ(tiles.getTilesY(1), 1);
+		EXPECT_EQ(tiles.getTilesX(2), 1);
+		EXPECT_EQ(tiles.getTilesY(2), 1);
+
+		// The first border texel of tile (1, 1) is source texel (124, 124), the image corner is clamped
+		const unsigned char *page { tiles.getPage(0, 1, 1) };
+		EXPECT_EQ(page[0], 124);
+		EXPECT_EQ(page[1], 124);
+		const unsigned char *corner { tiles.getPage(0, 0, 0) };
+		EXPECT_EQ(corner[0], 0);
+		EXPECT_EQ(corner[1], 0);
+		const unsigned char *inner { page + (static_cast<std::size_t>(4) * 136 + 4) * 4 };
+		EXPECT_EQ(inner[0], 128);
+		EXPECT_EQ(inner[1], 128);
+
+		// The coarsest level is 128x64, the rows past it repeat its last row
+		const unsigned char *coarsest { tiles.getPage(2, 0, 0) };
+		const unsigned char *lastRow { chain.getLevelData(2) + static_cast<std::size_t>(63) * 128 * 4 };
+		EXPECT_EQ(coarsest[(static_cast<std::size_t>(135) * 136 + 4) * 4], lastRow[0]);
+
+		EXPECT_THROW(tiles.getPage(1, 0, 1), std::out_of_range);
+	}
+	std::remove(path.c_str());
+}
+
+TEST(TileFileTest, shouldRejectTruncatedFiles)
+{
+	const std::string path { "TileFileTest.truncated.vtf" };
+	MipChain chain { makeChain(256, 256) };
+	TileFile::write(path, chain, false, 64, 2);
+	{
+		std::ifstream is { path, std::ios::binary };
+		std::string contents { std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>() };
+		is.close();
+		std::ofstream os { path, std::ios::binary | std::ios::trunc };
+		os.write(contents.data(), static_cast<std::streamsize>(contents.size() / 2));
+	}
+	EXPECT_THROW(TileFile { path }, TileFile::InvalidFileException);
+	std::remove(path.c_str());
+}
\ No newline at end of file
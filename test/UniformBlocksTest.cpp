@@ -0,0 +1,40 @@
+#include <gtest/gtest.h>
+#include <cstddef>
+#include "UniformBlocks.hpp"
+
+TEST(UniformBlocksTest, shouldComputeStd140Offsets)
+{
+	const Std140Member members[] { { 16, 12 }, { 4, 4 }, { 8, 8 }, { 16, 64 } };
+
+	ASSERT_EQ(0u, std140Offset(members, 0));
+	ASSERT_EQ(12u, std140Offset(members, 1));
+	ASSERT_EQ(16u, std140Offset(members, 2));
+	ASSERT_EQ(32u, std140Offset(members, 3));
+}
+
+TEST(UniformBlocksTest, shouldPackScalarsAfterVec3)
+{
+	ASSERT_EQ(128u, offsetof(FrameBlock, cameraPosition));
+	ASSERT_EQ(140u, offsetof(FrameBlock, time));
+	ASSERT_EQ(28u, offsetof(MaterialBlock, metallicFactor));
+	ASSERT_EQ(0u, sizeof(ObjectBlock) % 16);
+}
+
+TEST(UniformBlocksTest, shouldDeclareMembersInOrder)
+{
+	const std::string declaration { FrameBlock::declaration() };
+
+	ASSERT_EQ(0u, declaration.find("layout(std140) uniform FrameBlock\n{\n"));
+	ASSERT_LT(declaration.find("\tmat4 view;\n"), declaration.find("\tmat4 projection;\n"));
+	ASSERT_LT(declaration.find("\tvec3 cameraPosition;\n"), declaration.find("\tfloat time;\n"));
+	ASSERT_NE(std::string::npos, declaration.find("} frame;\n"));
+}
+
+TEST(UniformBlocksTest, shouldDeclareAllBlocks)
+{
+	const std::string declarations { UniformBlocks::declarations() };
+
+	ASSERT_NE(std::string::npos, declarations.find("uniform FrameBlock"));
+	ASSERT_NE(std::string::npos, declarations.find("uniform MaterialBlock"));
+	ASSERT_NE(std::string::npos, declarations.find("uniform ObjectBlock"));
+}
\ No newline at end of file